@@ -0,0 +1,576 @@
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <glob.h>
+#include <time.h>
+#include <sys/stat.h>
+
+#include "crcmodel.h"
+#include "crcset.h"
+#include "crcbatch.h"
+
+static double CRCBatch_now (void) {
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int CRCDeque_init (CRCDeque *this) {
+    this->tasks = (CRCTask *) malloc (DEQUESIZE * sizeof (CRCTask));
+    if (!this->tasks) {
+        fprintf (stderr, "Out of memory (deque)\n");
+        return ERROR;
+    }
+    this->head = this->tail = 0ULL;
+    this->mask = DEQUESIZE - 1;
+    pthread_mutex_init (&this->lock, NULL);
+
+    return SUCCESS;
+}
+
+static int CRCDeque_push (CRCDeque *this, CRCTask task) {
+    CRCTask *tasks = NULL;
+    uint64 i = 0ULL, size = this->mask + 1;
+    int ret = SUCCESS;
+
+    pthread_mutex_lock (&this->lock);
+    if (this->tail - this->head == size) {
+        /* full, double and unwrap */
+        tasks = (CRCTask *) malloc (2 * size * sizeof (CRCTask));
+        if (!tasks) {
+            fprintf (stderr, "Out of memory (deque)\n");
+            ret = ERROR;
+        }
+        else {
+            for (i = 0; i < size; i++) {
+                tasks[i] = this->tasks[(this->head + i) & this->mask];
+            }
+            free (this->tasks);
+            this->tasks = tasks;
+            this->tail -= this->head;
+            this->head = 0ULL;
+            this->mask = 2 * size - 1;
+        }
+    }
+    if (ret == SUCCESS) {
+        this->tasks[this->tail++ & this->mask] = task;
+    }
+    pthread_mutex_unlock (&this->lock);
+
+    return ret;
+}
+
+/* newest task, owner only */
+static int CRCDeque_pop (CRCDeque *this, CRCTask *task) {
+    int ok = 0;
+
+    pthread_mutex_lock (&this->lock);
+    if (this->tail != this->head) {
+        *task = this->tasks[--this->tail & this->mask];
+        ok = 1;
+    }
+    pthread_mutex_unlock (&this->lock);
+
+    return ok;
+}
+
+/* oldest task, other workers */
+static int CRCDeque_steal (CRCDeque *this, CRCTask *task) {
+    int ok = 0;
+
+    pthread_mutex_lock (&this->lock);
+    if (this->tail != this->head) {
+        *task = this->tasks[this->head++ & this->mask];
+        ok = 1;
+    }
+    pthread_mutex_unlock (&this->lock);
+
+    return ok;
+}
+
+static void CRCDeque_close (CRCDeque *this) {
+    pthread_mutex_destroy (&this->lock);
+    free (this->tasks);
+}
+
+CRCBatch * CRCBatch_new (const CRCModel *model, CRCSet *set, const uint64 *lengths, int nlengths, byte first, int nthreads) {
+    CRCBatch *this = NULL;
+    int i = 0;
+
+    if (nthreads < 1) {
+        nthreads = (int)sysconf (_SC_NPROCESSORS_ONLN);
+    }
+    if (nthreads < 1) {
+        nthreads = 1;
+    }
+    if (nthreads > MAXTHREADS) {
+        nthreads = MAXTHREADS;
+    }
+
+    this = (CRCBatch *) calloc (1, sizeof (CRCBatch));
+    if (!this) {
+        fprintf (stderr, "Out of memory (batch)\n");
+        return NULL;
+    }
+    this->model = model;
+    this->set = set;
+    this->lengths = lengths;
+    this->nlengths = nlengths;
+    this->first = first;
+    this->nthreads = nthreads;
+    this->add = &CRCBatch_add;
+    this->run = &CRCBatch_run;
+    this->close = &CRCBatch_close;
+    pthread_mutex_init (&this->out, NULL);
+
+    this->workers = (CRCWorker *) calloc (nthreads, sizeof (CRCWorker));
+    if (!this->workers) {
+        fprintf (stderr, "Out of memory (batch workers)\n");
+        CRCBatch_close (&this);
+        return NULL;
+    }
+    for (i = 0; i < nthreads; i++) {
+        this->workers[i].batch = this;
+        this->workers[i].id = i;
+        /* search tables are built here, before any thread starts */
+        this->workers[i].cs = CRCSearch_new (model);
+        this->workers[i].buf = (byte *) malloc (BUFSIZE);
+        if (!this->workers[i].cs || !this->workers[i].buf ||
+                CRCDeque_init (&this->workers[i].deque) != SUCCESS) {
+            fprintf (stderr, "Out of memory (batch worker)\n");
+            CRCBatch_close (&this);
+            return NULL;
+        }
+    }
+
+    return this;
+}
+
+static int CRCBatch_file (CRCBatch *this, const char *name, uint64 size) {
+    CRCFile **files = NULL;
+    CRCFile *f = NULL;
+    int k = 0;
+
+    if (this->nfiles == this->size) {
+        this->size = this->size ? 2 * this->size : DEQUESIZE;
+        files = (CRCFile **) realloc (this->files, this->size * sizeof (CRCFile *));
+        if (!files) {
+            fprintf (stderr, "Out of memory (batch files)\n");
+            return ERROR;
+        }
+        this->files = files;
+    }
+
+    f = (CRCFile *) calloc (1, sizeof (CRCFile));
+    if (!f || !(f->name = strdup (name))) {
+        fprintf (stderr, "Out of memory (batch file)\n");
+        free (f);
+        return ERROR;
+    }
+    f->size = size;
+    /* windows span segment boundaries, those files are searched whole */
+    f->nsegs = (!this->nlengths && size >= 2 * SEGSIZE) ? (int)((size + SEGSIZE - 1) / SEGSIZE) : 1;
+    f->parts = (uint64 *) calloc (f->nsegs, sizeof (uint64));
+    f->starts = (uint64 *) calloc (f->nsegs, sizeof (uint64));
+    f->hits = (CRCHits *) calloc (f->nsegs, sizeof (CRCHits));
+    this->files[this->nfiles++] = f;
+    if (!f->parts || !f->starts || !f->hits) {
+        fprintf (stderr, "Out of memory (batch file)\n");
+        return ERROR;
+    }
+    for (k = 0; k < f->nsegs; k++) {
+        f->hits[k].first = this->first;
+    }
+
+    return SUCCESS;
+}
+
+/* regular files below a directory, symbolic links are not followed */
+static int CRCBatch_walk (CRCBatch *this, const char *path) {
+    struct dirent *entry = NULL;
+    struct stat st;
+    char *child = NULL;
+    DIR *dir = NULL;
+    size_t len = 0;
+    int ret = SUCCESS;
+
+    dir = opendir (path);
+    if (!dir) {
+        fprintf (stderr, "ERROR: could not open directory %s: %s\n", path, strerror (errno));
+        this->errors++;
+        return SUCCESS;
+    }
+    while (ret == SUCCESS && (entry = readdir (dir))) {
+        if (!strcmp (entry->d_name, ".") || !strcmp (entry->d_name, "..")) {
+            continue;
+        }
+        len = strlen (path) + strlen (entry->d_name) + 2;
+        child = (char *) malloc (len);
+        if (!child) {
+            fprintf (stderr, "Out of memory (batch path)\n");
+            ret = ERROR;
+            break;
+        }
+        snprintf (child, len, "%s/%s", path, entry->d_name);
+        if (lstat (child, &st) == 0) {
+            if (S_ISDIR (st.st_mode)) {
+                ret = CRCBatch_walk (this, child);
+            }
+            else if (S_ISREG (st.st_mode)) {
+                ret = CRCBatch_file (this, child, (uint64)st.st_size);
+            }
+        }
+        free (child);
+    }
+    closedir (dir);
+
+    return ret;
+}
+
+static int CRCBatch_path (CRCBatch *this, const char *path) {
+    struct stat st;
+
+    if (stat (path, &st) != 0) {
+        fprintf (stderr, "ERROR: could not stat %s: %s\n", path, strerror (errno));
+        this->errors++;
+        return SUCCESS;
+    }
+    if (S_ISDIR (st.st_mode)) {
+        return CRCBatch_walk (this, path);
+    }
+
+    return CRCBatch_file (this, path, (uint64)st.st_size);
+}
+
+/* add a file, a directory searched recursively or a glob pattern */
+int CRCBatch_add (CRCBatch *this, const char *arg) {
+    glob_t g;
+    size_t i = 0;
+    int ret = SUCCESS;
+
+    if (!strpbrk (arg, "*?[")) {
+        return CRCBatch_path (this, arg);
+    }
+    if (glob (arg, 0, NULL, &g) != 0) {
+        fprintf (stderr, "ERROR: no files match %s\n", arg);
+        this->errors++;
+        return SUCCESS;
+    }
+    for (i = 0; ret == SUCCESS && i < g.gl_pathc; i++) {
+        ret = CRCBatch_path (this, g.gl_pathv[i]);
+    }
+    globfree (&g);
+
+    return ret;
+}
+
+static void CRCBatch_hit (void *ctx, uint64 crc, uint64 start, uint64 end) {
+    CRCHits *hits = (CRCHits *)ctx;
+    uint64 *p = NULL;
+    uint64 size = 0ULL;
+
+    if (hits->first && hits->count) {
+        return;
+    }
+    if (hits->count == hits->size) {
+        size = hits->size ? 2 * hits->size : 8;
+        if (!(p = (uint64 *) realloc (hits->crc, size * sizeof (uint64)))) {
+            goto oom;
+        }
+        hits->crc = p;
+        if (!(p = (uint64 *) realloc (hits->start, size * sizeof (uint64)))) {
+            goto oom;
+        }
+        hits->start = p;
+        if (!(p = (uint64 *) realloc (hits->end, size * sizeof (uint64)))) {
+            goto oom;
+        }
+        hits->end = p;
+        hits->size = size;
+    }
+    hits->crc[hits->count] = crc;
+    hits->start[hits->count] = start;
+    hits->end[hits->count] = end;
+    hits->count++;
+    return;
+
+oom:
+    fprintf (stderr, "Out of memory (batch matches)\n");
+}
+
+static void CRCBatch_json (const char *s) {
+    fputc ('"', stdout);
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\') {
+            fprintf (stdout, "\\%c", *s);
+        }
+        else if ((unsigned char)*s < 0x20) {
+            fprintf (stdout, "\\u%04x", (unsigned char)*s);
+        }
+        else {
+            fputc (*s, stdout);
+        }
+    }
+    fputc ('"', stdout);
+}
+
+/* one JSON line per match, segments in file order */
+static void CRCBatch_output (CRCBatch *this, CRCFile *f) {
+    CRCHits *hits = NULL;
+    uint64 i = 0ULL, n = 0ULL;
+    int k = 0;
+
+    pthread_mutex_lock (&this->out);
+    if (f->error) {
+        fputs ("{\"file\":", stdout);
+        CRCBatch_json (f->name);
+        fputs (",\"error\":", stdout);
+        CRCBatch_json (strerror (f->error));
+        fputs ("}\n", stdout);
+        this->errors++;
+    }
+    else {
+        for (k = 0; k < f->nsegs; k++) {
+            hits = &f->hits[k];
+            for (i = 0; i < hits->count && !(this->first && n); i++, n++) {
+                fputs ("{\"file\":", stdout);
+                CRCBatch_json (f->name);
+                fprintf (stdout, ",\"crc\":\"0x%llx\",\"start\":%llu,\"end\":%llu}\n",
+                    hits->crc[i], hits->start[i], hits->end[i]);
+            }
+        }
+        this->matches += n;
+    }
+    pthread_mutex_unlock (&this->out);
+
+    for (k = 0; k < f->nsegs; k++) {
+        free (f->hits[k].crc);
+        free (f->hits[k].start);
+        free (f->hits[k].end);
+        f->hits[k].crc = f->hits[k].start = f->hits[k].end = NULL;
+    }
+}
+
+/* read a segment, computing its part CRC or probing every prefix */
+static void CRCBatch_segment (CRCWorker *w, CRCFile *f, int seg, int phase) {
+    CRCBatch *this = w->batch;
+    CRCSearch *cs = w->cs;
+    CRCHits *hits = &f->hits[seg];
+    uint64 off = (uint64)seg * SEGSIZE;
+    uint64 end = seg == f->nsegs - 1 ? f->size : off + SEGSIZE;
+    uint64 reg = phase == PHASE_PART ? 0ULL : f->starts[seg];
+    ssize_t n = 0;
+    int fd = 0, len = 0;
+
+    if (f->nsegs == 1) {
+        /* whole file, read to the end even if it grew since the walk */
+        end = ~0ULL;
+    }
+    fd = open (f->name, O_RDONLY);
+    if (fd < 0) {
+        __atomic_store_n (&f->error, errno, __ATOMIC_RELAXED);
+        return;
+    }
+
+    while (off < end && !(hits->first && hits->count)) {
+        len = end - off < BUFSIZE ? (int)(end - off) : BUFSIZE;
+        n = pread (fd, w->buf, len, off);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            __atomic_store_n (&f->error, errno, __ATOMIC_RELAXED);
+            break;
+        }
+        if (n == 0) {
+            break;
+        }
+        if (phase == PHASE_PART) {
+            reg = cs->update (cs, reg, w->buf, (uint64)n);
+        }
+        else {
+            cs->probe (cs, &reg, w->buf, (int)n, off, this->set, &CRCBatch_hit, hits);
+        }
+        off += n;
+        w->bytes += n;
+    }
+    close (fd);
+
+    if (phase == PHASE_PART) {
+        f->parts[seg] = reg;
+    }
+}
+
+static void CRCBatch_task (CRCWorker *w, CRCTask *task) {
+    CRCBatch *this = w->batch;
+    CRCFile *f = task->file;
+    CRCTask scan;
+    uint64 bytes = 0ULL;
+    int k = 0;
+
+    if (task->phase == PHASE_PART) {
+        CRCBatch_segment (w, f, task->seg, PHASE_PART);
+        if (__atomic_sub_fetch (&f->remaining, 1, __ATOMIC_ACQ_REL)) {
+            return;
+        }
+        /* last part in, chain the start registers and queue the scans
+         * here for the other workers to steal */
+        f->starts[0] = CRCModel_start (this->model);
+        for (k = 1; k < f->nsegs; k++) {
+            f->starts[k] = CRCSearch_zeros (w->cs, f->starts[k - 1], SEGSIZE) ^ f->parts[k - 1];
+        }
+        __atomic_store_n (&f->remaining, f->nsegs, __ATOMIC_RELEASE);
+        __atomic_add_fetch (&this->pending, f->nsegs, __ATOMIC_ACQ_REL);
+        for (k = f->nsegs - 1; k >= 0; k--) {
+            scan.file = f;
+            scan.seg = k;
+            scan.phase = PHASE_SCAN;
+            if (CRCDeque_push (&w->deque, scan) != SUCCESS) {
+                __atomic_store_n (&f->error, ENOMEM, __ATOMIC_RELAXED);
+                __atomic_sub_fetch (&this->pending, 1, __ATOMIC_ACQ_REL);
+                if (!__atomic_sub_fetch (&f->remaining, 1, __ATOMIC_ACQ_REL)) {
+                    CRCBatch_output (this, f);
+                }
+            }
+        }
+        return;
+    }
+
+    if (!__atomic_load_n (&f->error, __ATOMIC_RELAXED)) {
+        if (this->nlengths) {
+            if (w->cs->window (w->cs, f->name, this->lengths, this->nlengths,
+                    this->set, &CRCBatch_hit, &f->hits[0], &bytes) != SUCCESS) {
+                __atomic_store_n (&f->error, errno, __ATOMIC_RELAXED);
+            }
+            w->bytes += bytes;
+        }
+        else {
+            CRCBatch_segment (w, f, task->seg, PHASE_SCAN);
+        }
+    }
+    if (!__atomic_sub_fetch (&f->remaining, 1, __ATOMIC_ACQ_REL)) {
+        CRCBatch_output (this, f);
+    }
+}
+
+static void * CRCBatch_worker (void *arg) {
+    CRCWorker *w = (CRCWorker *)arg;
+    CRCBatch *this = w->batch;
+    CRCTask task;
+    int i = 0, found = 0;
+
+    for (;;) {
+        found = CRCDeque_pop (&w->deque, &task);
+        for (i = 1; !found && i < this->nthreads; i++) {
+            found = CRCDeque_steal (&this->workers[(w->id + i) % this->nthreads].deque, &task);
+            w->steals += found;
+        }
+        if (found) {
+            CRCBatch_task (w, &task);
+            __atomic_sub_fetch (&this->pending, 1, __ATOMIC_ACQ_REL);
+            continue;
+        }
+        /* nothing to steal, the running tasks may still queue scans */
+        if (!__atomic_load_n (&this->pending, __ATOMIC_ACQUIRE)) {
+            break;
+        }
+        usleep (IDLEWAIT);
+    }
+
+    return NULL;
+}
+
+/* search every file added, returns ERROR if any could not be read */
+int CRCBatch_run (CRCBatch *this) {
+    CRCFile *f = NULL;
+    CRCTask task;
+    uint64 i = 0ULL, bytes = 0ULL, steals = 0ULL, next = 0ULL;
+    double t = CRCBatch_now ();
+    int k = 0, started = 0;
+
+    /* deal the files, or their parts, round robin, stealing evens out the rest */
+    for (i = 0; i < this->nfiles; i++) {
+        f = this->files[i];
+        task.file = f;
+        if (f->nsegs > 1) {
+            /* the last segment's part CRC is never needed */
+            f->remaining = f->nsegs - 1;
+            task.phase = PHASE_PART;
+        }
+        else {
+            f->remaining = 1;
+            f->starts[0] = CRCModel_start (this->model);
+            task.phase = PHASE_SCAN;
+        }
+        for (k = 0; k < f->remaining; k++) {
+            task.seg = k;
+            if (CRCDeque_push (&this->workers[next++ % this->nthreads].deque, task) != SUCCESS) {
+                return ERROR;
+            }
+            this->pending++;
+        }
+    }
+
+    for (k = 0; k < this->nthreads; k++) {
+        if (pthread_create (&this->workers[k].thread, NULL, &CRCBatch_worker, &this->workers[k])) {
+            fprintf (stderr, "ERROR: could not start worker thread\n");
+            break;
+        }
+        started++;
+    }
+    if (!started) {
+        return ERROR;
+    }
+    for (k = 0; k < started; k++) {
+        pthread_join (this->workers[k].thread, NULL);
+        bytes += this->workers[k].bytes;
+        steals += this->workers[k].steals;
+    }
+    fflush (stdout);
+    t = CRCBatch_now () - t;
+
+    fprintf (stderr, "INFO: Searched %llu files, %llu MB in %.2f s, %.2f GB/s on %d threads, %llu steals\n",
+        this->nfiles, bytes >> 20, t, t > 0.0 ? bytes / t / 1e9 : 0.0, started, steals);
+    fprintf (stderr, "INFO: Found %llu matches, %llu errors\n", this->matches, this->errors);
+
+    return this->errors ? ERROR : SUCCESS;
+}
+
+void CRCBatch_close (CRCBatch **this) {
+    CRCBatch *b = *this;
+    CRCFile *f = NULL;
+    uint64 i = 0ULL;
+    int k = 0;
+
+    if (!b) {
+        return;
+    }
+    for (i = 0; i < b->nfiles; i++) {
+        f = b->files[i];
+        free (f->name);
+        free (f->parts);
+        free (f->starts);
+        free (f->hits);
+        free (f);
+    }
+    free (b->files);
+    if (b->workers) {
+        for (k = 0; k < b->nthreads; k++) {
+            if (b->workers[k].cs) {
+                b->workers[k].cs->close (&b->workers[k].cs);
+            }
+            free (b->workers[k].buf);
+            if (b->workers[k].deque.tasks) {
+                CRCDeque_close (&b->workers[k].deque);
+            }
+        }
+        free (b->workers);
+    }
+    pthread_mutex_destroy (&b->out);
+    free (b);
+    *this = NULL;
+}
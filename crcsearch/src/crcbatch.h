@@ -0,0 +1,109 @@
+#ifndef __CRCBATCH_H_
+#define __CRCBATCH_H_
+
+#include <pthread.h>
+
+#include "crcsearch.h"
+
+/* files of at least 2 segments are split so workers can share them */
+#define SEGSIZE (64ULL << 20)
+#define MAXTHREADS 256
+/* initial tasks per worker deque, always a power of 2 */
+#define DEQUESIZE 64
+/* microseconds an idle worker sleeps before trying to steal again */
+#define IDLEWAIT 200
+
+typedef struct CRCBatch CRCBatch;
+typedef struct CRCFile CRCFile;
+typedef struct CRCHits CRCHits;
+typedef struct CRCTask CRCTask;
+typedef struct CRCDeque CRCDeque;
+typedef struct CRCWorker CRCWorker;
+
+/* matches in one segment, reported in order once the file is done */
+struct CRCHits {
+    uint64 *crc;
+    uint64 *start;
+    uint64 *end;
+    uint64 count;
+    uint64 size;
+    /* keep only the first match, as search does for a single checksum */
+    byte first;
+};
+
+/* a file is searched in two phases when split into segments:
+ *   part: CRC of each segment from register 0, segments in parallel
+ *   scan: each segment probed from its start register, which by the CRC's
+ *         linearity is start[k] = zeros(start[k-1], SEGSIZE) ^ part[k-1] */
+struct CRCFile {
+    char *name;
+    uint64 size;
+    int nsegs;
+    /* tasks of the current phase still to finish */
+    int remaining;
+    /* errno of the first failed read, 0 if none */
+    int error;
+    uint64 *parts;
+    uint64 *starts;
+    CRCHits *hits;
+};
+
+#define PHASE_PART 0
+#define PHASE_SCAN 1
+
+struct CRCTask {
+    CRCFile *file;
+    int seg;
+    int phase;
+};
+
+/* owner pushes and pops at the tail, thieves take the oldest task at the
+ * head, so a worker keeps the segments it split and others take whole files */
+struct CRCDeque {
+    CRCTask *tasks;
+    uint64 head;
+    uint64 tail;
+    uint64 mask;
+    pthread_mutex_t lock;
+};
+
+struct CRCWorker {
+    CRCBatch *batch;
+    int id;
+    CRCSearch *cs;
+    byte *buf;
+    CRCDeque deque;
+    pthread_t thread;
+    uint64 bytes;
+    uint64 steals;
+};
+
+struct CRCBatch {
+    /* search parameters, not owned */
+    const CRCModel *model;
+    CRCSet *set;
+    const uint64 *lengths;
+    int nlengths;
+    byte first;
+    int nthreads;
+    CRCWorker *workers;
+    CRCFile **files;
+    uint64 nfiles;
+    uint64 size;
+    /* tasks queued or running, workers exit when it reaches 0 */
+    int pending;
+    uint64 matches;
+    uint64 errors;
+    /* serialises JSON lines on stdout */
+    pthread_mutex_t out;
+    int (*add) (CRCBatch *, const char *);
+    int (*run) (CRCBatch *);
+    void (*close) (CRCBatch **);
+};
+
+CRCBatch * CRCBatch_new (const CRCModel *, CRCSet *, const uint64 *, int, byte, int);
+int CRCBatch_add (CRCBatch *, const char *);
+int CRCBatch_run (CRCBatch *);
+void CRCBatch_close (CRCBatch **);
+
+#endif
@@ -0,0 +1,260 @@
+#include <stdio.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+
+#include "crcsearch.h"
+#include "crcmodel.h"
+#include "crchw.h"
+
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#define cycles() __rdtsc()
+#else
+#define cycles() 0ULL
+#endif
+
+#define MB (1ULL << 20)
+/* bytes cross checked against the bitwise reference */
+#define REFSIZE (4 * MB)
+#define SEED 0x2545f4914f6cdd1dULL
+
+typedef struct CRCKernel CRCKernel;
+
+/* a checksum kernel, returns the final CRC of buf */
+struct CRCKernel {
+    const char *name;
+    int (*supports) (const CRCModel *);
+    uint64 (*run) (const CRCModel *, const uint64 *, const byte *, uint64);
+};
+
+void usage (void) {
+    const char *usage = "NAME                                           \n\
+       crcbench                                                         \n\
+                                                                        \n\
+SYNOPSIS                                                                \n\
+       crcbench [-s size MB] [-r repeats] [-o file]                     \n\
+                                                                        \n\
+DESCRIPTION                                                             \n\
+       Runs every CRC kernel for every preset over synthetic data,      \n\
+       reports GB/s and cycles per byte and checks each kernel against  \n\
+       a bitwise reference. Search kernels run crcsearch over the data  \n\
+       written to file (default bin/bench.dat). Exits 1 on a mismatch.  \n\
+\n";
+
+    fprintf (stdout, "%s", usage);
+}
+
+/* bit at a time straight from the model parameters, shares no code with
+ * the table kernels */
+static uint64 reference (const CRCModel *m, const byte *buf, uint64 len) {
+    uint64 top = 1ULL << (m->width - 1);
+    uint64 mask = top | (top - 1);
+    uint64 reg = m->init;
+    byte b = 0;
+    int j = 0;
+
+    while (len--) {
+        b = *buf++;
+        if (m->refin) {
+            b = (byte)CRCModel_reflect (b, NUMBITS);
+        }
+        reg ^= (uint64)b << (m->width - NUMBITS);
+        for (j = 0; j < NUMBITS; j++) {
+            reg = (reg & top) ? (reg << 1) ^ m->poly : reg << 1;
+        }
+        reg &= mask;
+    }
+    if (m->refout) {
+        reg = CRCModel_reflect (reg, m->width);
+    }
+
+    return reg ^ m->xorout;
+}
+
+static int any (const CRCModel *m) {
+    return 1;
+}
+
+static int preset (const CRCModel *m) {
+    return m->update != NULL;
+}
+
+/* byte table built at runtime, generic loop */
+static uint64 table_run (const CRCModel *m, const uint64 *table, const byte *buf, uint64 len) {
+    CRCModel model = *m;
+
+    model.update = NULL;
+    return CRCModel_compute (&model, table, buf, len);
+}
+
+/* build time table bound into the preset's own loop */
+static uint64 preset_run (const CRCModel *m, const uint64 *table, const byte *buf, uint64 len) {
+    return CRCModel_compute (m, m->table, buf, len);
+}
+
+static uint64 hw_run (const CRCModel *m, const uint64 *table, const byte *buf, uint64 len) {
+    return CRCModel_final (m, CRCHW_update (CRCModel_start (m), buf, len));
+}
+
+static const CRCKernel kernels[] = {
+    { "table", &any, &table_run },
+    { "preset", &preset, &preset_run },
+    { "hw", &CRCHW_supports, &hw_run },
+    { NULL, NULL, NULL }
+};
+
+static double now (void) {
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void generate (byte *buf, uint64 len) {
+    uint64 x = SEED, i = 0;
+
+    /* xorshift64*, fast and incompressible enough for CRCs */
+    for (i = 0; i + 8 <= len; i += 8) {
+        x ^= x >> 12;
+        x ^= x << 25;
+        x ^= x >> 27;
+        x *= SEED;
+        memcpy (buf + i, &x, 8);
+    }
+    for (; i < len; i++) {
+        buf[i] = (byte)(i * 131);
+    }
+}
+
+static void result (const char *kernel, const CRCModel *m, uint64 len, double secs, uint64 cyc, int ok) {
+    fprintf (stdout, "%-8s %-16s %10.3f %10.3f %s\n",
+        kernel, m->name, len / secs / 1e9, cyc ? (double)cyc / len : 0.0, ok ? "ok" : "FAIL");
+}
+
+int main (int argc, char **argv) {
+    uint64 size = 64 * MB, refsize = 0ULL, crc = 0ULL, expect = 0ULL, full = 0ULL, cyc = 0ULL, bestcyc = 0ULL;
+    uint64 query = 0ULL;
+    uint64 table[TABSIZE];
+    const char *oname = "bin/bench.dat";
+    const CRCModel *m = NULL;
+    const CRCKernel *k = NULL;
+    CRCSearch *cs = NULL;
+    byte *buf = NULL;
+    double t = 0.0, best = 0.0;
+    int repeats = 3, r = 0, ok = 0, failed = 0;
+    char c = 0;
+    FILE *fh = NULL;
+
+    while ((c = getopt (argc, argv, "s:r:o:h")) != -1) {
+        switch (c) {
+            case 's':
+                size = strtoull (optarg, NULL, 10) * MB;
+                break;
+            case 'r':
+                repeats = atoi (optarg);
+                break;
+            case 'o':
+                oname = optarg;
+                break;
+            default:
+                usage();
+                return c == 'h' ? SUCCESS : ERROR;
+        }
+    }
+    if (!size || repeats < 1) {
+        usage();
+        return ERROR;
+    }
+
+    buf = (byte *) malloc (size);
+    if (!buf) {
+        fprintf (stderr, "Out of memory (bench)\n");
+        return ERROR;
+    }
+    generate (buf, size);
+    fh = fopen (oname, "wb");
+    if (!fh || fwrite (buf, 1, size, fh) != size) {
+        fprintf (stderr, "ERROR: could not write %s: %s\n", oname, strerror (errno));
+        if (fh) {
+            fclose (fh);
+        }
+        free (buf);
+        return ERROR;
+    }
+    fclose (fh);
+    refsize = size < REFSIZE ? size : REFSIZE;
+
+    fprintf (stdout, "INFO: %llu MB synthetic data in %s, best of %d\n", size / MB, oname, repeats);
+    fprintf (stdout, "%-8s %-16s %10s %10s %s\n", "kernel", "model", "GB/s", "cycles/B", "check");
+
+    for (m = CRCModels; m->name; m++) {
+        CRCModel_table (m, table);
+        /* the reference is too slow for the whole buffer, kernels must
+         * agree with it on a prefix and with the first kernel on all of it */
+        expect = reference (m, buf, refsize);
+        full = table_run (m, table, buf, size);
+
+        for (k = kernels; k->name; k++) {
+            if (!k->supports (m)) {
+                continue;
+            }
+            ok = k->run (m, table, buf, refsize) == expect &&
+                k->run (m, table, buf, 1) == reference (m, buf, 1) &&
+                k->run (m, table, buf, refsize - 3) == reference (m, buf, refsize - 3);
+            for (r = 0, best = 0.0; r < repeats; r++) {
+                t = now ();
+                cyc = cycles ();
+                crc = k->run (m, table, buf, size);
+                cyc = cycles () - cyc;
+                t = now () - t;
+                if (!r || t < best) {
+                    best = t;
+                    bestcyc = cyc;
+                }
+            }
+            ok = ok && crc == full;
+            failed += !ok;
+            result (k->name, m, size, best, bestcyc, ok);
+        }
+
+        /* prefix search over the file as crcsearch runs it, for a checksum
+         * that is not the full one so it normally reads to the end */
+        query = CRCModel_final (m, CRCModel_raw (m, full) ^ 1);
+        cs = CRCSearch_new (m);
+        if (!cs) {
+            free (buf);
+            return ERROR;
+        }
+        for (r = 0, best = 0.0; r < repeats; r++) {
+            cs->found = 0;
+            t = now ();
+            cyc = cycles ();
+            crc = cs->search (cs, oname, query);
+            cyc = cycles () - cyc;
+            t = now () - t;
+            if (!r || t < best) {
+                best = t;
+                bestcyc = cyc;
+            }
+        }
+        if (cs->found) {
+            /* a prefix really has that checksum, time is not comparable */
+            ok = table_run (m, table, buf, cs->length) == query;
+            fprintf (stdout, "INFO: %s search matched after %llu bytes\n", m->name, cs->length);
+        }
+        else {
+            ok = crc == full;
+        }
+        failed += !ok;
+        result (cs->hw ? "search*" : "search", m, size, best, bestcyc, ok);
+        cs->close (&cs);
+    }
+    fprintf (stdout, "INFO: search* uses the SSE4.2 crc32 instruction\n");
+
+    free (buf);
+    unlink (oname);
+
+    return failed ? ERROR : SUCCESS;
+}
@@ -0,0 +1,178 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "crcmodel.h"
+#include "crcset.h"
+#include "crchw.h"
+
+#if defined(__x86_64__)
+
+#include <nmmintrin.h>
+
+#define HWTARGET __attribute__((target("sse4.2")))
+
+/* register bits shifted through HWBLOCK zero bytes, one table per
+ * register byte, used to join the streams of a chunk */
+static unsigned int shift[4][TABSIZE];
+static int initialised = 0;
+
+int CRCHW_supports (const CRCModel *m) {
+    __builtin_cpu_init ();
+    return m->width == HWWIDTH && m->poly == HWPOLY && m->refin &&
+        __builtin_cpu_supports ("sse4.2");
+}
+
+HWTARGET
+void CRCHW_init (void) {
+    unsigned int basis[HWWIDTH];
+    uint64 reg = 0ULL;
+    int i = 0, j = 0, k = 0;
+
+    if (initialised) {
+        return;
+    }
+    /* the CRC is linear, shift each register bit through a block of
+     * zeros and combine those for every byte value */
+    for (i = 0; i < HWWIDTH; i++) {
+        reg = 1ULL << i;
+        for (j = 0; j < HWBLOCK / 8; j++) {
+            reg = _mm_crc32_u64 (reg, 0ULL);
+        }
+        basis[i] = (unsigned int)reg;
+    }
+    for (k = 0; k < 4; k++) {
+        for (i = 0; i < TABSIZE; i++) {
+            shift[k][i] = 0;
+            for (j = 0; j < NUMBITS; j++) {
+                if (i & (1 << j)) {
+                    shift[k][i] ^= basis[k * NUMBITS + j];
+                }
+            }
+        }
+    }
+    initialised = 1;
+}
+
+static inline uint64 CRCHW_shift (uint64 reg) {
+    return shift[0][reg & 0xff] ^ shift[1][(reg >> 8) & 0xff] ^
+        shift[2][(reg >> 16) & 0xff] ^ shift[3][(reg >> 24) & 0xff];
+}
+
+static inline uint64 load64 (const byte *p) {
+    uint64 v;
+
+    memcpy (&v, p, sizeof (v));
+    return v;
+}
+
+/* registers entering streams 1 and 2 of a chunk, 8 bytes per instruction */
+HWTARGET
+static inline void CRCHW_starts (uint64 reg, const byte *buf, uint64 *s1, uint64 *s2) {
+    const byte *p0 = buf, *p1 = buf + HWBLOCK;
+    uint64 a = reg, b = 0ULL;
+    int i = 0;
+
+    for (i = 0; i < HWBLOCK; i += 8) {
+        a = _mm_crc32_u64 (a, load64 (p0 + i));
+        b = _mm_crc32_u64 (b, load64 (p1 + i));
+    }
+    *s1 = a;
+    *s2 = CRCHW_shift (a) ^ b;
+}
+
+/* checksum update, 3 interleaved streams joined per chunk */
+HWTARGET
+uint64 CRCHW_update (uint64 reg, const byte *buf, uint64 len) {
+    const byte *p0 = NULL, *p1 = NULL, *p2 = NULL;
+    uint64 a = 0ULL, b = 0ULL, c = 0ULL;
+    int i = 0;
+
+    if (!initialised) {
+        CRCHW_init ();
+    }
+    while (len >= HWCHUNK) {
+        p0 = buf;
+        p1 = buf + HWBLOCK;
+        p2 = buf + 2 * HWBLOCK;
+        a = reg;
+        b = c = 0ULL;
+        for (i = 0; i < HWBLOCK; i += 8) {
+            a = _mm_crc32_u64 (a, load64 (p0 + i));
+            b = _mm_crc32_u64 (b, load64 (p1 + i));
+            c = _mm_crc32_u64 (c, load64 (p2 + i));
+        }
+        reg = CRCHW_shift (CRCHW_shift (a) ^ b) ^ c;
+        buf += HWCHUNK;
+        len -= HWCHUNK;
+    }
+    for (; len >= 8; len -= 8, buf += 8) {
+        reg = _mm_crc32_u64 (reg, load64 (buf));
+    }
+    while (len--) {
+        reg = _mm_crc32_u8 ((unsigned int)reg, *buf++);
+    }
+
+    return reg;
+}
+
+/* advance reg over buf (at most HWCHUNK bytes) checking every prefix
+ * against query, or the set when given. Returns non zero if any prefix
+ * matched, the caller then rescans the chunk in order for the first or
+ * all matches since the streams see them out of order */
+HWTARGET
+int CRCHW_chunk (uint64 *reg, const byte *buf, uint64 len, uint64 query, const CRCSet *set) {
+    const byte *p0 = buf, *p1 = buf + HWBLOCK, *p2 = buf + 2 * HWBLOCK;
+    uint64 r0 = *reg, r1 = 0ULL, r2 = 0ULL;
+    int hit = 0, i = 0;
+
+    if (len < HWCHUNK) {
+        /* tail, one stream */
+        for (i = 0; i < (int)len; i++) {
+            r0 = _mm_crc32_u8 ((unsigned int)r0, buf[i]);
+            hit |= set ? CRCSet_has (set, r0) : r0 == query;
+        }
+        *reg = r0;
+        return hit;
+    }
+
+    CRCHW_starts (r0, buf, &r1, &r2);
+    if (set) {
+        for (i = 0; i < HWBLOCK; i++) {
+            r0 = _mm_crc32_u8 ((unsigned int)r0, p0[i]);
+            r1 = _mm_crc32_u8 ((unsigned int)r1, p1[i]);
+            r2 = _mm_crc32_u8 ((unsigned int)r2, p2[i]);
+            hit |= CRCSet_has (set, r0) | CRCSet_has (set, r1) | CRCSet_has (set, r2);
+        }
+    }
+    else {
+        for (i = 0; i < HWBLOCK; i++) {
+            r0 = _mm_crc32_u8 ((unsigned int)r0, p0[i]);
+            r1 = _mm_crc32_u8 ((unsigned int)r1, p1[i]);
+            r2 = _mm_crc32_u8 ((unsigned int)r2, p2[i]);
+            hit |= (r0 == query) | (r1 == query) | (r2 == query);
+        }
+    }
+    *reg = r2;
+
+    return hit;
+}
+
+#else
+
+/* no crc32 instruction, CRC-32C runs on the table */
+int CRCHW_supports (const CRCModel *m) {
+    return 0;
+}
+
+void CRCHW_init (void) {
+}
+
+uint64 CRCHW_update (uint64 reg, const byte *buf, uint64 len) {
+    return reg;
+}
+
+int CRCHW_chunk (uint64 *reg, const byte *buf, uint64 len, uint64 query, const CRCSet *set) {
+    return 0;
+}
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef __CRCHW_H_
+#define __CRCHW_H_
+
+#include "crcsearch.h"
+
+/* bytes per stream, a chunk interleaves 3 streams to cover the 3 cycle
+ * latency of the crc32 instruction */
+#define HWSTREAMS 3
+#define HWBLOCK 8192
+#define HWCHUNK (HWSTREAMS * HWBLOCK)
+
+/* the SSE4.2 crc32 instruction steps a reflected CRC-32C register */
+#define HWPOLY 0x1edc6f41ULL
+#define HWWIDTH 32
+
+int CRCHW_supports (const CRCModel *);
+void CRCHW_init (void);
+uint64 CRCHW_update (uint64, const byte *, uint64);
+int CRCHW_chunk (uint64 *, const byte *, uint64, uint64, const CRCSet *);
+
+#endif
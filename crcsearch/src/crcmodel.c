@@ -0,0 +1,234 @@
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+
+#include "crcmodel.h"
+
+#define POLY_CRC32 0x04c11db7ULL
+#define POLY_CRC32C 0x1edc6f41ULL
+#define POLY_ECMA 0x42f0e1eba9ea3693ULL
+/* original crcsearch algorithm: ECMA constant used directly as the
+ * reflected polynomial, zero init and no final xor */
+#define POLY_CRCSEARCH 0xc96c5795d7870f42ULL
+
+#ifdef MAKECRCTAB
+
+/* table generator, regenerate src/crctables.h with: make tables */
+#define CRC_PRESET(name, width, poly, refin, refout, init, xorout, check, tab) \
+    { name, width, poly, refin, refout, init, xorout, check, NULL, NULL }
+
+#else
+
+#include "crctables.h"
+
+#define CRC_PRESET(name, width, poly, refin, refout, init, xorout, check, tab) \
+    { name, width, poly, refin, refout, init, xorout, check, tab, &tab##_update }
+
+/* checksum loop bound to one compile time table */
+#define CRC_TABLE(tab, reflected)                                           \
+static uint64 tab##_update (uint64 crc, const byte *buf, uint64 len) {      \
+    while (len--) {                                                         \
+        crc = CRC_step (tab, crc, *buf++, reflected);                       \
+    }                                                                       \
+    return crc;                                                             \
+}
+
+CRC_TABLE(crc64_crcsearch_table, 1)
+CRC_TABLE(crc32_table, 1)
+CRC_TABLE(crc32c_table, 1)
+CRC_TABLE(crc64_xz_table, 1)
+CRC_TABLE(crc64_ecma_table, 0)
+CRC_TABLE(crc64_we_table, 0)
+
+#endif
+
+const CRCModel CRCModels[] = {
+    CRC_PRESET("crcsearch", 64, POLY_CRCSEARCH, 1, 1, 0ULL, 0ULL,
+        0x4db9a9f87ec10c59ULL, crc64_crcsearch_table),
+    CRC_PRESET("crc-32", 32, POLY_CRC32, 1, 1, 0xffffffffULL, 0xffffffffULL,
+        0xcbf43926ULL, crc32_table),
+    CRC_PRESET("crc-32c", 32, POLY_CRC32C, 1, 1, 0xffffffffULL, 0xffffffffULL,
+        0xe3069283ULL, crc32c_table),
+    CRC_PRESET("crc-64/xz", 64, POLY_ECMA, 1, 1, ~0ULL, ~0ULL,
+        0x995dc9bbdf1939faULL, crc64_xz_table),
+    CRC_PRESET("crc-64/ecma-182", 64, POLY_ECMA, 0, 0, 0ULL, 0ULL,
+        0x6c40df5f0b497347ULL, crc64_ecma_table),
+    /* as used by bin/crcSearch.pl */
+    CRC_PRESET("crc-64/we", 64, POLY_ECMA, 0, 0, ~0ULL, ~0ULL,
+        0x62ec59e3f1a4f00aULL, crc64_we_table),
+    { NULL, 0, 0ULL, 0, 0, 0ULL, 0ULL, 0ULL, NULL, NULL }
+};
+
+static uint64 CRCModel_mask (int width) {
+    return width == CRCBITS ? ~0ULL : (1ULL << width) - 1;
+}
+
+const CRCModel * CRCModel_find (const char *name) {
+    const CRCModel *m = NULL;
+
+    for (m = CRCModels; m->name; m++) {
+        if (!strcasecmp (m->name, name)) {
+            return m;
+        }
+    }
+
+    return NULL;
+}
+
+/* custom model: width,poly,refin,refout,init,xorout (poly/init/xorout hex) */
+int CRCModel_parse (const char *spec, CRCModel *m) {
+    unsigned int refin = 0, refout = 0;
+    int width = 0;
+
+    memset (m, 0, sizeof (CRCModel));
+    if (sscanf (spec, "%d,%llx,%u,%u,%llx,%llx",
+            &width, &m->poly, &refin, &refout, &m->init, &m->xorout) != 6) {
+        fprintf (stderr, "ERROR: invalid CRC model: %s\n", spec);
+        return ERROR;
+    }
+    if (width < NUMBITS || width > CRCBITS) {
+        fprintf (stderr, "ERROR: CRC width must be between %d and %d\n", NUMBITS, CRCBITS);
+        return ERROR;
+    }
+    m->name = "custom";
+    m->width = width;
+    m->poly &= CRCModel_mask (width);
+    m->init &= CRCModel_mask (width);
+    m->xorout &= CRCModel_mask (width);
+    m->refin = (byte)!!refin;
+    m->refout = (byte)!!refout;
+
+    return SUCCESS;
+}
+
+uint64 CRCModel_reflect (uint64 v, int width) {
+    uint64 r = 0ULL;
+    int i = 0;
+
+    for (i = 0; i < width; i++) {
+        r = (r << 1) | (v & 1);
+        v >>= 1;
+    }
+
+    return r;
+}
+
+void CRCModel_table (const CRCModel *m, uint64 *table) {
+    uint64 poly = 0ULL, part = 0ULL;
+    int i = 0, j = 0;
+
+    if (m->refin) {
+        poly = CRCModel_reflect (m->poly, m->width);
+        for (i = 0; i < TABSIZE; i++) {
+            part = (uint64)i;
+            for (j = 0; j < NUMBITS; j++) {
+                part = (part & 1) ? (part >> 1) ^ poly : part >> 1;
+            }
+            table[i] = part;
+        }
+    }
+    else {
+        /* register is kept in the top width bits */
+        poly = m->poly << (CRCBITS - m->width);
+        for (i = 0; i < TABSIZE; i++) {
+            part = (uint64)i << (CRCBITS - NUMBITS);
+            for (j = 0; j < NUMBITS; j++) {
+                part = (part >> (CRCBITS - 1)) ? (part << 1) ^ poly : part << 1;
+            }
+            table[i] = part;
+        }
+    }
+}
+
+/* register value before the first byte */
+uint64 CRCModel_start (const CRCModel *m) {
+    if (m->refin) {
+        return CRCModel_reflect (m->init, m->width);
+    }
+    return m->init << (CRCBITS - m->width);
+}
+
+/* register to checksum */
+uint64 CRCModel_final (const CRCModel *m, uint64 reg) {
+    if (!m->refin) {
+        reg >>= CRCBITS - m->width;
+    }
+    if (m->refin != m->refout) {
+        reg = CRCModel_reflect (reg, m->width);
+    }
+
+    return reg ^ m->xorout;
+}
+
+/* checksum to register, searches compare registers so targets are
+ * mapped once instead of finalising the register per byte */
+uint64 CRCModel_raw (const CRCModel *m, uint64 crc) {
+    uint64 reg = (crc & CRCModel_mask (m->width)) ^ m->xorout;
+
+    if (m->refin != m->refout) {
+        reg = CRCModel_reflect (reg, m->width);
+    }
+    if (!m->refin) {
+        reg <<= CRCBITS - m->width;
+    }
+
+    return reg;
+}
+
+uint64 CRCModel_compute (const CRCModel *m, const uint64 *table, const byte *buf, uint64 len) {
+    uint64 crc = CRCModel_start (m);
+
+    if (m->update) {
+        crc = m->update (crc, buf, len);
+    }
+    else if (m->refin) {
+        while (len--) {
+            crc = CRC_step (table, crc, *buf++, 1);
+        }
+    }
+    else {
+        while (len--) {
+            crc = CRC_step (table, crc, *buf++, 0);
+        }
+    }
+
+    return CRCModel_final (m, crc);
+}
+
+#ifdef MAKECRCTAB
+
+static const char *tables[] = {
+    "crc64_crcsearch_table",
+    "crc32_table",
+    "crc32c_table",
+    "crc64_xz_table",
+    "crc64_ecma_table",
+    "crc64_we_table"
+};
+
+int main (void) {
+    uint64 table[TABSIZE];
+    const CRCModel *m = NULL;
+    int i = 0, n = 0;
+
+    fprintf (stdout, "/* generated by bin/crcgen (make tables), do not edit */\n");
+    fprintf (stdout, "#ifndef __CRCTABLES_H_\n#define __CRCTABLES_H_\n");
+    for (m = CRCModels, n = 0; m->name; m++, n++) {
+        CRCModel_table (m, table);
+        if (CRCModel_compute (m, table, (const byte *)CHECKSTR, strlen (CHECKSTR)) != m->check) {
+            fprintf (stderr, "ERROR: check value mismatch for %s\n", m->name);
+            return ERROR;
+        }
+        fprintf (stdout, "\n/* %s */\nstatic const uint64 %s[%d] = {", m->name, tables[n], TABSIZE);
+        for (i = 0; i < TABSIZE; i++) {
+            fprintf (stdout, "%s0x%016llxULL%s", i % 4 ? " " : "\n    ", table[i], i < TABSIZE - 1 ? "," : "");
+        }
+        fprintf (stdout, "\n};\n");
+    }
+    fprintf (stdout, "\n#endif\n");
+
+    return SUCCESS;
+}
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef __CRCMODEL_H_
+#define __CRCMODEL_H_
+
+#include "crcsearch.h"
+
+/* CRC of the standard check string "123456789" */
+#define CHECKSTR "123456789"
+
+typedef struct CRCModel CRCModel;
+
+/* Rocksoft style CRC parameters, poly is given in normal (MSB first)
+ * form. Reflected models keep the register in the low width bits and
+ * shift right, normal models keep it in the top width bits and shift
+ * left so both run without masking */
+struct CRCModel {
+    const char *name;
+    int width;
+    uint64 poly;
+    byte refin;
+    byte refout;
+    uint64 init;
+    uint64 xorout;
+    uint64 check;
+    /* lookup table generated at build time, NULL for custom models */
+    const uint64 *table;
+    /* checksum loop specialised for the model's table */
+    uint64 (*update) (uint64, const byte *, uint64);
+};
+
+/* presets, terminated by an entry with a NULL name */
+extern const CRCModel CRCModels[];
+
+/* single byte step for either register layout, reflected is a constant
+ * at every call site so each layout gets its own loop */
+static inline __attribute__((always_inline))
+uint64 CRC_step (const uint64 *table, uint64 crc, byte b, const int reflected) {
+    if (reflected) {
+        return table[(crc ^ b) & 0xff] ^ (crc >> 8);
+    }
+    return table[(crc >> 56) ^ b] ^ (crc << 8);
+}
+
+const CRCModel * CRCModel_find (const char *);
+int CRCModel_parse (const char *, CRCModel *);
+void CRCModel_table (const CRCModel *, uint64 *);
+uint64 CRCModel_reflect (uint64, int);
+uint64 CRCModel_start (const CRCModel *);
+uint64 CRCModel_final (const CRCModel *, uint64);
+uint64 CRCModel_raw (const CRCModel *, uint64);
+uint64 CRCModel_compute (const CRCModel *, const uint64 *, const byte *, uint64);
+
+#endif
@@ -1,25 +1,14 @@
 #include <stdio.h>
-#include <unistd.h>
 #include <string.h>
 #include <errno.h>
 
 #include "crcsearch.h"
+#include "crcmodel.h"
+#include "crchw.h"
+#include "crcset.h"
+#include "crcstream.h"
 
-void usage (void) {
-    const char *usage = "NAME                                           \n\
-       crcsearch                                                        \n\
-                                                                        \n\
-SYNOPSIS                                                                \n\
-       crcsearch -i file -q crc checksum                                \n\
-                                                                        \n\
-DESCRIPTION                                                             \n\
-       Searches file for a given checksum and report it's range in file \n\
-\n";
-
-    fprintf (stdout, "%s", usage);
-}
-
-CRCSearch * CRCSearch_new (uint64 poly) {
+CRCSearch * CRCSearch_new (const CRCModel *model) {
     CRCSearch *this = (CRCSearch *) calloc (1, sizeof (CRCSearch));
     if (!this) {
         fprintf (stderr, "Out of memory (table)\n");
@@ -27,136 +16,268 @@ CRCSearch * CRCSearch_new (uint64 poly) {
     }
     this->init = &CRCSearch_init;
     this->search = &CRCSearch_search;
+    this->searchSet = &CRCSearch_searchSet;
+    this->window = &CRCSearch_window;
+    this->probe = &CRCSearch_probe;
+    this->update = &CRCSearch_update;
     this->close = &CRCSearch_close;
     this->found = 0;
     this->length = 0ULL;
+    this->matches = 0ULL;
 
-    this->init(this, poly);
+    this->init(this, model);
 
     return this;
 }
 
-void CRCSearch_init(CRCSearch *this, uint64 poly) {
-    int i = 0, j = 0;
-    uint64 part = 0ULL;
-
-    for (i = 0; i < TABSIZE; i++) {
-        part = (uint64)i;
-        /* perform calc, xor poly same times as number of bits shifted off */
-        for (j = 0; j < NUMBITS; j++) {
-            if (part & 1) {
-                /* first bit set, shift LSB off and xor with poly */
-                part = (part >> 1) ^ poly;
-            }
-            else {
-                /* shift LSB off, half the value */
-                part >>= 1;
-            }
-        }
-        this->table[i] = part;
+void CRCSearch_init(CRCSearch *this, const CRCModel *model) {
+    this->model = model;
+    if (model->table) {
+        /* preset, table generated at build time */
+        this->table = model->table;
+    }
+    else {
+        CRCModel_table (model, this->custom);
+        this->table = this->custom;
+    }
+    this->hw = (byte)CRCHW_supports (model);
+    if (this->hw) {
+        CRCHW_init ();
     }
 
     return;
 }
 
-uint64 CRCSearch_search(CRCSearch *this, const char *fname, uint64 query) {
-    uint64 crc = 0ULL;
-    unsigned char buff[BUFSIZE] = { '\0' };
-    int i = 0, numread = 0;
-    int totread = 0; 
+static uint64 gf2_times (const uint64 *mat, uint64 vec) {
+    uint64 sum = 0ULL;
 
-    /* open file */
-    FILE *fh = fopen (fname, "rb");
+    while (vec) {
+        if (vec & 1) {
+            sum ^= *mat;
+        }
+        vec >>= 1;
+        mat++;
+    }
 
-    if (!fh) {
-        fprintf (stderr, "ERROR: could not open file %s\n", fname);
-        return (uint64)NULL;
+    return sum;
+}
+
+static void gf2_square (uint64 *square, const uint64 *mat) {
+    int i = 0;
+
+    for (i = 0; i < CRCBITS; i++) {
+        square[i] = gf2_times (mat, mat[i]);
     }
+}
 
-    while ((numread = (int)fread(&buff, sizeof(unsigned char), BUFSIZE, fh))) {
-        for (i = 0; i < numread; i++) {
-            /* xor running CRC with value in buffer retaining 
-             * first byte only as index into lookup table
-             * xor running CRC, ignoring bottom byte, with lookup CRC 
-             */
-            crc = this->table[(crc ^ buff[i]) &  0xff] ^ (crc >> 8);
-            totread++;
+/* advance crc over n zero bytes in O(log n), the CRC is linear so the
+ * zero byte step is a 64x64 matrix over GF(2) which is squared per bit of n */
+uint64 CRCSearch_zeros(CRCSearch *this, uint64 crc, uint64 n) {
+    uint64 mat[CRCBITS], tmp[CRCBITS];
+    int i = 0;
 
-            if (0) {
-                /* debug */
-                fprintf (stderr, "[%d]: 0x%llx\n", totread, crc);
-            }
+    /* one zero byte step applied to each register bit */
+    for (i = 0; i < CRCBITS; i++) {
+        mat[i] = CRC_step (this->table, 1ULL << i, 0, this->model->refin);
+    }
 
-            if (crc == query) {
-                this->found = (byte)1;
-                this->length = totread;
-                break;
-            }
+    while (n) {
+        if (n & 1) {
+            crc = gf2_times (mat, crc);
+        }
+        n >>= 1;
+        if (n) {
+            gf2_square (tmp, mat);
+            memcpy (mat, tmp, sizeof (mat));
         }
     }
-        
-    /* close file */
-    fclose (fh);
 
     return crc;
 }
 
-void CRCSearch_close (CRCSearch **this) {
-    if (*this) free(*this);
+/* run the CRC over buf, returns number of bytes up to and including the
+ * first one leaving the register equal to query, or 0 */
+static inline __attribute__((always_inline))
+int CRCSearch_scan (const uint64 *table, uint64 *reg, const byte *buf, int len, uint64 query, const int reflected) {
+    uint64 crc = *reg;
+    int i = 0;
+
+    for (i = 0; i < len; i++) {
+        crc = CRC_step (table, crc, buf[i], reflected);
+        if (crc == query) {
+            *reg = crc;
+            return i + 1;
+        }
+    }
+    *reg = crc;
+
+    return 0;
+}
+
+/* as scan, probing every prefix against the set */
+static inline __attribute__((always_inline))
+void CRCSearch_scanSet (CRCSearch *this, uint64 *reg, const byte *buf, int len, uint64 offset,
+        CRCSet *set, CRCReport report, void *ctx, const int reflected) {
+    const uint64 *table = this->table;
+    uint64 crc = *reg;
+    int i = 0;
+
+    for (i = 0; i < len; i++) {
+        crc = CRC_step (table, crc, buf[i], reflected);
+        if (CRCSet_has (set, crc)) {
+            this->found = (byte)1;
+            this->length = offset + i + 1;
+            this->matches++;
+            if (report) {
+                report (ctx, CRCModel_final (this->model, crc), 0ULL, offset + i + 1);
+            }
+        }
+    }
+    *reg = crc;
 }
 
-#define CRC_64_ECMA_182 0x42f0e1eba9ea3693ULL
-
-int main (int argc, char **argv) {
-    char *fname = NULL;
-    uint64 crc = 0ULL;
-    uint64 poly = CRC_64_ECMA_182;
-    char c = 0;
-    CRCSearch *cs;
-
-    /* parse command line */
-    while ((c = getopt (argc, argv, "i:q:p:")) != -1) {
-        switch (c) {
-            case 'i':
-                fname = strdup (optarg);
-                break;
-            case 'q':
-                crc = strtoll (optarg, NULL, 16); 
-                break;
-            case 'p':
-                fprintf (stdout, "INFO: Using user provided polynomial: %s\n", optarg);
-                poly = strtoll (optarg, NULL, 16);
-                break;
-            case '?':
-                fprintf (stderr, "Invalid option: %c\n", c);
-                return ERROR;
-            default:
-                usage();
-                return SUCCESS;
+/* hardware CRC-32C scan, chunks with a match are rescanned on the table
+ * to find the first one */
+static int CRCSearch_scanHW (const uint64 *table, uint64 *reg, const byte *buf, int len, uint64 query) {
+    uint64 saved = 0ULL;
+    int off = 0, n = 0, pos = 0;
+
+    for (off = 0; off < len; off += n) {
+        n = len - off < HWCHUNK ? len - off : HWCHUNK;
+        saved = *reg;
+        if (CRCHW_chunk (reg, buf + off, n, query, NULL)) {
+            *reg = saved;
+            pos = CRCSearch_scan (table, reg, buf + off, n, query, 1);
+            return off + pos;
         }
     }
 
-    if (argc == 1) {
-        usage();
-        return SUCCESS;
+    return 0;
+}
+
+uint64 CRCSearch_search(CRCSearch *this, const char *fname, uint64 query) {
+    uint64 crc = CRCModel_start (this->model);
+    uint64 totread = 0ULL;
+    const byte *buff = NULL;
+    int numread = 0, pos = 0;
+    CRCStream *in = NULL;
+
+    /* compare registers, not checksums */
+    query = CRCModel_raw (this->model, query);
+
+    /* open file or stdin */
+    in = CRCStream_open (fname, this->progress);
+    if (!in) {
+        return (uint64)NULL;
     }
 
-    /* setup search and lookup table */
-    cs = CRCSearch_new(poly);
-    fprintf (stdout, "INFO: Searching for checksum: %llu in file: %s\n", crc, fname);
-    if (cs->search(cs, fname, crc)) {
-        if (cs->found) {
-            fprintf (stdout, "INFO: Checksum: %llu valid for first %llu bytes of file: %s\n", crc, cs->length, fname);
+    while (!this->found && (numread = (int)in->next (in, &buff)) > 0) {
+        /* xor running CRC with the next byte as index into lookup table
+         * and xor in the running CRC, less the byte shifted out */
+        if (this->hw) {
+            pos = CRCSearch_scanHW (this->table, &crc, buff, numread, query);
+        }
+        else if (this->model->refin) {
+            pos = CRCSearch_scan (this->table, &crc, buff, numread, query, 1);
         }
         else {
-            fprintf (stdout, "INFO: Checksum: %llu is not valid for contents of file: %s\n", crc, fname);
+            pos = CRCSearch_scan (this->table, &crc, buff, numread, query, 0);
+        }
+        if (pos) {
+            this->found = (byte)1;
+            this->length = totread + pos;
         }
+        totread += numread;
     }
-    cs->close(&cs);
+        
+    /* close file */
+    in->close (&in);
+
+    return CRCModel_final (this->model, crc);
+}
+
+/* hardware CRC-32C set scan, chunks with matches are rescanned on the
+ * table to report them in order */
+static void CRCSearch_scanSetHW (CRCSearch *this, uint64 *reg, const byte *buf, int len, uint64 offset,
+        CRCSet *set, CRCReport report, void *ctx) {
+    uint64 saved = 0ULL;
+    int off = 0, n = 0;
 
-    if (fname) {
-        free (fname);
+    for (off = 0; off < len; off += n) {
+        n = len - off < HWCHUNK ? len - off : HWCHUNK;
+        saved = *reg;
+        if (CRCHW_chunk (reg, buf + off, n, 0ULL, set)) {
+            *reg = saved;
+            CRCSearch_scanSet (this, reg, buf + off, n, offset + off, set, report, ctx, 1);
+        }
     }
+}
 
+/* advance reg over buf, which starts offset bytes into the input, and
+ * report every prefix ending in buf whose register is in the set */
+void CRCSearch_probe(CRCSearch *this, uint64 *reg, const byte *buf, int len, uint64 offset,
+        CRCSet *set, CRCReport report, void *ctx) {
+    if (this->hw) {
+        CRCSearch_scanSetHW (this, reg, buf, len, offset, set, report, ctx);
+    }
+    else if (this->model->refin) {
+        CRCSearch_scanSet (this, reg, buf, len, offset, set, report, ctx, 1);
+    }
+    else {
+        CRCSearch_scanSet (this, reg, buf, len, offset, set, report, ctx, 0);
+    }
+}
+
+/* advance reg over buf without probing */
+uint64 CRCSearch_update(CRCSearch *this, uint64 reg, const byte *buf, uint64 len) {
+    uint64 i = 0ULL;
+
+    if (this->hw) {
+        return CRCHW_update (reg, buf, len);
+    }
+    if (this->model->refin) {
+        for (i = 0; i < len; i++) {
+            reg = CRC_step (this->table, reg, buf[i], 1);
+        }
+    }
+    else {
+        for (i = 0; i < len; i++) {
+            reg = CRC_step (this->table, reg, buf[i], 0);
+        }
+    }
+
+    return reg;
+}
+
+/* returns SUCCESS or ERROR with errno set */
+int CRCSearch_searchSet(CRCSearch *this, const char *fname, CRCSet *set, CRCReport report, void *ctx) {
+    uint64 crc = CRCModel_start (this->model);
+    uint64 totread = 0ULL;
+    const byte *buff = NULL;
+    int numread = 0, err = 0;
+    CRCStream *in = CRCStream_open (fname, this->progress);
+
+    if (!in) {
+        return ERROR;
+    }
+
+    /* same running CRC as search, every prefix is probed against the set */
+    while ((numread = (int)in->next (in, &buff)) > 0) {
+        CRCSearch_probe (this, &crc, buff, numread, totread, set, report, ctx);
+        totread += numread;
+    }
+    this->length = totread;
+    err = numread < 0 ? in->error : 0;
+
+    in->close (&in);
+
+    if (err) {
+        errno = err;
+        return ERROR;
+    }
     return SUCCESS;
 }
+
+void CRCSearch_close (CRCSearch **this) {
+    if (*this) free(*this);
+}
@@ -9,25 +9,50 @@
 
 #define TABSIZE 256
 #define NUMBITS 8
-#define BUFSIZE 256
+/* read size, a multiple of the 3 stream chunk in crchw.h */
+#define BUFSIZE 3145728
+#define CRCBITS 64
 
 typedef unsigned char byte;
 typedef unsigned long long uint64;
 typedef struct CRCSearch CRCSearch;
+typedef struct CRCSet CRCSet;
+typedef struct CRCModel CRCModel;
+
+/* match callback: context, checksum, start and end offset [start, end) */
+typedef void (*CRCReport) (void *, uint64, uint64, uint64);
 
 struct CRCSearch {
-    /* lookup table */
-    uint64 table[TABSIZE];
+    /* lookup table, the preset's build time table or custom */
+    const uint64 *table;
+    uint64 custom[TABSIZE];
+    /* CRC parameters, not owned */
+    const CRCModel *model;
+    /* CRC-32C on the crc32 instruction */
+    byte hw;
+    /* report bytes read and GB/s to stderr while searching */
+    byte progress;
     byte found;
     uint64 length;
-    void (*init) (CRCSearch *, uint64);
+    /* number of matches reported by searchSet */
+    uint64 matches;
+    void (*init) (CRCSearch *, const CRCModel *);
     uint64 (*search) (CRCSearch *, const char*, uint64);
+    int (*searchSet) (CRCSearch *, const char*, CRCSet *, CRCReport, void *);
+    int (*window) (CRCSearch *, const char*, const uint64 *, int, CRCSet *, CRCReport, void *, uint64 *);
+    void (*probe) (CRCSearch *, uint64 *, const byte *, int, uint64, CRCSet *, CRCReport, void *);
+    uint64 (*update) (CRCSearch *, uint64, const byte *, uint64);
     void (*close) (CRCSearch **);
 };
 
-CRCSearch * CRCSearch_new (uint64);
-void CRCSearch_init(CRCSearch *, uint64);
+CRCSearch * CRCSearch_new (const CRCModel *);
+void CRCSearch_init(CRCSearch *, const CRCModel *);
 uint64 CRCSearch_search(CRCSearch *, const char *, uint64);
+int CRCSearch_searchSet(CRCSearch *, const char *, CRCSet *, CRCReport, void *);
+int CRCSearch_window(CRCSearch *, const char *, const uint64 *, int, CRCSet *, CRCReport, void *, uint64 *);
+void CRCSearch_probe(CRCSearch *, uint64 *, const byte *, int, uint64, CRCSet *, CRCReport, void *);
+uint64 CRCSearch_update(CRCSearch *, uint64, const byte *, uint64);
+uint64 CRCSearch_zeros(CRCSearch *, uint64, uint64);
 void CRCSearch_close (CRCSearch **);
 
 #endif
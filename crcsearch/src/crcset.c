@@ -0,0 +1,147 @@
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#include "crcmodel.h"
+#include "crcset.h"
+
+#define LINESIZE 256
+
+static int CRCSet_alloc (CRCSet *this, uint64 size) {
+    int shift = 64;
+    uint64 n = 1ULL;
+
+    while (n < size) {
+        n <<= 1;
+    }
+    while ((1ULL << (64 - shift)) < n) {
+        shift--;
+    }
+
+    this->slots = (uint64 *) calloc (n, sizeof (uint64));
+    if (!this->slots) {
+        fprintf (stderr, "Out of memory (set)\n");
+        return ERROR;
+    }
+    this->mask = n - 1;
+    this->shift = shift;
+
+    return SUCCESS;
+}
+
+static void CRCSet_insert (CRCSet *this, uint64 crc) {
+    uint64 i = (crc * SETHASH) >> this->shift;
+
+    while (this->slots[i]) {
+        if (this->slots[i] == crc) {
+            return;
+        }
+        i = (i + 1) & this->mask;
+    }
+    this->slots[i] = crc;
+    this->count++;
+}
+
+static int CRCSet_grow (CRCSet *this) {
+    uint64 *old = this->slots;
+    uint64 size = this->mask + 1, i = 0;
+
+    if (CRCSet_alloc (this, size << 1) != SUCCESS) {
+        this->slots = old;
+        return ERROR;
+    }
+    this->count = 0ULL;
+    for (i = 0; i < size; i++) {
+        if (old[i]) {
+            CRCSet_insert (this, old[i]);
+        }
+    }
+    free (old);
+
+    return SUCCESS;
+}
+
+CRCSet * CRCSet_new (void) {
+    CRCSet *this = (CRCSet *) calloc (1, sizeof (CRCSet));
+    if (!this) {
+        fprintf (stderr, "Out of memory (set)\n");
+        return NULL;
+    }
+    if (CRCSet_alloc (this, SETSIZE) != SUCCESS) {
+        free (this);
+        return NULL;
+    }
+    this->add = &CRCSet_add;
+    this->contains = &CRCSet_contains;
+    this->close = &CRCSet_close;
+
+    return this;
+}
+
+/* one hex checksum per line, blank lines and # comments are skipped,
+ * checksums are stored as the model's register values */
+CRCSet * CRCSet_load (const char *fname, const CRCModel *model) {
+    char line[LINESIZE] = { '\0' };
+    char *p = NULL, *end = NULL;
+    int lineno = 0;
+    uint64 crc = 0ULL;
+    CRCSet *this = NULL;
+    FILE *fh = fopen (fname, "r");
+
+    if (!fh) {
+        fprintf (stderr, "ERROR: could not open file %s: %s\n", fname, strerror (errno));
+        return NULL;
+    }
+    this = CRCSet_new ();
+    if (!this) {
+        fclose (fh);
+        return NULL;
+    }
+
+    while (fgets (line, LINESIZE, fh)) {
+        lineno++;
+        for (p = line; *p == ' ' || *p == '\t'; p++);
+        if (*p == '#' || *p == '\n' || *p == '\r' || *p == '\0') {
+            continue;
+        }
+        errno = 0;
+        crc = strtoull (p, &end, 16);
+        if (end == p || errno) {
+            fprintf (stderr, "WARN: skipping invalid checksum on line %d of %s\n", lineno, fname);
+            continue;
+        }
+        if (this->add (this, CRCModel_raw (model, crc)) != SUCCESS) {
+            this->close (&this);
+            break;
+        }
+    }
+    fclose (fh);
+
+    return this;
+}
+
+int CRCSet_add (CRCSet *this, uint64 crc) {
+    if (!crc) {
+        this->zero = (byte)1;
+        return SUCCESS;
+    }
+    /* keep load factor at or below 1/2 so misses stop at the first probe */
+    if ((this->count + 1) * 2 > this->mask + 1 && CRCSet_grow (this) != SUCCESS) {
+        return ERROR;
+    }
+    CRCSet_insert (this, crc);
+
+    return SUCCESS;
+}
+
+int CRCSet_contains (CRCSet *this, uint64 crc) {
+    return CRCSet_has (this, crc);
+}
+
+void CRCSet_close (CRCSet **this) {
+    if (*this) {
+        free ((*this)->slots);
+        free (*this);
+    }
+    *this = NULL;
+}
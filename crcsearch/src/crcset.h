@@ -0,0 +1,50 @@
+#ifndef __CRCSET_H_
+#define __CRCSET_H_
+
+#include "crcsearch.h"
+
+/* initial number of slots, always a power of 2 */
+#define SETSIZE 64
+/* fibonacci hashing multiplier, 2^64 / golden ratio */
+#define SETHASH 0x9e3779b97f4a7c15ULL
+
+typedef struct CRCSet CRCSet;
+
+/* open addressing (linear probing) set of target checksums, 0 marks an
+ * empty slot so a target of 0 is tracked separately and not in count */
+struct CRCSet {
+    uint64 *slots;
+    uint64 mask;
+    uint64 count;
+    int shift;
+    byte zero;
+    int (*add) (CRCSet *, uint64);
+    int (*contains) (CRCSet *, uint64);
+    void (*close) (CRCSet **);
+};
+
+CRCSet * CRCSet_new (void);
+CRCSet * CRCSet_load (const char *, const CRCModel *);
+int CRCSet_add (CRCSet *, uint64);
+int CRCSet_contains (CRCSet *, uint64);
+void CRCSet_close (CRCSet **);
+
+/* hot path probe, called once per byte searched */
+static inline int CRCSet_has (const CRCSet *this, uint64 crc) {
+    uint64 i;
+
+    if (!crc) {
+        return this->zero;
+    }
+    i = (crc * SETHASH) >> this->shift;
+    while (this->slots[i]) {
+        if (this->slots[i] == crc) {
+            return 1;
+        }
+        i = (i + 1) & this->mask;
+    }
+
+    return 0;
+}
+
+#endif
@@ -0,0 +1,211 @@
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "crcstream.h"
+
+static double CRCStream_now (void) {
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void CRCStream_unlock (void *lock) {
+    pthread_mutex_unlock ((pthread_mutex_t *)lock);
+}
+
+/* fill buffers in turn, pipes return short reads so keep reading until a
+ * buffer is full, hardware chunks then line up with buffer boundaries */
+static void * CRCStream_reader (void *arg) {
+    CRCStream *this = (CRCStream *)arg;
+    long long len = 0;
+    ssize_t n = 0;
+    int slot = 0, stop = 0;
+
+    for (;;) {
+        pthread_mutex_lock (&this->lock);
+        pthread_cleanup_push (&CRCStream_unlock, &this->lock);
+        while (this->full[slot] && !this->stop) {
+            pthread_cond_wait (&this->cond, &this->lock);
+        }
+        stop = this->stop;
+        pthread_cleanup_pop (1);
+        if (stop) {
+            break;
+        }
+
+        len = 0;
+        while (len < BUFSIZE) {
+            n = read (this->fd, this->buf[slot] + len, BUFSIZE - len);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0) {
+                this->error = errno;
+                fprintf (stderr, "ERROR: read failed: %s\n", strerror (errno));
+                len = -1;
+                break;
+            }
+            if (n == 0) {
+                break;
+            }
+            len += n;
+        }
+
+        pthread_mutex_lock (&this->lock);
+        this->len[slot] = len;
+        this->full[slot] = (byte)1;
+        pthread_cond_broadcast (&this->cond);
+        pthread_mutex_unlock (&this->lock);
+
+        if (len <= 0) {
+            break;
+        }
+        slot ^= 1;
+    }
+
+    return NULL;
+}
+
+CRCStream * CRCStream_fdopen (int fd, byte progress) {
+    CRCStream *this = (CRCStream *) calloc (1, sizeof (CRCStream));
+    if (!this) {
+        fprintf (stderr, "Out of memory (stream)\n");
+        return NULL;
+    }
+    this->buf[0] = (byte *) malloc (BUFSIZE);
+    this->buf[1] = (byte *) malloc (BUFSIZE);
+    if (!this->buf[0] || !this->buf[1]) {
+        fprintf (stderr, "Out of memory (stream buffer)\n");
+        free (this->buf[0]);
+        free (this->buf[1]);
+        free (this);
+        return NULL;
+    }
+    this->fd = fd;
+    this->progress = progress;
+    this->current = -1;
+    this->started = this->reported = CRCStream_now ();
+    this->next = &CRCStream_next;
+    this->close = &CRCStream_close;
+    pthread_mutex_init (&this->lock, NULL);
+    pthread_cond_init (&this->cond, NULL);
+
+    if (pthread_create (&this->reader, NULL, &CRCStream_reader, this)) {
+        fprintf (stderr, "ERROR: could not start reader thread\n");
+        pthread_mutex_destroy (&this->lock);
+        pthread_cond_destroy (&this->cond);
+        free (this->buf[0]);
+        free (this->buf[1]);
+        free (this);
+        return NULL;
+    }
+
+    return this;
+}
+
+/* file name or - for stdin */
+CRCStream * CRCStream_open (const char *fname, byte progress) {
+    CRCStream *this = NULL;
+    int fd = 0, err = 0;
+
+    if (!fname || !strcmp (fname, STDIN_NAME)) {
+        return CRCStream_fdopen (STDIN_FILENO, progress);
+    }
+
+    fd = open (fname, O_RDONLY);
+    if (fd < 0) {
+        err = errno;
+        fprintf (stderr, "ERROR: could not open file %s\n", fname);
+        errno = err;
+        return NULL;
+    }
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise (fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    this = CRCStream_fdopen (fd, progress);
+    if (!this) {
+        close (fd);
+        errno = ENOMEM;
+        return NULL;
+    }
+    this->owned = (byte)1;
+
+    return this;
+}
+
+static void CRCStream_report (CRCStream *this, double now) {
+    double secs = now - this->started;
+
+    fprintf (stderr, "PROGRESS: %llu MB read, %.2f GB/s\n",
+        this->total >> 20, secs > 0.0 ? this->total / secs / 1e9 : 0.0);
+    this->reported = now;
+}
+
+/* hand back the previous buffer and wait for the next one, returns its
+ * length, 0 at end of input or -1 on error */
+long long CRCStream_next (CRCStream *this, const byte **buf) {
+    long long len = 0;
+    double now = 0.0;
+    int slot = 0;
+
+    pthread_mutex_lock (&this->lock);
+    if (this->current >= 0) {
+        this->full[this->current] = (byte)0;
+        slot = this->current ^ 1;
+        pthread_cond_broadcast (&this->cond);
+    }
+    while (!this->full[slot]) {
+        pthread_cond_wait (&this->cond, &this->lock);
+    }
+    len = this->len[slot];
+    pthread_mutex_unlock (&this->lock);
+
+    this->current = slot;
+    *buf = this->buf[slot];
+    if (len > 0) {
+        this->total += len;
+    }
+
+    if (this->progress) {
+        now = CRCStream_now ();
+        if (now - this->reported >= PROGRESS_INTERVAL) {
+            CRCStream_report (this, now);
+        }
+    }
+
+    return len;
+}
+
+void CRCStream_close (CRCStream **this) {
+    CRCStream *s = *this;
+
+    if (!s) {
+        return;
+    }
+
+    /* the reader may be blocked in read on a live pipe */
+    pthread_mutex_lock (&s->lock);
+    s->stop = (byte)1;
+    pthread_cond_broadcast (&s->cond);
+    pthread_mutex_unlock (&s->lock);
+    pthread_cancel (s->reader);
+    pthread_join (s->reader, NULL);
+
+    if (s->progress) {
+        CRCStream_report (s, CRCStream_now ());
+    }
+    if (s->owned) {
+        close (s->fd);
+    }
+    pthread_mutex_destroy (&s->lock);
+    pthread_cond_destroy (&s->cond);
+    free (s->buf[0]);
+    free (s->buf[1]);
+    free (s);
+    *this = NULL;
+}
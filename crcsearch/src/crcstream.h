@@ -0,0 +1,45 @@
+#ifndef __CRCSTREAM_H_
+#define __CRCSTREAM_H_
+
+#include <pthread.h>
+
+#include "crcsearch.h"
+
+/* stdin as input file name */
+#define STDIN_NAME "-"
+/* seconds between progress reports */
+#define PROGRESS_INTERVAL 1.0
+
+typedef struct CRCStream CRCStream;
+
+/* double buffered reader, a thread fills one buffer while the caller
+ * runs the CRC over the other */
+struct CRCStream {
+    int fd;
+    byte owned;
+    byte progress;
+    byte stop;
+    byte *buf[2];
+    /* bytes in each buffer, -1 on read error, 0 at end of input */
+    long long len[2];
+    /* errno of the failed read, set before its buffer is handed out */
+    int error;
+    byte full[2];
+    /* buffer handed out by next, -1 before the first call */
+    int current;
+    uint64 total;
+    double started;
+    double reported;
+    pthread_t reader;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    long long (*next) (CRCStream *, const byte **);
+    void (*close) (CRCStream **);
+};
+
+CRCStream * CRCStream_open (const char *, byte);
+CRCStream * CRCStream_fdopen (int, byte);
+long long CRCStream_next (CRCStream *, const byte **);
+void CRCStream_close (CRCStream **);
+
+#endif
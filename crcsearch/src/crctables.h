@@ -0,0 +1,413 @@
+/* generated by bin/crcgen (make tables), do not edit */
+#ifndef __CRCTABLES_H_
+#define __CRCTABLES_H_
+
+/* crcsearch */
+static const uint64 crc64_crcsearch_table[256] = {
+    0x0000000000000000ULL, 0x3c3b78e888d80fe1ULL, 0x7876f1d111b01fc2ULL, 0x444d893999681023ULL,
+    0x750c207570b452a3ULL, 0x4937589df86c5d42ULL, 0x0d7ad1a461044d61ULL, 0x3141a94ce9dc4280ULL,
+    0x6ff9833db2bcc861ULL, 0x53c2fbd53a64c780ULL, 0x178f72eca30cd7a3ULL, 0x2bb40a042bd4d842ULL,
+    0x1af5a348c2089ac2ULL, 0x26cedba04ad09523ULL, 0x62835299d3b88500ULL, 0x5eb82a715b608ae1ULL,
+    0x5a12c5ac36adfde5ULL, 0x6629bd44be75f204ULL, 0x2264347d271de227ULL, 0x1e5f4c95afc5edc6ULL,
+    0x2f1ee5d94619af46ULL, 0x13259d31cec1a0a7ULL, 0x5768140857a9b084ULL, 0x6b536ce0df71bf65ULL,
+    0x35eb469184113584ULL, 0x09d03e790cc93a65ULL, 0x4d9db74095a12a46ULL, 0x71a6cfa81d7925a7ULL,
+    0x40e766e4f4a56727ULL, 0x7cdc1e0c7c7d68c6ULL, 0x38919735e51578e5ULL, 0x04aaefdd6dcd7704ULL,
+    0x31c4488f3e8f96edULL, 0x0dff3067b657990cULL, 0x49b2b95e2f3f892fULL, 0x7589c1b6a7e786ceULL,
+    0x44c868fa4e3bc44eULL, 0x78f31012c6e3cbafULL, 0x3cbe992b5f8bdb8cULL, 0x0085e1c3d753d46dULL,
+    0x5e3dcbb28c335e8cULL, 0x6206b35a04eb516dULL, 0x264b3a639d83414eULL, 0x1a70428b155b4eafULL,
+    0x2b31ebc7fc870c2fULL, 0x170a932f745f03ceULL, 0x53471a16ed3713edULL, 0x6f7c62fe65ef1c0cULL,
+    0x6bd68d2308226b08ULL, 0x57edf5cb80fa64e9ULL, 0x13a07cf2199274caULL, 0x2f9b041a914a7b2bULL,
+    0x1edaad56789639abULL, 0x22e1d5bef04e364aULL, 0x66ac5c8769262669ULL, 0x5a97246fe1fe2988ULL,
+    0x042f0e1eba9ea369ULL, 0x381476f63246ac88ULL, 0x7c59ffcfab2ebcabULL, 0x4062872723f6b34aULL,
+    0x71232e6bca2af1caULL, 0x4d18568342f2fe2bULL, 0x0955dfbadb9aee08ULL, 0x356ea7525342e1e9ULL,
+    0x6388911e7d1f2ddaULL, 0x5fb3e9f6f5c7223bULL, 0x1bfe60cf6caf3218ULL, 0x27c51827e4773df9ULL,
+    0x1684b16b0dab7f79ULL, 0x2abfc98385737098ULL, 0x6ef240ba1c1b60bbULL, 0x52c9385294c36f5aULL,
+    0x0c711223cfa3e5bbULL, 0x304a6acb477bea5aULL, 0x7407e3f2de13fa79ULL, 0x483c9b1a56cbf598ULL,
+    0x797d3256bf17b718ULL, 0x45464abe37cfb8f9ULL, 0x010bc387aea7a8daULL, 0x3d30bb6f267fa73bULL,
+    0x399a54b24bb2d03fULL, 0x05a12c5ac36adfdeULL, 0x41eca5635a02cffdULL, 0x7dd7dd8bd2dac01cULL,
+    0x4c9674c73b06829cULL, 0x70ad0c2fb3de8d7dULL, 0x34e085162ab69d5eULL, 0x08dbfdfea26e92bfULL,
+    0x5663d78ff90e185eULL, 0x6a58af6771d617bfULL, 0x2e15265ee8be079cULL, 0x122e5eb66066087dULL,
+    0x236ff7fa89ba4afdULL, 0x1f548f120162451cULL, 0x5b19062b980a553fULL, 0x67227ec310d25adeULL,
+    0x524cd9914390bb37ULL, 0x6e77a179cb48b4d6ULL, 0x2a3a28405220a4f5ULL, 0x160150a8daf8ab14ULL,
+    0x2740f9e43324e994ULL, 0x1b7b810cbbfce675ULL, 0x5f3608352294f656ULL, 0x630d70ddaa4cf9b7ULL,
+    0x3db55aacf12c7356ULL, 0x018e224479f47cb7ULL, 0x45c3ab7de09c6c94ULL, 0x79f8d39568446375ULL,
+    0x48b97ad9819821f5ULL, 0x7482023109402e14ULL, 0x30cf8b0890283e37ULL, 0x0cf4f3e018f031d6ULL,
+    0x085e1c3d753d46d2ULL, 0x346564d5fde54933ULL, 0x7028edec648d5910ULL, 0x4c139504ec5556f1ULL,
+    0x7d523c4805891471ULL, 0x416944a08d511b90ULL, 0x0524cd9914390bb3ULL, 0x391fb5719ce10452ULL,
+    0x67a79f00c7818eb3ULL, 0x5b9ce7e84f598152ULL, 0x1fd16ed1d6319171ULL, 0x23ea16395ee99e90ULL,
+    0x12abbf75b735dc10ULL, 0x2e90c79d3fedd3f1ULL, 0x6add4ea4a685c3d2ULL, 0x56e6364c2e5dcc33ULL,
+    0x42f0e1eba9ea3693ULL, 0x7ecb990321323972ULL, 0x3a86103ab85a2951ULL, 0x06bd68d2308226b0ULL,
+    0x37fcc19ed95e6430ULL, 0x0bc7b97651866bd1ULL, 0x4f8a304fc8ee7bf2ULL, 0x73b148a740367413ULL,
+    0x2d0962d61b56fef2ULL, 0x11321a3e938ef113ULL, 0x557f93070ae6e130ULL, 0x6944ebef823eeed1ULL,
+    0x580542a36be2ac51ULL, 0x643e3a4be33aa3b0ULL, 0x2073b3727a52b393ULL, 0x1c48cb9af28abc72ULL,
+    0x18e224479f47cb76ULL, 0x24d95caf179fc497ULL, 0x6094d5968ef7d4b4ULL, 0x5cafad7e062fdb55ULL,
+    0x6dee0432eff399d5ULL, 0x51d57cda672b9634ULL, 0x1598f5e3fe438617ULL, 0x29a38d0b769b89f6ULL,
+    0x771ba77a2dfb0317ULL, 0x4b20df92a5230cf6ULL, 0x0f6d56ab3c4b1cd5ULL, 0x33562e43b4931334ULL,
+    0x0217870f5d4f51b4ULL, 0x3e2cffe7d5975e55ULL, 0x7a6176de4cff4e76ULL, 0x465a0e36c4274197ULL,
+    0x7334a9649765a07eULL, 0x4f0fd18c1fbdaf9fULL, 0x0b4258b586d5bfbcULL, 0x3779205d0e0db05dULL,
+    0x06388911e7d1f2ddULL, 0x3a03f1f96f09fd3cULL, 0x7e4e78c0f661ed1fULL, 0x427500287eb9e2feULL,
+    0x1ccd2a5925d9681fULL, 0x20f652b1ad0167feULL, 0x64bbdb88346977ddULL, 0x5880a360bcb1783cULL,
+    0x69c10a2c556d3abcULL, 0x55fa72c4ddb5355dULL, 0x11b7fbfd44dd257eULL, 0x2d8c8315cc052a9fULL,
+    0x29266cc8a1c85d9bULL, 0x151d14202910527aULL, 0x51509d19b0784259ULL, 0x6d6be5f138a04db8ULL,
+    0x5c2a4cbdd17c0f38ULL, 0x6011345559a400d9ULL, 0x245cbd6cc0cc10faULL, 0x1867c58448141f1bULL,
+    0x46dfeff5137495faULL, 0x7ae4971d9bac9a1bULL, 0x3ea91e2402c48a38ULL, 0x029266cc8a1c85d9ULL,
+    0x33d3cf8063c0c759ULL, 0x0fe8b768eb18c8b8ULL, 0x4ba53e517270d89bULL, 0x779e46b9faa8d77aULL,
+    0x217870f5d4f51b49ULL, 0x1d43081d5c2d14a8ULL, 0x590e8124c545048bULL, 0x6535f9cc4d9d0b6aULL,
+    0x54745080a44149eaULL, 0x684f28682c99460bULL, 0x2c02a151b5f15628ULL, 0x1039d9b93d2959c9ULL,
+    0x4e81f3c86649d328ULL, 0x72ba8b20ee91dcc9ULL, 0x36f7021977f9cceaULL, 0x0acc7af1ff21c30bULL,
+    0x3b8dd3bd16fd818bULL, 0x07b6ab559e258e6aULL, 0x43fb226c074d9e49ULL, 0x7fc05a848f9591a8ULL,
+    0x7b6ab559e258e6acULL, 0x4751cdb16a80e94dULL, 0x031c4488f3e8f96eULL, 0x3f273c607b30f68fULL,
+    0x0e66952c92ecb40fULL, 0x325dedc41a34bbeeULL, 0x761064fd835cabcdULL, 0x4a2b1c150b84a42cULL,
+    0x1493366450e42ecdULL, 0x28a84e8cd83c212cULL, 0x6ce5c7b54154310fULL, 0x50debf5dc98c3eeeULL,
+    0x619f161120507c6eULL, 0x5da46ef9a888738fULL, 0x19e9e7c031e063acULL, 0x25d29f28b9386c4dULL,
+    0x10bc387aea7a8da4ULL, 0x2c87409262a28245ULL, 0x68cac9abfbca9266ULL, 0x54f1b14373129d87ULL,
+    0x65b0180f9acedf07ULL, 0x598b60e71216d0e6ULL, 0x1dc6e9de8b7ec0c5ULL, 0x21fd913603a6cf24ULL,
+    0x7f45bb4758c645c5ULL, 0x437ec3afd01e4a24ULL, 0x07334a9649765a07ULL, 0x3b08327ec1ae55e6ULL,
+    0x0a499b3228721766ULL, 0x3672e3daa0aa1887ULL, 0x723f6ae339c208a4ULL, 0x4e04120bb11a0745ULL,
+    0x4aaefdd6dcd77041ULL, 0x7695853e540f7fa0ULL, 0x32d80c07cd676f83ULL, 0x0ee374ef45bf6062ULL,
+    0x3fa2dda3ac6322e2ULL, 0x0399a54b24bb2d03ULL, 0x47d42c72bdd33d20ULL, 0x7bef549a350b32c1ULL,
+    0x25577eeb6e6bb820ULL, 0x196c0603e6b3b7c1ULL, 0x5d218f3a7fdba7e2ULL, 0x611af7d2f703a803ULL,
+    0x505b5e9e1edfea83ULL, 0x6c6026769607e562ULL, 0x282daf4f0f6ff541ULL, 0x1416d7a787b7faa0ULL
+};
+
+/* crc-32 */
+static const uint64 crc32_table[256] = {
+    0x0000000000000000ULL, 0x0000000077073096ULL, 0x00000000ee0e612cULL, 0x00000000990951baULL,
+    0x00000000076dc419ULL, 0x00000000706af48fULL, 0x00000000e963a535ULL, 0x000000009e6495a3ULL,
+    0x000000000edb8832ULL, 0x0000000079dcb8a4ULL, 0x00000000e0d5e91eULL, 0x0000000097d2d988ULL,
+    0x0000000009b64c2bULL, 0x000000007eb17cbdULL, 0x00000000e7b82d07ULL, 0x0000000090bf1d91ULL,
+    0x000000001db71064ULL, 0x000000006ab020f2ULL, 0x00000000f3b97148ULL, 0x0000000084be41deULL,
+    0x000000001adad47dULL, 0x000000006ddde4ebULL, 0x00000000f4d4b551ULL, 0x0000000083d385c7ULL,
+    0x00000000136c9856ULL, 0x00000000646ba8c0ULL, 0x00000000fd62f97aULL, 0x000000008a65c9ecULL,
+    0x0000000014015c4fULL, 0x0000000063066cd9ULL, 0x00000000fa0f3d63ULL, 0x000000008d080df5ULL,
+    0x000000003b6e20c8ULL, 0x000000004c69105eULL, 0x00000000d56041e4ULL, 0x00000000a2677172ULL,
+    0x000000003c03e4d1ULL, 0x000000004b04d447ULL, 0x00000000d20d85fdULL, 0x00000000a50ab56bULL,
+    0x0000000035b5a8faULL, 0x0000000042b2986cULL, 0x00000000dbbbc9d6ULL, 0x00000000acbcf940ULL,
+    0x0000000032d86ce3ULL, 0x0000000045df5c75ULL, 0x00000000dcd60dcfULL, 0x00000000abd13d59ULL,
+    0x0000000026d930acULL, 0x0000000051de003aULL, 0x00000000c8d75180ULL, 0x00000000bfd06116ULL,
+    0x0000000021b4f4b5ULL, 0x0000000056b3c423ULL, 0x00000000cfba9599ULL, 0x00000000b8bda50fULL,
+    0x000000002802b89eULL, 0x000000005f058808ULL, 0x00000000c60cd9b2ULL, 0x00000000b10be924ULL,
+    0x000000002f6f7c87ULL, 0x0000000058684c11ULL, 0x00000000c1611dabULL, 0x00000000b6662d3dULL,
+    0x0000000076dc4190ULL, 0x0000000001db7106ULL, 0x0000000098d220bcULL, 0x00000000efd5102aULL,
+    0x0000000071b18589ULL, 0x0000000006b6b51fULL, 0x000000009fbfe4a5ULL, 0x00000000e8b8d433ULL,
+    0x000000007807c9a2ULL, 0x000000000f00f934ULL, 0x000000009609a88eULL, 0x00000000e10e9818ULL,
+    0x000000007f6a0dbbULL, 0x00000000086d3d2dULL, 0x0000000091646c97ULL, 0x00000000e6635c01ULL,
+    0x000000006b6b51f4ULL, 0x000000001c6c6162ULL, 0x00000000856530d8ULL, 0x00000000f262004eULL,
+    0x000000006c0695edULL, 0x000000001b01a57bULL, 0x000000008208f4c1ULL, 0x00000000f50fc457ULL,
+    0x0000000065b0d9c6ULL, 0x0000000012b7e950ULL, 0x000000008bbeb8eaULL, 0x00000000fcb9887cULL,
+    0x0000000062dd1ddfULL, 0x0000000015da2d49ULL, 0x000000008cd37cf3ULL, 0x00000000fbd44c65ULL,
+    0x000000004db26158ULL, 0x000000003ab551ceULL, 0x00000000a3bc0074ULL, 0x00000000d4bb30e2ULL,
+    0x000000004adfa541ULL, 0x000000003dd895d7ULL, 0x00000000a4d1c46dULL, 0x00000000d3d6f4fbULL,
+    0x000000004369e96aULL, 0x00000000346ed9fcULL, 0x00000000ad678846ULL, 0x00000000da60b8d0ULL,
+    0x0000000044042d73ULL, 0x0000000033031de5ULL, 0x00000000aa0a4c5fULL, 0x00000000dd0d7cc9ULL,
+    0x000000005005713cULL, 0x00000000270241aaULL, 0x00000000be0b1010ULL, 0x00000000c90c2086ULL,
+    0x000000005768b525ULL, 0x00000000206f85b3ULL, 0x00000000b966d409ULL, 0x00000000ce61e49fULL,
+    0x000000005edef90eULL, 0x0000000029d9c998ULL, 0x00000000b0d09822ULL, 0x00000000c7d7a8b4ULL,
+    0x0000000059b33d17ULL, 0x000000002eb40d81ULL, 0x00000000b7bd5c3bULL, 0x00000000c0ba6cadULL,
+    0x00000000edb88320ULL, 0x000000009abfb3b6ULL, 0x0000000003b6e20cULL, 0x0000000074b1d29aULL,
+    0x00000000ead54739ULL, 0x000000009dd277afULL, 0x0000000004db2615ULL, 0x0000000073dc1683ULL,
+    0x00000000e3630b12ULL, 0x0000000094643b84ULL, 0x000000000d6d6a3eULL, 0x000000007a6a5aa8ULL,
+    0x00000000e40ecf0bULL, 0x000000009309ff9dULL, 0x000000000a00ae27ULL, 0x000000007d079eb1ULL,
+    0x00000000f00f9344ULL, 0x000000008708a3d2ULL, 0x000000001e01f268ULL, 0x000000006906c2feULL,
+    0x00000000f762575dULL, 0x00000000806567cbULL, 0x00000000196c3671ULL, 0x000000006e6b06e7ULL,
+    0x00000000fed41b76ULL, 0x0000000089d32be0ULL, 0x0000000010da7a5aULL, 0x0000000067dd4accULL,
+    0x00000000f9b9df6fULL, 0x000000008ebeeff9ULL, 0x0000000017b7be43ULL, 0x0000000060b08ed5ULL,
+    0x00000000d6d6a3e8ULL, 0x00000000a1d1937eULL, 0x0000000038d8c2c4ULL, 0x000000004fdff252ULL,
+    0x00000000d1bb67f1ULL, 0x00000000a6bc5767ULL, 0x000000003fb506ddULL, 0x0000000048b2364bULL,
+    0x00000000d80d2bdaULL, 0x00000000af0a1b4cULL, 0x0000000036034af6ULL, 0x0000000041047a60ULL,
+    0x00000000df60efc3ULL, 0x00000000a867df55ULL, 0x00000000316e8eefULL, 0x000000004669be79ULL,
+    0x00000000cb61b38cULL, 0x00000000bc66831aULL, 0x00000000256fd2a0ULL, 0x000000005268e236ULL,
+    0x00000000cc0c7795ULL, 0x00000000bb0b4703ULL, 0x00000000220216b9ULL, 0x000000005505262fULL,
+    0x00000000c5ba3bbeULL, 0x00000000b2bd0b28ULL, 0x000000002bb45a92ULL, 0x000000005cb36a04ULL,
+    0x00000000c2d7ffa7ULL, 0x00000000b5d0cf31ULL, 0x000000002cd99e8bULL, 0x000000005bdeae1dULL,
+    0x000000009b64c2b0ULL, 0x00000000ec63f226ULL, 0x00000000756aa39cULL, 0x00000000026d930aULL,
+    0x000000009c0906a9ULL, 0x00000000eb0e363fULL, 0x0000000072076785ULL, 0x0000000005005713ULL,
+    0x0000000095bf4a82ULL, 0x00000000e2b87a14ULL, 0x000000007bb12baeULL, 0x000000000cb61b38ULL,
+    0x0000000092d28e9bULL, 0x00000000e5d5be0dULL, 0x000000007cdcefb7ULL, 0x000000000bdbdf21ULL,
+    0x0000000086d3d2d4ULL, 0x00000000f1d4e242ULL, 0x0000000068ddb3f8ULL, 0x000000001fda836eULL,
+    0x0000000081be16cdULL, 0x00000000f6b9265bULL, 0x000000006fb077e1ULL, 0x0000000018b74777ULL,
+    0x0000000088085ae6ULL, 0x00000000ff0f6a70ULL, 0x0000000066063bcaULL, 0x0000000011010b5cULL,
+    0x000000008f659effULL, 0x00000000f862ae69ULL, 0x00000000616bffd3ULL, 0x00000000166ccf45ULL,
+    0x00000000a00ae278ULL, 0x00000000d70dd2eeULL, 0x000000004e048354ULL, 0x000000003903b3c2ULL,
+    0x00000000a7672661ULL, 0x00000000d06016f7ULL, 0x000000004969474dULL, 0x000000003e6e77dbULL,
+    0x00000000aed16a4aULL, 0x00000000d9d65adcULL, 0x0000000040df0b66ULL, 0x0000000037d83bf0ULL,
+    0x00000000a9bcae53ULL, 0x00000000debb9ec5ULL, 0x0000000047b2cf7fULL, 0x0000000030b5ffe9ULL,
+    0x00000000bdbdf21cULL, 0x00000000cabac28aULL, 0x0000000053b39330ULL, 0x0000000024b4a3a6ULL,
+    0x00000000bad03605ULL, 0x00000000cdd70693ULL, 0x0000000054de5729ULL, 0x0000000023d967bfULL,
+    0x00000000b3667a2eULL, 0x00000000c4614ab8ULL, 0x000000005d681b02ULL, 0x000000002a6f2b94ULL,
+    0x00000000b40bbe37ULL, 0x00000000c30c8ea1ULL, 0x000000005a05df1bULL, 0x000000002d02ef8dULL
+};
+
+/* crc-32c */
+static const uint64 crc32c_table[256] = {
+    0x0000000000000000ULL, 0x00000000f26b8303ULL, 0x00000000e13b70f7ULL, 0x000000001350f3f4ULL,
+    0x00000000c79a971fULL, 0x0000000035f1141cULL, 0x0000000026a1e7e8ULL, 0x00000000d4ca64ebULL,
+    0x000000008ad958cfULL, 0x0000000078b2dbccULL, 0x000000006be22838ULL, 0x000000009989ab3bULL,
+    0x000000004d43cfd0ULL, 0x00000000bf284cd3ULL, 0x00000000ac78bf27ULL, 0x000000005e133c24ULL,
+    0x00000000105ec76fULL, 0x00000000e235446cULL, 0x00000000f165b798ULL, 0x00000000030e349bULL,
+    0x00000000d7c45070ULL, 0x0000000025afd373ULL, 0x0000000036ff2087ULL, 0x00000000c494a384ULL,
+    0x000000009a879fa0ULL, 0x0000000068ec1ca3ULL, 0x000000007bbcef57ULL, 0x0000000089d76c54ULL,
+    0x000000005d1d08bfULL, 0x00000000af768bbcULL, 0x00000000bc267848ULL, 0x000000004e4dfb4bULL,
+    0x0000000020bd8edeULL, 0x00000000d2d60dddULL, 0x00000000c186fe29ULL, 0x0000000033ed7d2aULL,
+    0x00000000e72719c1ULL, 0x00000000154c9ac2ULL, 0x00000000061c6936ULL, 0x00000000f477ea35ULL,
+    0x00000000aa64d611ULL, 0x00000000580f5512ULL, 0x000000004b5fa6e6ULL, 0x00000000b93425e5ULL,
+    0x000000006dfe410eULL, 0x000000009f95c20dULL, 0x000000008cc531f9ULL, 0x000000007eaeb2faULL,
+    0x0000000030e349b1ULL, 0x00000000c288cab2ULL, 0x00000000d1d83946ULL, 0x0000000023b3ba45ULL,
+    0x00000000f779deaeULL, 0x0000000005125dadULL, 0x000000001642ae59ULL, 0x00000000e4292d5aULL,
+    0x00000000ba3a117eULL, 0x000000004851927dULL, 0x000000005b016189ULL, 0x00000000a96ae28aULL,
+    0x000000007da08661ULL, 0x000000008fcb0562ULL, 0x000000009c9bf696ULL, 0x000000006ef07595ULL,
+    0x00000000417b1dbcULL, 0x00000000b3109ebfULL, 0x00000000a0406d4bULL, 0x00000000522bee48ULL,
+    0x0000000086e18aa3ULL, 0x00000000748a09a0ULL, 0x0000000067dafa54ULL, 0x0000000095b17957ULL,
+    0x00000000cba24573ULL, 0x0000000039c9c670ULL, 0x000000002a993584ULL, 0x00000000d8f2b687ULL,
+    0x000000000c38d26cULL, 0x00000000fe53516fULL, 0x00000000ed03a29bULL, 0x000000001f682198ULL,
+    0x000000005125dad3ULL, 0x00000000a34e59d0ULL, 0x00000000b01eaa24ULL, 0x0000000042752927ULL,
+    0x0000000096bf4dccULL, 0x0000000064d4cecfULL, 0x0000000077843d3bULL, 0x0000000085efbe38ULL,
+    0x00000000dbfc821cULL, 0x000000002997011fULL, 0x000000003ac7f2ebULL, 0x00000000c8ac71e8ULL,
+    0x000000001c661503ULL, 0x00000000ee0d9600ULL, 0x00000000fd5d65f4ULL, 0x000000000f36e6f7ULL,
+    0x0000000061c69362ULL, 0x0000000093ad1061ULL, 0x0000000080fde395ULL, 0x0000000072966096ULL,
+    0x00000000a65c047dULL, 0x000000005437877eULL, 0x000000004767748aULL, 0x00000000b50cf789ULL,
+    0x00000000eb1fcbadULL, 0x00000000197448aeULL, 0x000000000a24bb5aULL, 0x00000000f84f3859ULL,
+    0x000000002c855cb2ULL, 0x00000000deeedfb1ULL, 0x00000000cdbe2c45ULL, 0x000000003fd5af46ULL,
+    0x000000007198540dULL, 0x0000000083f3d70eULL, 0x0000000090a324faULL, 0x0000000062c8a7f9ULL,
+    0x00000000b602c312ULL, 0x0000000044694011ULL, 0x000000005739b3e5ULL, 0x00000000a55230e6ULL,
+    0x00000000fb410cc2ULL, 0x00000000092a8fc1ULL, 0x000000001a7a7c35ULL, 0x00000000e811ff36ULL,
+    0x000000003cdb9bddULL, 0x00000000ceb018deULL, 0x00000000dde0eb2aULL, 0x000000002f8b6829ULL,
+    0x0000000082f63b78ULL, 0x00000000709db87bULL, 0x0000000063cd4b8fULL, 0x0000000091a6c88cULL,
+    0x00000000456cac67ULL, 0x00000000b7072f64ULL, 0x00000000a457dc90ULL, 0x00000000563c5f93ULL,
+    0x00000000082f63b7ULL, 0x00000000fa44e0b4ULL, 0x00000000e9141340ULL, 0x000000001b7f9043ULL,
+    0x00000000cfb5f4a8ULL, 0x000000003dde77abULL, 0x000000002e8e845fULL, 0x00000000dce5075cULL,
+    0x0000000092a8fc17ULL, 0x0000000060c37f14ULL, 0x0000000073938ce0ULL, 0x0000000081f80fe3ULL,
+    0x0000000055326b08ULL, 0x00000000a759e80bULL, 0x00000000b4091bffULL, 0x00000000466298fcULL,
+    0x000000001871a4d8ULL, 0x00000000ea1a27dbULL, 0x00000000f94ad42fULL, 0x000000000b21572cULL,
+    0x00000000dfeb33c7ULL, 0x000000002d80b0c4ULL, 0x000000003ed04330ULL, 0x00000000ccbbc033ULL,
+    0x00000000a24bb5a6ULL, 0x00000000502036a5ULL, 0x000000004370c551ULL, 0x00000000b11b4652ULL,
+    0x0000000065d122b9ULL, 0x0000000097baa1baULL, 0x0000000084ea524eULL, 0x000000007681d14dULL,
+    0x000000002892ed69ULL, 0x00000000daf96e6aULL, 0x00000000c9a99d9eULL, 0x000000003bc21e9dULL,
+    0x00000000ef087a76ULL, 0x000000001d63f975ULL, 0x000000000e330a81ULL, 0x00000000fc588982ULL,
+    0x00000000b21572c9ULL, 0x00000000407ef1caULL, 0x00000000532e023eULL, 0x00000000a145813dULL,
+    0x00000000758fe5d6ULL, 0x0000000087e466d5ULL, 0x0000000094b49521ULL, 0x0000000066df1622ULL,
+    0x0000000038cc2a06ULL, 0x00000000caa7a905ULL, 0x00000000d9f75af1ULL, 0x000000002b9cd9f2ULL,
+    0x00000000ff56bd19ULL, 0x000000000d3d3e1aULL, 0x000000001e6dcdeeULL, 0x00000000ec064eedULL,
+    0x00000000c38d26c4ULL, 0x0000000031e6a5c7ULL, 0x0000000022b65633ULL, 0x00000000d0ddd530ULL,
+    0x000000000417b1dbULL, 0x00000000f67c32d8ULL, 0x00000000e52cc12cULL, 0x000000001747422fULL,
+    0x0000000049547e0bULL, 0x00000000bb3ffd08ULL, 0x00000000a86f0efcULL, 0x000000005a048dffULL,
+    0x000000008ecee914ULL, 0x000000007ca56a17ULL, 0x000000006ff599e3ULL, 0x000000009d9e1ae0ULL,
+    0x00000000d3d3e1abULL, 0x0000000021b862a8ULL, 0x0000000032e8915cULL, 0x00000000c083125fULL,
+    0x00000000144976b4ULL, 0x00000000e622f5b7ULL, 0x00000000f5720643ULL, 0x0000000007198540ULL,
+    0x00000000590ab964ULL, 0x00000000ab613a67ULL, 0x00000000b831c993ULL, 0x000000004a5a4a90ULL,
+    0x000000009e902e7bULL, 0x000000006cfbad78ULL, 0x000000007fab5e8cULL, 0x000000008dc0dd8fULL,
+    0x00000000e330a81aULL, 0x00000000115b2b19ULL, 0x00000000020bd8edULL, 0x00000000f0605beeULL,
+    0x0000000024aa3f05ULL, 0x00000000d6c1bc06ULL, 0x00000000c5914ff2ULL, 0x0000000037faccf1ULL,
+    0x0000000069e9f0d5ULL, 0x000000009b8273d6ULL, 0x0000000088d28022ULL, 0x000000007ab90321ULL,
+    0x00000000ae7367caULL, 0x000000005c18e4c9ULL, 0x000000004f48173dULL, 0x00000000bd23943eULL,
+    0x00000000f36e6f75ULL, 0x000000000105ec76ULL, 0x0000000012551f82ULL, 0x00000000e03e9c81ULL,
+    0x0000000034f4f86aULL, 0x00000000c69f7b69ULL, 0x00000000d5cf889dULL, 0x0000000027a40b9eULL,
+    0x0000000079b737baULL, 0x000000008bdcb4b9ULL, 0x00000000988c474dULL, 0x000000006ae7c44eULL,
+    0x00000000be2da0a5ULL, 0x000000004c4623a6ULL, 0x000000005f16d052ULL, 0x00000000ad7d5351ULL
+};
+
+/* crc-64/xz */
+static const uint64 crc64_xz_table[256] = {
+    0x0000000000000000ULL, 0xb32e4cbe03a75f6fULL, 0xf4843657a840a05bULL, 0x47aa7ae9abe7ff34ULL,
+    0x7bd0c384ff8f5e33ULL, 0xc8fe8f3afc28015cULL, 0x8f54f5d357cffe68ULL, 0x3c7ab96d5468a107ULL,
+    0xf7a18709ff1ebc66ULL, 0x448fcbb7fcb9e309ULL, 0x0325b15e575e1c3dULL, 0xb00bfde054f94352ULL,
+    0x8c71448d0091e255ULL, 0x3f5f08330336bd3aULL, 0x78f572daa8d1420eULL, 0xcbdb3e64ab761d61ULL,
+    0x7d9ba13851336649ULL, 0xceb5ed8652943926ULL, 0x891f976ff973c612ULL, 0x3a31dbd1fad4997dULL,
+    0x064b62bcaebc387aULL, 0xb5652e02ad1b6715ULL, 0xf2cf54eb06fc9821ULL, 0x41e11855055bc74eULL,
+    0x8a3a2631ae2dda2fULL, 0x39146a8fad8a8540ULL, 0x7ebe1066066d7a74ULL, 0xcd905cd805ca251bULL,
+    0xf1eae5b551a2841cULL, 0x42c4a90b5205db73ULL, 0x056ed3e2f9e22447ULL, 0xb6409f5cfa457b28ULL,
+    0xfb374270a266cc92ULL, 0x48190ecea1c193fdULL, 0x0fb374270a266cc9ULL, 0xbc9d3899098133a6ULL,
+    0x80e781f45de992a1ULL, 0x33c9cd4a5e4ecdceULL, 0x7463b7a3f5a932faULL, 0xc74dfb1df60e6d95ULL,
+    0x0c96c5795d7870f4ULL, 0xbfb889c75edf2f9bULL, 0xf812f32ef538d0afULL, 0x4b3cbf90f69f8fc0ULL,
+    0x774606fda2f72ec7ULL, 0xc4684a43a15071a8ULL, 0x83c230aa0ab78e9cULL, 0x30ec7c140910d1f3ULL,
+    0x86ace348f355aadbULL, 0x3582aff6f0f2f5b4ULL, 0x7228d51f5b150a80ULL, 0xc10699a158b255efULL,
+    0xfd7c20cc0cdaf4e8ULL, 0x4e526c720f7dab87ULL, 0x09f8169ba49a54b3ULL, 0xbad65a25a73d0bdcULL,
+    0x710d64410c4b16bdULL, 0xc22328ff0fec49d2ULL, 0x85895216a40bb6e6ULL, 0x36a71ea8a7ace989ULL,
+    0x0adda7c5f3c4488eULL, 0xb9f3eb7bf06317e1ULL, 0xfe5991925b84e8d5ULL, 0x4d77dd2c5823b7baULL,
+    0x64b62bcaebc387a1ULL, 0xd7986774e864d8ceULL, 0x90321d9d438327faULL, 0x231c512340247895ULL,
+    0x1f66e84e144cd992ULL, 0xac48a4f017eb86fdULL, 0xebe2de19bc0c79c9ULL, 0x58cc92a7bfab26a6ULL,
+    0x9317acc314dd3bc7ULL, 0x2039e07d177a64a8ULL, 0x67939a94bc9d9b9cULL, 0xd4bdd62abf3ac4f3ULL,
+    0xe8c76f47eb5265f4ULL, 0x5be923f9e8f53a9bULL, 0x1c4359104312c5afULL, 0xaf6d15ae40b59ac0ULL,
+    0x192d8af2baf0e1e8ULL, 0xaa03c64cb957be87ULL, 0xeda9bca512b041b3ULL, 0x5e87f01b11171edcULL,
+    0x62fd4976457fbfdbULL, 0xd1d305c846d8e0b4ULL, 0x96797f21ed3f1f80ULL, 0x2557339fee9840efULL,
+    0xee8c0dfb45ee5d8eULL, 0x5da24145464902e1ULL, 0x1a083bacedaefdd5ULL, 0xa9267712ee09a2baULL,
+    0x955cce7fba6103bdULL, 0x267282c1b9c65cd2ULL, 0x61d8f8281221a3e6ULL, 0xd2f6b4961186fc89ULL,
+    0x9f8169ba49a54b33ULL, 0x2caf25044a02145cULL, 0x6b055fede1e5eb68ULL, 0xd82b1353e242b407ULL,
+    0xe451aa3eb62a1500ULL, 0x577fe680b58d4a6fULL, 0x10d59c691e6ab55bULL, 0xa3fbd0d71dcdea34ULL,
+    0x6820eeb3b6bbf755ULL, 0xdb0ea20db51ca83aULL, 0x9ca4d8e41efb570eULL, 0x2f8a945a1d5c0861ULL,
+    0x13f02d374934a966ULL, 0xa0de61894a93f609ULL, 0xe7741b60e174093dULL, 0x545a57dee2d35652ULL,
+    0xe21ac88218962d7aULL, 0x5134843c1b317215ULL, 0x169efed5b0d68d21ULL, 0xa5b0b26bb371d24eULL,
+    0x99ca0b06e7197349ULL, 0x2ae447b8e4be2c26ULL, 0x6d4e3d514f59d312ULL, 0xde6071ef4cfe8c7dULL,
+    0x15bb4f8be788911cULL, 0xa6950335e42fce73ULL, 0xe13f79dc4fc83147ULL, 0x521135624c6f6e28ULL,
+    0x6e6b8c0f1807cf2fULL, 0xdd45c0b11ba09040ULL, 0x9aefba58b0476f74ULL, 0x29c1f6e6b3e0301bULL,
+    0xc96c5795d7870f42ULL, 0x7a421b2bd420502dULL, 0x3de861c27fc7af19ULL, 0x8ec62d7c7c60f076ULL,
+    0xb2bc941128085171ULL, 0x0192d8af2baf0e1eULL, 0x4638a2468048f12aULL, 0xf516eef883efae45ULL,
+    0x3ecdd09c2899b324ULL, 0x8de39c222b3eec4bULL, 0xca49e6cb80d9137fULL, 0x7967aa75837e4c10ULL,
+    0x451d1318d716ed17ULL, 0xf6335fa6d4b1b278ULL, 0xb199254f7f564d4cULL, 0x02b769f17cf11223ULL,
+    0xb4f7f6ad86b4690bULL, 0x07d9ba1385133664ULL, 0x4073c0fa2ef4c950ULL, 0xf35d8c442d53963fULL,
+    0xcf273529793b3738ULL, 0x7c0979977a9c6857ULL, 0x3ba3037ed17b9763ULL, 0x888d4fc0d2dcc80cULL,
+    0x435671a479aad56dULL, 0xf0783d1a7a0d8a02ULL, 0xb7d247f3d1ea7536ULL, 0x04fc0b4dd24d2a59ULL,
+    0x3886b22086258b5eULL, 0x8ba8fe9e8582d431ULL, 0xcc0284772e652b05ULL, 0x7f2cc8c92dc2746aULL,
+    0x325b15e575e1c3d0ULL, 0x8175595b76469cbfULL, 0xc6df23b2dda1638bULL, 0x75f16f0cde063ce4ULL,
+    0x498bd6618a6e9de3ULL, 0xfaa59adf89c9c28cULL, 0xbd0fe036222e3db8ULL, 0x0e21ac88218962d7ULL,
+    0xc5fa92ec8aff7fb6ULL, 0x76d4de52895820d9ULL, 0x317ea4bb22bfdfedULL, 0x8250e80521188082ULL,
+    0xbe2a516875702185ULL, 0x0d041dd676d77eeaULL, 0x4aae673fdd3081deULL, 0xf9802b81de97deb1ULL,
+    0x4fc0b4dd24d2a599ULL, 0xfceef8632775faf6ULL, 0xbb44828a8c9205c2ULL, 0x086ace348f355aadULL,
+    0x34107759db5dfbaaULL, 0x873e3be7d8faa4c5ULL, 0xc094410e731d5bf1ULL, 0x73ba0db070ba049eULL,
+    0xb86133d4dbcc19ffULL, 0x0b4f7f6ad86b4690ULL, 0x4ce50583738cb9a4ULL, 0xffcb493d702be6cbULL,
+    0xc3b1f050244347ccULL, 0x709fbcee27e418a3ULL, 0x3735c6078c03e797ULL, 0x841b8ab98fa4b8f8ULL,
+    0xadda7c5f3c4488e3ULL, 0x1ef430e13fe3d78cULL, 0x595e4a08940428b8ULL, 0xea7006b697a377d7ULL,
+    0xd60abfdbc3cbd6d0ULL, 0x6524f365c06c89bfULL, 0x228e898c6b8b768bULL, 0x91a0c532682c29e4ULL,
+    0x5a7bfb56c35a3485ULL, 0xe955b7e8c0fd6beaULL, 0xaeffcd016b1a94deULL, 0x1dd181bf68bdcbb1ULL,
+    0x21ab38d23cd56ab6ULL, 0x9285746c3f7235d9ULL, 0xd52f0e859495caedULL, 0x6601423b97329582ULL,
+    0xd041dd676d77eeaaULL, 0x636f91d96ed0b1c5ULL, 0x24c5eb30c5374ef1ULL, 0x97eba78ec690119eULL,
+    0xab911ee392f8b099ULL, 0x18bf525d915feff6ULL, 0x5f1528b43ab810c2ULL, 0xec3b640a391f4fadULL,
+    0x27e05a6e926952ccULL, 0x94ce16d091ce0da3ULL, 0xd3646c393a29f297ULL, 0x604a2087398eadf8ULL,
+    0x5c3099ea6de60cffULL, 0xef1ed5546e415390ULL, 0xa8b4afbdc5a6aca4ULL, 0x1b9ae303c601f3cbULL,
+    0x56ed3e2f9e224471ULL, 0xe5c372919d851b1eULL, 0xa26908783662e42aULL, 0x114744c635c5bb45ULL,
+    0x2d3dfdab61ad1a42ULL, 0x9e13b115620a452dULL, 0xd9b9cbfcc9edba19ULL, 0x6a978742ca4ae576ULL,
+    0xa14cb926613cf817ULL, 0x1262f598629ba778ULL, 0x55c88f71c97c584cULL, 0xe6e6c3cfcadb0723ULL,
+    0xda9c7aa29eb3a624ULL, 0x69b2361c9d14f94bULL, 0x2e184cf536f3067fULL, 0x9d36004b35545910ULL,
+    0x2b769f17cf112238ULL, 0x9858d3a9ccb67d57ULL, 0xdff2a94067518263ULL, 0x6cdce5fe64f6dd0cULL,
+    0x50a65c93309e7c0bULL, 0xe388102d33392364ULL, 0xa4226ac498dedc50ULL, 0x170c267a9b79833fULL,
+    0xdcd7181e300f9e5eULL, 0x6ff954a033a8c131ULL, 0x28532e49984f3e05ULL, 0x9b7d62f79be8616aULL,
+    0xa707db9acf80c06dULL, 0x14299724cc279f02ULL, 0x5383edcd67c06036ULL, 0xe0ada17364673f59ULL
+};
+
+/* crc-64/ecma-182 */
+static const uint64 crc64_ecma_table[256] = {
+    0x0000000000000000ULL, 0x42f0e1eba9ea3693ULL, 0x85e1c3d753d46d26ULL, 0xc711223cfa3e5bb5ULL,
+    0x493366450e42ecdfULL, 0x0bc387aea7a8da4cULL, 0xccd2a5925d9681f9ULL, 0x8e224479f47cb76aULL,
+    0x9266cc8a1c85d9beULL, 0xd0962d61b56fef2dULL, 0x17870f5d4f51b498ULL, 0x5577eeb6e6bb820bULL,
+    0xdb55aacf12c73561ULL, 0x99a54b24bb2d03f2ULL, 0x5eb4691841135847ULL, 0x1c4488f3e8f96ed4ULL,
+    0x663d78ff90e185efULL, 0x24cd9914390bb37cULL, 0xe3dcbb28c335e8c9ULL, 0xa12c5ac36adfde5aULL,
+    0x2f0e1eba9ea36930ULL, 0x6dfeff5137495fa3ULL, 0xaaefdd6dcd770416ULL, 0xe81f3c86649d3285ULL,
+    0xf45bb4758c645c51ULL, 0xb6ab559e258e6ac2ULL, 0x71ba77a2dfb03177ULL, 0x334a9649765a07e4ULL,
+    0xbd68d2308226b08eULL, 0xff9833db2bcc861dULL, 0x388911e7d1f2dda8ULL, 0x7a79f00c7818eb3bULL,
+    0xcc7af1ff21c30bdeULL, 0x8e8a101488293d4dULL, 0x499b3228721766f8ULL, 0x0b6bd3c3dbfd506bULL,
+    0x854997ba2f81e701ULL, 0xc7b97651866bd192ULL, 0x00a8546d7c558a27ULL, 0x4258b586d5bfbcb4ULL,
+    0x5e1c3d753d46d260ULL, 0x1cecdc9e94ace4f3ULL, 0xdbfdfea26e92bf46ULL, 0x990d1f49c77889d5ULL,
+    0x172f5b3033043ebfULL, 0x55dfbadb9aee082cULL, 0x92ce98e760d05399ULL, 0xd03e790cc93a650aULL,
+    0xaa478900b1228e31ULL, 0xe8b768eb18c8b8a2ULL, 0x2fa64ad7e2f6e317ULL, 0x6d56ab3c4b1cd584ULL,
+    0xe374ef45bf6062eeULL, 0xa1840eae168a547dULL, 0x66952c92ecb40fc8ULL, 0x2465cd79455e395bULL,
+    0x3821458aada7578fULL, 0x7ad1a461044d611cULL, 0xbdc0865dfe733aa9ULL, 0xff3067b657990c3aULL,
+    0x711223cfa3e5bb50ULL, 0x33e2c2240a0f8dc3ULL, 0xf4f3e018f031d676ULL, 0xb60301f359dbe0e5ULL,
+    0xda050215ea6c212fULL, 0x98f5e3fe438617bcULL, 0x5fe4c1c2b9b84c09ULL, 0x1d14202910527a9aULL,
+    0x93366450e42ecdf0ULL, 0xd1c685bb4dc4fb63ULL, 0x16d7a787b7faa0d6ULL, 0x5427466c1e109645ULL,
+    0x4863ce9ff6e9f891ULL, 0x0a932f745f03ce02ULL, 0xcd820d48a53d95b7ULL, 0x8f72eca30cd7a324ULL,
+    0x0150a8daf8ab144eULL, 0x43a04931514122ddULL, 0x84b16b0dab7f7968ULL, 0xc6418ae602954ffbULL,
+    0xbc387aea7a8da4c0ULL, 0xfec89b01d3679253ULL, 0x39d9b93d2959c9e6ULL, 0x7b2958d680b3ff75ULL,
+    0xf50b1caf74cf481fULL, 0xb7fbfd44dd257e8cULL, 0x70eadf78271b2539ULL, 0x321a3e938ef113aaULL,
+    0x2e5eb66066087d7eULL, 0x6cae578bcfe24bedULL, 0xabbf75b735dc1058ULL, 0xe94f945c9c3626cbULL,
+    0x676dd025684a91a1ULL, 0x259d31cec1a0a732ULL, 0xe28c13f23b9efc87ULL, 0xa07cf2199274ca14ULL,
+    0x167ff3eacbaf2af1ULL, 0x548f120162451c62ULL, 0x939e303d987b47d7ULL, 0xd16ed1d631917144ULL,
+    0x5f4c95afc5edc62eULL, 0x1dbc74446c07f0bdULL, 0xdaad56789639ab08ULL, 0x985db7933fd39d9bULL,
+    0x84193f60d72af34fULL, 0xc6e9de8b7ec0c5dcULL, 0x01f8fcb784fe9e69ULL, 0x43081d5c2d14a8faULL,
+    0xcd2a5925d9681f90ULL, 0x8fdab8ce70822903ULL, 0x48cb9af28abc72b6ULL, 0x0a3b7b1923564425ULL,
+    0x70428b155b4eaf1eULL, 0x32b26afef2a4998dULL, 0xf5a348c2089ac238ULL, 0xb753a929a170f4abULL,
+    0x3971ed50550c43c1ULL, 0x7b810cbbfce67552ULL, 0xbc902e8706d82ee7ULL, 0xfe60cf6caf321874ULL,
+    0xe224479f47cb76a0ULL, 0xa0d4a674ee214033ULL, 0x67c58448141f1b86ULL, 0x253565a3bdf52d15ULL,
+    0xab1721da49899a7fULL, 0xe9e7c031e063acecULL, 0x2ef6e20d1a5df759ULL, 0x6c0603e6b3b7c1caULL,
+    0xf6fae5c07d3274cdULL, 0xb40a042bd4d8425eULL, 0x731b26172ee619ebULL, 0x31ebc7fc870c2f78ULL,
+    0xbfc9838573709812ULL, 0xfd39626eda9aae81ULL, 0x3a28405220a4f534ULL, 0x78d8a1b9894ec3a7ULL,
+    0x649c294a61b7ad73ULL, 0x266cc8a1c85d9be0ULL, 0xe17dea9d3263c055ULL, 0xa38d0b769b89f6c6ULL,
+    0x2daf4f0f6ff541acULL, 0x6f5faee4c61f773fULL, 0xa84e8cd83c212c8aULL, 0xeabe6d3395cb1a19ULL,
+    0x90c79d3fedd3f122ULL, 0xd2377cd44439c7b1ULL, 0x15265ee8be079c04ULL, 0x57d6bf0317edaa97ULL,
+    0xd9f4fb7ae3911dfdULL, 0x9b041a914a7b2b6eULL, 0x5c1538adb04570dbULL, 0x1ee5d94619af4648ULL,
+    0x02a151b5f156289cULL, 0x4051b05e58bc1e0fULL, 0x87409262a28245baULL, 0xc5b073890b687329ULL,
+    0x4b9237f0ff14c443ULL, 0x0962d61b56fef2d0ULL, 0xce73f427acc0a965ULL, 0x8c8315cc052a9ff6ULL,
+    0x3a80143f5cf17f13ULL, 0x7870f5d4f51b4980ULL, 0xbf61d7e80f251235ULL, 0xfd913603a6cf24a6ULL,
+    0x73b3727a52b393ccULL, 0x31439391fb59a55fULL, 0xf652b1ad0167feeaULL, 0xb4a25046a88dc879ULL,
+    0xa8e6d8b54074a6adULL, 0xea16395ee99e903eULL, 0x2d071b6213a0cb8bULL, 0x6ff7fa89ba4afd18ULL,
+    0xe1d5bef04e364a72ULL, 0xa3255f1be7dc7ce1ULL, 0x64347d271de22754ULL, 0x26c49cccb40811c7ULL,
+    0x5cbd6cc0cc10fafcULL, 0x1e4d8d2b65facc6fULL, 0xd95caf179fc497daULL, 0x9bac4efc362ea149ULL,
+    0x158e0a85c2521623ULL, 0x577eeb6e6bb820b0ULL, 0x906fc95291867b05ULL, 0xd29f28b9386c4d96ULL,
+    0xcedba04ad0952342ULL, 0x8c2b41a1797f15d1ULL, 0x4b3a639d83414e64ULL, 0x09ca82762aab78f7ULL,
+    0x87e8c60fded7cf9dULL, 0xc51827e4773df90eULL, 0x020905d88d03a2bbULL, 0x40f9e43324e99428ULL,
+    0x2cffe7d5975e55e2ULL, 0x6e0f063e3eb46371ULL, 0xa91e2402c48a38c4ULL, 0xebeec5e96d600e57ULL,
+    0x65cc8190991cb93dULL, 0x273c607b30f68faeULL, 0xe02d4247cac8d41bULL, 0xa2dda3ac6322e288ULL,
+    0xbe992b5f8bdb8c5cULL, 0xfc69cab42231bacfULL, 0x3b78e888d80fe17aULL, 0x7988096371e5d7e9ULL,
+    0xf7aa4d1a85996083ULL, 0xb55aacf12c735610ULL, 0x724b8ecdd64d0da5ULL, 0x30bb6f267fa73b36ULL,
+    0x4ac29f2a07bfd00dULL, 0x08327ec1ae55e69eULL, 0xcf235cfd546bbd2bULL, 0x8dd3bd16fd818bb8ULL,
+    0x03f1f96f09fd3cd2ULL, 0x41011884a0170a41ULL, 0x86103ab85a2951f4ULL, 0xc4e0db53f3c36767ULL,
+    0xd8a453a01b3a09b3ULL, 0x9a54b24bb2d03f20ULL, 0x5d45907748ee6495ULL, 0x1fb5719ce1045206ULL,
+    0x919735e51578e56cULL, 0xd367d40ebc92d3ffULL, 0x1476f63246ac884aULL, 0x568617d9ef46bed9ULL,
+    0xe085162ab69d5e3cULL, 0xa275f7c11f7768afULL, 0x6564d5fde549331aULL, 0x279434164ca30589ULL,
+    0xa9b6706fb8dfb2e3ULL, 0xeb46918411358470ULL, 0x2c57b3b8eb0bdfc5ULL, 0x6ea7525342e1e956ULL,
+    0x72e3daa0aa188782ULL, 0x30133b4b03f2b111ULL, 0xf7021977f9cceaa4ULL, 0xb5f2f89c5026dc37ULL,
+    0x3bd0bce5a45a6b5dULL, 0x79205d0e0db05dceULL, 0xbe317f32f78e067bULL, 0xfcc19ed95e6430e8ULL,
+    0x86b86ed5267cdbd3ULL, 0xc4488f3e8f96ed40ULL, 0x0359ad0275a8b6f5ULL, 0x41a94ce9dc428066ULL,
+    0xcf8b0890283e370cULL, 0x8d7be97b81d4019fULL, 0x4a6acb477bea5a2aULL, 0x089a2aacd2006cb9ULL,
+    0x14dea25f3af9026dULL, 0x562e43b4931334feULL, 0x913f6188692d6f4bULL, 0xd3cf8063c0c759d8ULL,
+    0x5dedc41a34bbeeb2ULL, 0x1f1d25f19d51d821ULL, 0xd80c07cd676f8394ULL, 0x9afce626ce85b507ULL
+};
+
+/* crc-64/we */
+static const uint64 crc64_we_table[256] = {
+    0x0000000000000000ULL, 0x42f0e1eba9ea3693ULL, 0x85e1c3d753d46d26ULL, 0xc711223cfa3e5bb5ULL,
+    0x493366450e42ecdfULL, 0x0bc387aea7a8da4cULL, 0xccd2a5925d9681f9ULL, 0x8e224479f47cb76aULL,
+    0x9266cc8a1c85d9beULL, 0xd0962d61b56fef2dULL, 0x17870f5d4f51b498ULL, 0x5577eeb6e6bb820bULL,
+    0xdb55aacf12c73561ULL, 0x99a54b24bb2d03f2ULL, 0x5eb4691841135847ULL, 0x1c4488f3e8f96ed4ULL,
+    0x663d78ff90e185efULL, 0x24cd9914390bb37cULL, 0xe3dcbb28c335e8c9ULL, 0xa12c5ac36adfde5aULL,
+    0x2f0e1eba9ea36930ULL, 0x6dfeff5137495fa3ULL, 0xaaefdd6dcd770416ULL, 0xe81f3c86649d3285ULL,
+    0xf45bb4758c645c51ULL, 0xb6ab559e258e6ac2ULL, 0x71ba77a2dfb03177ULL, 0x334a9649765a07e4ULL,
+    0xbd68d2308226b08eULL, 0xff9833db2bcc861dULL, 0x388911e7d1f2dda8ULL, 0x7a79f00c7818eb3bULL,
+    0xcc7af1ff21c30bdeULL, 0x8e8a101488293d4dULL, 0x499b3228721766f8ULL, 0x0b6bd3c3dbfd506bULL,
+    0x854997ba2f81e701ULL, 0xc7b97651866bd192ULL, 0x00a8546d7c558a27ULL, 0x4258b586d5bfbcb4ULL,
+    0x5e1c3d753d46d260ULL, 0x1cecdc9e94ace4f3ULL, 0xdbfdfea26e92bf46ULL, 0x990d1f49c77889d5ULL,
+    0x172f5b3033043ebfULL, 0x55dfbadb9aee082cULL, 0x92ce98e760d05399ULL, 0xd03e790cc93a650aULL,
+    0xaa478900b1228e31ULL, 0xe8b768eb18c8b8a2ULL, 0x2fa64ad7e2f6e317ULL, 0x6d56ab3c4b1cd584ULL,
+    0xe374ef45bf6062eeULL, 0xa1840eae168a547dULL, 0x66952c92ecb40fc8ULL, 0x2465cd79455e395bULL,
+    0x3821458aada7578fULL, 0x7ad1a461044d611cULL, 0xbdc0865dfe733aa9ULL, 0xff3067b657990c3aULL,
+    0x711223cfa3e5bb50ULL, 0x33e2c2240a0f8dc3ULL, 0xf4f3e018f031d676ULL, 0xb60301f359dbe0e5ULL,
+    0xda050215ea6c212fULL, 0x98f5e3fe438617bcULL, 0x5fe4c1c2b9b84c09ULL, 0x1d14202910527a9aULL,
+    0x93366450e42ecdf0ULL, 0xd1c685bb4dc4fb63ULL, 0x16d7a787b7faa0d6ULL, 0x5427466c1e109645ULL,
+    0x4863ce9ff6e9f891ULL, 0x0a932f745f03ce02ULL, 0xcd820d48a53d95b7ULL, 0x8f72eca30cd7a324ULL,
+    0x0150a8daf8ab144eULL, 0x43a04931514122ddULL, 0x84b16b0dab7f7968ULL, 0xc6418ae602954ffbULL,
+    0xbc387aea7a8da4c0ULL, 0xfec89b01d3679253ULL, 0x39d9b93d2959c9e6ULL, 0x7b2958d680b3ff75ULL,
+    0xf50b1caf74cf481fULL, 0xb7fbfd44dd257e8cULL, 0x70eadf78271b2539ULL, 0x321a3e938ef113aaULL,
+    0x2e5eb66066087d7eULL, 0x6cae578bcfe24bedULL, 0xabbf75b735dc1058ULL, 0xe94f945c9c3626cbULL,
+    0x676dd025684a91a1ULL, 0x259d31cec1a0a732ULL, 0xe28c13f23b9efc87ULL, 0xa07cf2199274ca14ULL,
+    0x167ff3eacbaf2af1ULL, 0x548f120162451c62ULL, 0x939e303d987b47d7ULL, 0xd16ed1d631917144ULL,
+    0x5f4c95afc5edc62eULL, 0x1dbc74446c07f0bdULL, 0xdaad56789639ab08ULL, 0x985db7933fd39d9bULL,
+    0x84193f60d72af34fULL, 0xc6e9de8b7ec0c5dcULL, 0x01f8fcb784fe9e69ULL, 0x43081d5c2d14a8faULL,
+    0xcd2a5925d9681f90ULL, 0x8fdab8ce70822903ULL, 0x48cb9af28abc72b6ULL, 0x0a3b7b1923564425ULL,
+    0x70428b155b4eaf1eULL, 0x32b26afef2a4998dULL, 0xf5a348c2089ac238ULL, 0xb753a929a170f4abULL,
+    0x3971ed50550c43c1ULL, 0x7b810cbbfce67552ULL, 0xbc902e8706d82ee7ULL, 0xfe60cf6caf321874ULL,
+    0xe224479f47cb76a0ULL, 0xa0d4a674ee214033ULL, 0x67c58448141f1b86ULL, 0x253565a3bdf52d15ULL,
+    0xab1721da49899a7fULL, 0xe9e7c031e063acecULL, 0x2ef6e20d1a5df759ULL, 0x6c0603e6b3b7c1caULL,
+    0xf6fae5c07d3274cdULL, 0xb40a042bd4d8425eULL, 0x731b26172ee619ebULL, 0x31ebc7fc870c2f78ULL,
+    0xbfc9838573709812ULL, 0xfd39626eda9aae81ULL, 0x3a28405220a4f534ULL, 0x78d8a1b9894ec3a7ULL,
+    0x649c294a61b7ad73ULL, 0x266cc8a1c85d9be0ULL, 0xe17dea9d3263c055ULL, 0xa38d0b769b89f6c6ULL,
+    0x2daf4f0f6ff541acULL, 0x6f5faee4c61f773fULL, 0xa84e8cd83c212c8aULL, 0xeabe6d3395cb1a19ULL,
+    0x90c79d3fedd3f122ULL, 0xd2377cd44439c7b1ULL, 0x15265ee8be079c04ULL, 0x57d6bf0317edaa97ULL,
+    0xd9f4fb7ae3911dfdULL, 0x9b041a914a7b2b6eULL, 0x5c1538adb04570dbULL, 0x1ee5d94619af4648ULL,
+    0x02a151b5f156289cULL, 0x4051b05e58bc1e0fULL, 0x87409262a28245baULL, 0xc5b073890b687329ULL,
+    0x4b9237f0ff14c443ULL, 0x0962d61b56fef2d0ULL, 0xce73f427acc0a965ULL, 0x8c8315cc052a9ff6ULL,
+    0x3a80143f5cf17f13ULL, 0x7870f5d4f51b4980ULL, 0xbf61d7e80f251235ULL, 0xfd913603a6cf24a6ULL,
+    0x73b3727a52b393ccULL, 0x31439391fb59a55fULL, 0xf652b1ad0167feeaULL, 0xb4a25046a88dc879ULL,
+    0xa8e6d8b54074a6adULL, 0xea16395ee99e903eULL, 0x2d071b6213a0cb8bULL, 0x6ff7fa89ba4afd18ULL,
+    0xe1d5bef04e364a72ULL, 0xa3255f1be7dc7ce1ULL, 0x64347d271de22754ULL, 0x26c49cccb40811c7ULL,
+    0x5cbd6cc0cc10fafcULL, 0x1e4d8d2b65facc6fULL, 0xd95caf179fc497daULL, 0x9bac4efc362ea149ULL,
+    0x158e0a85c2521623ULL, 0x577eeb6e6bb820b0ULL, 0x906fc95291867b05ULL, 0xd29f28b9386c4d96ULL,
+    0xcedba04ad0952342ULL, 0x8c2b41a1797f15d1ULL, 0x4b3a639d83414e64ULL, 0x09ca82762aab78f7ULL,
+    0x87e8c60fded7cf9dULL, 0xc51827e4773df90eULL, 0x020905d88d03a2bbULL, 0x40f9e43324e99428ULL,
+    0x2cffe7d5975e55e2ULL, 0x6e0f063e3eb46371ULL, 0xa91e2402c48a38c4ULL, 0xebeec5e96d600e57ULL,
+    0x65cc8190991cb93dULL, 0x273c607b30f68faeULL, 0xe02d4247cac8d41bULL, 0xa2dda3ac6322e288ULL,
+    0xbe992b5f8bdb8c5cULL, 0xfc69cab42231bacfULL, 0x3b78e888d80fe17aULL, 0x7988096371e5d7e9ULL,
+    0xf7aa4d1a85996083ULL, 0xb55aacf12c735610ULL, 0x724b8ecdd64d0da5ULL, 0x30bb6f267fa73b36ULL,
+    0x4ac29f2a07bfd00dULL, 0x08327ec1ae55e69eULL, 0xcf235cfd546bbd2bULL, 0x8dd3bd16fd818bb8ULL,
+    0x03f1f96f09fd3cd2ULL, 0x41011884a0170a41ULL, 0x86103ab85a2951f4ULL, 0xc4e0db53f3c36767ULL,
+    0xd8a453a01b3a09b3ULL, 0x9a54b24bb2d03f20ULL, 0x5d45907748ee6495ULL, 0x1fb5719ce1045206ULL,
+    0x919735e51578e56cULL, 0xd367d40ebc92d3ffULL, 0x1476f63246ac884aULL, 0x568617d9ef46bed9ULL,
+    0xe085162ab69d5e3cULL, 0xa275f7c11f7768afULL, 0x6564d5fde549331aULL, 0x279434164ca30589ULL,
+    0xa9b6706fb8dfb2e3ULL, 0xeb46918411358470ULL, 0x2c57b3b8eb0bdfc5ULL, 0x6ea7525342e1e956ULL,
+    0x72e3daa0aa188782ULL, 0x30133b4b03f2b111ULL, 0xf7021977f9cceaa4ULL, 0xb5f2f89c5026dc37ULL,
+    0x3bd0bce5a45a6b5dULL, 0x79205d0e0db05dceULL, 0xbe317f32f78e067bULL, 0xfcc19ed95e6430e8ULL,
+    0x86b86ed5267cdbd3ULL, 0xc4488f3e8f96ed40ULL, 0x0359ad0275a8b6f5ULL, 0x41a94ce9dc428066ULL,
+    0xcf8b0890283e370cULL, 0x8d7be97b81d4019fULL, 0x4a6acb477bea5a2aULL, 0x089a2aacd2006cb9ULL,
+    0x14dea25f3af9026dULL, 0x562e43b4931334feULL, 0x913f6188692d6f4bULL, 0xd3cf8063c0c759d8ULL,
+    0x5dedc41a34bbeeb2ULL, 0x1f1d25f19d51d821ULL, 0xd80c07cd676f8394ULL, 0x9afce626ce85b507ULL
+};
+
+#endif
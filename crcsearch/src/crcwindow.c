@@ -0,0 +1,174 @@
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#include "crcmodel.h"
+#include "crcwindow.h"
+#include "crcset.h"
+#include "crcstream.h"
+
+/* parse comma separated window lengths, returns number parsed or -1 */
+int CRCWindow_parse (const char *arg, uint64 *lengths, int max) {
+    const char *p = arg;
+    char *end = NULL;
+    int n = 0;
+    uint64 len = 0ULL;
+
+    while (*p) {
+        errno = 0;
+        len = strtoull (p, &end, 0);
+        if (end == p || errno || !len) {
+            fprintf (stderr, "ERROR: invalid window length: %s\n", p);
+            return -1;
+        }
+        if (n == max) {
+            fprintf (stderr, "ERROR: too many window lengths, max %d\n", max);
+            return -1;
+        }
+        lengths[n++] = len;
+        p = (*end == ',') ? end + 1 : end;
+        if (*end && *end != ',') {
+            fprintf (stderr, "ERROR: invalid window length: %s\n", end);
+            return -1;
+        }
+    }
+
+    return n;
+}
+
+static void CRCWindow_init (CRCSearch *cs, CRCWindow *w, uint64 length) {
+    int b = 0, k = 0;
+
+    w->length = length;
+    w->crc = 0ULL;
+    w->bias = CRCSearch_zeros (cs, CRCModel_start (cs->model), length);
+
+    /* the CRC is linear so only the 8 single bit bytes need shifting
+     * through length zero bytes, the rest are xor combinations */
+    w->out[0] = 0ULL;
+    for (k = 0; k < NUMBITS; k++) {
+        w->out[1 << k] = CRCSearch_zeros (cs, cs->table[1 << k], length);
+    }
+    for (b = 1; b < TABSIZE; b++) {
+        w->out[b] = w->out[b & (b - 1)] ^ w->out[b & -b];
+    }
+}
+
+/* advance every window over buf */
+static inline __attribute__((always_inline))
+void CRCWindow_scan (CRCSearch *this, CRCWindow *windows, int nlengths, byte *history, uint64 hmask,
+        const byte *buf, int len, uint64 offset, CRCSet *set, CRCReport report, void *ctx, const int reflected) {
+    const uint64 *table = this->table;
+    CRCWindow *w = NULL;
+    uint64 pos = offset;
+    int i = 0, k = 0;
+    byte d = 0;
+
+    for (i = 0; i < len; i++, pos++) {
+        d = buf[i];
+        for (k = 0; k < nlengths; k++) {
+            w = &windows[k];
+            w->crc = CRC_step (table, w->crc, d, reflected);
+            if (pos >= w->length) {
+                w->crc ^= w->out[history[(pos - w->length) & hmask]];
+            }
+            else if (pos + 1 < w->length) {
+                continue;
+            }
+            if (CRCSet_has (set, w->crc ^ w->bias)) {
+                this->found = (byte)1;
+                this->matches++;
+                if (report) {
+                    report (ctx, CRCModel_final (this->model, w->crc ^ w->bias), pos + 1 - w->length, pos + 1);
+                }
+            }
+        }
+        history[pos & hmask] = d;
+    }
+}
+
+/* every window of the given lengths is checked in O(1) per byte and length:
+ *   crc(d[i-L+1..i]) = step(crc(d[i-L..i-1]), d[i]) ^ out[d[i-L]]
+ * bytes read go to bytes, returns SUCCESS or ERROR with errno set */
+int CRCSearch_window(
+    CRCSearch *this,
+    const char *fname,
+    const uint64 *lengths,
+    int nlengths,
+    CRCSet *set,
+    CRCReport report,
+    void *ctx,
+    uint64 *bytes
+) {
+    CRCWindow *windows = NULL;
+    byte *history = NULL;
+    const byte *buff = NULL;
+    uint64 maxlen = 0ULL, hsize = 1ULL, hmask = 0ULL;
+    uint64 totread = 0ULL;
+    int k = 0, numread = 0, err = 0;
+    CRCStream *in = NULL;
+
+    *bytes = 0ULL;
+    if (nlengths < 1) {
+        errno = EINVAL;
+        return ERROR;
+    }
+
+    windows = (CRCWindow *) calloc (nlengths, sizeof (CRCWindow));
+    if (!windows) {
+        fprintf (stderr, "Out of memory (window)\n");
+        errno = ENOMEM;
+        return ERROR;
+    }
+    for (k = 0; k < nlengths; k++) {
+        CRCWindow_init (this, &windows[k], lengths[k]);
+        if (lengths[k] > maxlen) {
+            maxlen = lengths[k];
+        }
+    }
+
+    /* ring buffer of the last maxlen bytes for the bytes leaving windows */
+    while (hsize <= maxlen) {
+        hsize <<= 1;
+    }
+    hmask = hsize - 1;
+    history = (byte *) calloc (hsize, sizeof (byte));
+    if (!history) {
+        fprintf (stderr, "Out of memory (window history)\n");
+        free (windows);
+        errno = ENOMEM;
+        return ERROR;
+    }
+
+    in = CRCStream_open (fname, this->progress);
+    if (!in) {
+        err = errno;
+        free (history);
+        free (windows);
+        errno = err;
+        return ERROR;
+    }
+
+    while ((numread = (int)in->next (in, &buff)) > 0) {
+        if (this->model->refin) {
+            CRCWindow_scan (this, windows, nlengths, history, hmask, buff, numread, totread, set, report, ctx, 1);
+        }
+        else {
+            CRCWindow_scan (this, windows, nlengths, history, hmask, buff, numread, totread, set, report, ctx, 0);
+        }
+        totread += numread;
+    }
+    this->length = totread;
+    *bytes = totread;
+    err = numread < 0 ? in->error : 0;
+
+    in->close (&in);
+    free (history);
+    free (windows);
+
+    if (err) {
+        errno = err;
+        return ERROR;
+    }
+    return SUCCESS;
+}
@@ -0,0 +1,25 @@
+#ifndef __CRCWINDOW_H_
+#define __CRCWINDOW_H_
+
+#include "crcsearch.h"
+
+/* maximum number of window lengths searched in one pass */
+#define MAXWINDOWS 32
+
+typedef struct CRCWindow CRCWindow;
+
+/* rolling CRC over the last length bytes */
+struct CRCWindow {
+    uint64 length;
+    uint64 crc;
+    /* register of length zero bytes from the model's init, rolling CRCs
+     * start from 0 so this is xor'ed in before probing */
+    uint64 bias;
+    /* CRC of byte b followed by length zero bytes, xor'ed in to remove
+     * the contribution of the byte leaving the window */
+    uint64 out[TABSIZE];
+};
+
+int CRCWindow_parse (const char *, uint64 *, int);
+
+#endif
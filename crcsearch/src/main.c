@@ -0,0 +1,226 @@
+#include <stdio.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+
+#include "crcsearch.h"
+#include "crcmodel.h"
+#include "crcset.h"
+#include "crcwindow.h"
+#include "crcstream.h"
+#include "crcbatch.h"
+
+void usage (void) {
+    const char *usage = "NAME                                           \n\
+       crcsearch                                                        \n\
+                                                                        \n\
+SYNOPSIS                                                                \n\
+       crcsearch -i file -q crc checksum                                \n\
+       crcsearch -i file -Q checksum file                               \n\
+       crcsearch -i file -w length[,length...] -q crc | -Q file         \n\
+       crcsearch -m model ...                                           \n\
+       command | crcsearch [-i -] [-P] ...                              \n\
+       crcsearch -b [-t threads] -q crc | -Q file ... path|glob ...     \n\
+                                                                        \n\
+DESCRIPTION                                                             \n\
+       Searches file for a given checksum and report it's range in file \n\
+                                                                        \n\
+       -Q  file of hex checksums, one per line, reports every prefix    \n\
+           matching any of them in a single pass                        \n\
+       -w  comma separated window lengths, reports every [start, end)   \n\
+           range of those lengths matching the checksum(s)              \n\
+       -m  CRC model: crcsearch (default), crc-32, crc-32c, crc-64/xz,  \n\
+           crc-64/ecma-182, crc-64/we or a custom model given as        \n\
+           width,poly,refin,refout,init,xorout with hex poly/init/xorout\n\
+           crc-32c uses the SSE4.2 crc32 instruction when available     \n\
+       -p  reflected polynomial for the default crcsearch model         \n\
+       -i  input file, - or no -i reads stdin, /dev/fd/N reads an fd    \n\
+       -P  report bytes read and GB/s to stderr every second            \n\
+       -b  batch mode, searches the files, directories (recursively)    \n\
+           and glob patterns given after the options on worker threads, \n\
+           splitting large files, one JSON line per match on stdout     \n\
+       -t  batch worker threads, default one per CPU                    \n\
+\n";
+
+    fprintf (stdout, "%s", usage);
+}
+
+#define CRC_64_ECMA_182 0x42f0e1eba9ea3693ULL
+
+void report (void *fname, uint64 crc, uint64 start, uint64 end) {
+    fprintf (stdout, "INFO: Checksum: 0x%llx valid for bytes %llu to %llu of file: %s\n", crc, start, end, (char *)fname);
+}
+
+int main (int argc, char **argv) {
+    char *fname = NULL;
+    char *qname = NULL;
+    uint64 crc = 0ULL, bytes = 0ULL;
+    uint64 poly = CRC_64_ECMA_182;
+    const CRCModel *model = &CRCModels[0];
+    CRCModel custom;
+    uint64 lengths[MAXWINDOWS];
+    int nlengths = 0;
+    byte progress = 0;
+    byte batch = 0;
+    int threads = 0, i = 0, ret = SUCCESS;
+    char c = 0;
+    CRCSearch *cs;
+    CRCSet *set = NULL;
+    CRCBatch *cb = NULL;
+
+    /* parse command line */
+    while ((c = getopt (argc, argv, "i:q:Q:p:w:m:Pbt:")) != -1) {
+        switch (c) {
+            case 'i':
+                fname = strdup (optarg);
+                break;
+            case 'q':
+                crc = strtoull (optarg, NULL, 16);
+                break;
+            case 'Q':
+                qname = strdup (optarg);
+                break;
+            case 'p':
+                fprintf (stdout, "INFO: Using user provided polynomial: %s\n", optarg);
+                poly = strtoull (optarg, NULL, 16);
+                custom = CRCModels[0];
+                custom.name = "custom";
+                custom.poly = CRCModel_reflect (poly, CRCBITS);
+                custom.table = NULL;
+                custom.update = NULL;
+                model = &custom;
+                break;
+            case 'm':
+                model = CRCModel_find (optarg);
+                if (!model) {
+                    if (CRCModel_parse (optarg, &custom) != SUCCESS) {
+                        return ERROR;
+                    }
+                    model = &custom;
+                }
+                break;
+            case 'P':
+                progress = (byte)1;
+                break;
+            case 'b':
+                batch = (byte)1;
+                break;
+            case 't':
+                threads = atoi (optarg);
+                break;
+            case 'w':
+                nlengths = CRCWindow_parse (optarg, lengths, MAXWINDOWS);
+                if (nlengths < 0) {
+                    return ERROR;
+                }
+                break;
+            case '?':
+                fprintf (stderr, "Invalid option: %c\n", c);
+                return ERROR;
+            default:
+                usage();
+                return SUCCESS;
+        }
+    }
+
+    if (argc == 1) {
+        usage();
+        return SUCCESS;
+    }
+    if (!fname) {
+        fname = strdup (STDIN_NAME);
+    }
+
+    /* targets: checksum file, or the single checksum when searching windows
+     * or in batch mode */
+    if (qname) {
+        set = CRCSet_load (qname, model);
+    }
+    else if (nlengths || batch) {
+        set = CRCSet_new ();
+        if (set) {
+            set->add(set, CRCModel_raw (model, crc));
+        }
+    }
+    if ((qname || nlengths || batch) && !set) {
+        if (qname) {
+            free (qname);
+        }
+        if (fname) {
+            free (fname);
+        }
+        return ERROR;
+    }
+
+    /* stdout is JSON lines, one per match */
+    if (batch) {
+        fprintf (stderr, "INFO: Using CRC model: %s\n", model->name);
+        cb = CRCBatch_new (model, set, lengths, nlengths, (byte)(!qname && !nlengths), threads);
+        for (i = optind; cb && ret == SUCCESS && i < argc; i++) {
+            ret = cb->add (cb, argv[i]);
+        }
+        if (cb && ret == SUCCESS) {
+            ret = cb->run (cb);
+        }
+        else {
+            ret = ERROR;
+        }
+        if (cb) {
+            cb->close (&cb);
+        }
+        set->close (&set);
+        if (qname) {
+            free (qname);
+        }
+        free (fname);
+        return ret;
+    }
+
+    /* setup search and lookup table */
+    fprintf (stdout, "INFO: Using CRC model: %s\n", model->name);
+    cs = CRCSearch_new(model);
+    cs->progress = progress;
+    if (cs->hw) {
+        fprintf (stdout, "INFO: Using SSE4.2 crc32 instruction\n");
+    }
+    if (nlengths) {
+        fprintf (stdout, "INFO: Searching %d window length(s) for %llu checksum(s) in file: %s\n", nlengths, set->count + set->zero, fname);
+        if (cs->window(cs, fname, lengths, nlengths, set, &report, fname, &bytes) != SUCCESS) {
+            fprintf (stderr, "ERROR: window search failed on file: %s: %s\n", fname, strerror (errno));
+            ret = ERROR;
+        }
+        fprintf (stdout, "INFO: Found %llu matching ranges in file: %s\n", cs->matches, fname);
+    }
+    else if (set) {
+        fprintf (stdout, "INFO: Searching for %llu checksums from: %s in file: %s\n", set->count + set->zero, qname, fname);
+        if (cs->searchSet(cs, fname, set, &report, fname) != SUCCESS) {
+            fprintf (stderr, "ERROR: search failed on file: %s: %s\n", fname, strerror (errno));
+            ret = ERROR;
+        }
+        fprintf (stdout, "INFO: Found %llu matching prefixes in file: %s\n", cs->matches, fname);
+    }
+    else {
+        fprintf (stdout, "INFO: Searching for checksum: %llu in file: %s\n", crc, fname);
+        if (cs->search(cs, fname, crc)) {
+            if (cs->found) {
+                fprintf (stdout, "INFO: Checksum: %llu valid for first %llu bytes of file: %s\n", crc, cs->length, fname);
+            }
+            else {
+                fprintf (stdout, "INFO: Checksum: %llu is not valid for contents of file: %s\n", crc, fname);
+            }
+        }
+    }
+    cs->close(&cs);
+
+    if (set) {
+        set->close(&set);
+    }
+    if (qname) {
+        free (qname);
+    }
+    if (fname) {
+        free (fname);
+    }
+
+    return ret;
+}
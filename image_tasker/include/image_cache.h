@@ -7,7 +7,8 @@
 #include <map>
 #include <atomic>
 
-template <class T> class TQueue;
+#include "queue_fwd.hpp"
+
 struct ImageData;
 
 template <class T>
@@ -3,8 +3,9 @@
 #include <string>
 #include <memory>
 
+#include "queue_fwd.hpp"
+
 class ImageData;
-template <class T> class TQueue;
 struct TaskStatus;
 
 class IImageHandler
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <memory>
 #include <thread>
 #include <atomic>
@@ -8,9 +9,19 @@
 #include <string>
 
 #include "image_data.h"
+#include "queue_fwd.hpp"
 
 struct TaskStatus;
-template <class T> class TQueue;
+
+/**
+ * Order tasks are picked up in, prefetches give way to requests someone waits on
+ */
+enum class TaskPriority: unsigned char
+{
+    Prefetch = 0,
+    Normal,
+    Interactive
+};
 
 /**
  * Args for requesting an image
@@ -23,6 +34,9 @@ struct ImageTask
     bool auto_resize;
     std::shared_ptr<TQueue<TaskStatus>> status_queue;
     std::shared_ptr<TQueue<std::unique_ptr<ImageData>>> result_queue;
+    TaskPriority priority = TaskPriority::Normal;
+    // dropped instead of run once passed, nobody is waiting for the result
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
 
     ImageTask() = delete;
     ImageTask(const ImageTask&) = delete;
@@ -57,10 +71,22 @@ struct ImageTask
       resizer(std::move(other.resizer)),
       auto_resize(other.auto_resize),
       status_queue(std::move(other.status_queue)),
-      result_queue(std::move(other.result_queue))
+      result_queue(std::move(other.result_queue)),
+      priority(other.priority),
+      deadline(other.deadline)
     {}
  };
 
+struct ImageTaskOrder
+{
+    bool operator()(const ImageTask& a, const ImageTask& b) const
+    {
+        return a.priority < b.priority;
+    }
+};
+
+using ImageTaskQueue = TQueue<ImageTask, tqueue::priority<ImageTaskOrder>>;
+
 /**
  * Interruptable task runner
  */
@@ -68,12 +94,12 @@ class ImageTaskRunner
 {
 public:
     ImageTaskRunner() = delete;
-    ImageTaskRunner(std::shared_ptr<TQueue<ImageTask>> task_queue);
+    ImageTaskRunner(std::shared_ptr<ImageTaskQueue> task_queue);
     ImageTaskRunner(const ImageTaskRunner&) = delete;
     ~ImageTaskRunner();
 
 private:
-    void run(std::stop_token ctrl, std::shared_ptr<TQueue<ImageTask>> task_queue);
+    void run(std::stop_token ctrl, std::shared_ptr<ImageTaskQueue> task_queue);
     void stop();
     void report_task_failure(const ImageTask& task, std::chrono::duration<double> duration, std::vector<std::string> errors);
     void report_task_success(const ImageTask& task, std::chrono::duration<double> duration);
@@ -85,6 +111,8 @@ private:
 };
 
 constexpr unsigned int DEFAULT_POOL_SIZE = 8;
+// pending tasks before submit_task blocks the caller, until the task's deadline at most
+constexpr unsigned int TASK_QUEUE_CAPACITY = 1024;
 
 class ImageTaskManager
 {
@@ -97,7 +125,7 @@ public:
 
 private:
     std::vector<std::unique_ptr<ImageTaskRunner>> runner_pool;
-    std::shared_ptr<TQueue<ImageTask>> task_queue;
+    std::shared_ptr<ImageTaskQueue> task_queue;
     std::mutex pool_mutex;
     unsigned int pool_size;
 };
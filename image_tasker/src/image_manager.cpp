@@ -41,11 +41,12 @@ public:
                 // if not in cache, submit request to load
                 std::string task_id = "image loader: " + std::to_string(key);
                 std::string file = std::string(image_path);
-                impl->task_manager->submit_task(ImageTask(
+                ImageTask task(
                     task_id,
                     file,
                     impl->task_status_queue,
-                    impl->image_queue));
+                    impl->image_queue);
+                impl->submit_request(std::move(task));
 
                 int wait_ms = 0;
                 found_entry = false;
@@ -84,13 +85,14 @@ public:
                 }
                 std::string task_id = "image resizer: " + std::to_string(key);
                 std::string file = std::string(image_path);
-                impl->task_manager->submit_task(ImageTask(
+                ImageTask task(
                     task_id,
                     file,
                     size_x,
                     size_y,
                     impl->task_status_queue,
-                    impl->image_queue));
+                    impl->image_queue);
+                impl->submit_request(std::move(task));
 
                 int wait_ms = 0;
                 found_entry = false;
@@ -102,7 +104,7 @@ public:
                         return;
                     }
                     std::this_thread::sleep_for(std::chrono::milliseconds(10)); 
-                    wait_ms++;
+                    wait_ms += 10;
                 }
                 handler->Process(impl->image_cache->get(key, found_entry));
             }
@@ -114,6 +116,16 @@ public:
     {
         this->task_status_queue = queue;
     }
+
+    /**
+     * @brief Submit a task for a caller waiting on it, dropped if still queued once the caller gives up
+     */
+    void submit_request(ImageTask&& task)
+    {
+        task.priority = TaskPriority::Interactive;
+        task.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(request_timeout_ms);
+        task_manager->submit_task(std::move(task));
+    }
 public:
     // impl is hidden, therefore public access
     std::shared_ptr<TQueue<std::unique_ptr<ImageData>>> image_queue;
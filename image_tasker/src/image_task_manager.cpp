@@ -1,12 +1,13 @@
 #include "image_task_manager.h"
 #include "basic_queue.hpp"
+#include "priority_queue.hpp"
 #include "image_data.h"
 #include "task_status.h"
 
 #include <algorithm>
 #include <chrono>
 
-ImageTaskRunner::ImageTaskRunner(std::shared_ptr<TQueue<ImageTask>> task_queue)
+ImageTaskRunner::ImageTaskRunner(std::shared_ptr<ImageTaskQueue> task_queue)
 {
     runner_thread = std::jthread{
         [task_queue, this](std::stop_token ctrl){
@@ -19,7 +20,7 @@ ImageTaskRunner::~ImageTaskRunner()
     stop();
 }
 
-void ImageTaskRunner::run(std::stop_token ctrl, std::shared_ptr<TQueue<ImageTask>> task_queue)
+void ImageTaskRunner::run(std::stop_token ctrl, std::shared_ptr<ImageTaskQueue> task_queue)
 {
     while (!ctrl.stop_requested())
     {
@@ -103,12 +104,27 @@ void ImageTaskRunner::report_task_success(const ImageTask& task, std::chrono::du
     task.status_queue->enqueue(TaskStatus(task.task_id, TaskState::Completed, duration));
 }
 
+// a task that never reached a runner
+static void report_task_dropped(const ImageTask& task, const std::string& reason)
+{
+    if (!task.status_queue)
+    {
+        return;
+    }
+    auto errors = std::vector<std::string>{ "Dropped image task, reason: " + reason };
+    task.status_queue->enqueue(TaskStatus(task.task_id, TaskState::Failed, std::chrono::duration<double>(0), errors));
+}
+
 ImageTaskManager::ImageTaskManager() : ImageTaskManager(DEFAULT_POOL_SIZE)
 {}
 
 ImageTaskManager::ImageTaskManager(unsigned int pool_size)
 {
-    task_queue = std::make_shared<TQueue<ImageTask>>();
+    task_queue = std::make_shared<ImageTaskQueue>(TASK_QUEUE_CAPACITY);
+    task_queue->on_expired([](ImageTask&& task)
+    {
+        report_task_dropped(task, "deadline passed before it could run");
+    });
     if (pool_size < 1)
     {
         this->pool_size = DEFAULT_POOL_SIZE;
@@ -150,5 +166,12 @@ void ImageTaskManager::increase_pool_size_by(unsigned int delta_pool_size)
 
 void ImageTaskManager::submit_task(ImageTask&& task)
 {
-    task_queue->enqueue(std::move(task));
+    auto deadline = task.deadline;
+    // waits for room no longer than the deadline, the task is left to us on failure
+    if (!task_queue->enqueue(std::move(task), deadline))
+    {
+        report_task_dropped(task, task_queue->is_shutdown()
+            ? "task manager shut down"
+            : "deadline passed while the task queue was full");
+    }
 }
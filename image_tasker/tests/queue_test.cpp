@@ -0,0 +1,486 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "basic_queue.hpp"
+#include "ring_queue.hpp"
+#include "spsc_queue.hpp"
+#include "priority_queue.hpp"
+
+#include <gtest/gtest.h>
+
+TEST(RingQueue, Fifo)
+{
+    RingQueue<int> queue(64);
+    for (int i = 1; i <= 50; i++)
+    {
+        EXPECT_TRUE(queue.enqueue(std::move(i)));
+    }
+    for (int i = 1; i <= 50; i++)
+    {
+        std::optional<int> entry = queue.dequeue();
+        ASSERT_TRUE(entry.has_value());
+        EXPECT_EQ(*entry, i);
+    }
+    EXPECT_FALSE(queue.dequeue().has_value());
+}
+
+TEST(RingQueue, Full)
+{
+    RingQueue<std::unique_ptr<int>> queue(5);
+    EXPECT_EQ(queue.capacity(), 8);
+    for (int i = 0; i < 8; i++)
+    {
+        EXPECT_TRUE(queue.try_enqueue(std::make_unique<int>(i)));
+    }
+    std::unique_ptr<int> extra = std::make_unique<int>(8);
+    EXPECT_FALSE(queue.try_enqueue(std::move(extra)));
+    // a failed enqueue leaves the entry with the caller
+    ASSERT_TRUE(extra);
+    EXPECT_EQ(**queue.dequeue(), 0);
+    EXPECT_TRUE(queue.try_enqueue(std::move(extra)));
+}
+
+TEST(RingQueue, ManyProducersConsumers)
+{
+    constexpr int threads = 4;
+    constexpr int per_producer = 20000;
+    RingQueue<int> queue(256);
+    std::atomic<long long> sum{0};
+    std::atomic<int> received{0};
+    std::vector<std::jthread> consumers;
+    for (int c = 0; c < threads; c++)
+    {
+        consumers.emplace_back([&]()
+        {
+            while (std::optional<int> entry = queue.dequeue_wait())
+            {
+                sum += *entry;
+                received++;
+            }
+        });
+    }
+    {
+        std::vector<std::jthread> producers;
+        for (int p = 0; p < threads; p++)
+        {
+            producers.emplace_back([&queue]()
+            {
+                for (int i = 1; i <= per_producer; i++)
+                {
+                    queue.enqueue(std::move(i));
+                }
+            });
+        }
+    }
+    while (received.load() < threads * per_producer)
+    {
+        std::this_thread::yield();
+    }
+    queue.shutdown();
+    consumers.clear();
+    EXPECT_EQ(sum.load(), threads * (long long)per_producer * (per_producer + 1) / 2);
+}
+
+TEST(RingQueue, ShutdownWakesWaiters)
+{
+    RingQueue<int> empty(2);
+    RingQueue<int> full(2);
+    EXPECT_TRUE(full.try_enqueue(1));
+    EXPECT_TRUE(full.try_enqueue(2));
+    std::jthread consumer([&empty]()
+    {
+        EXPECT_FALSE(empty.dequeue_wait().has_value());
+    });
+    std::jthread producer([&full]()
+    {
+        EXPECT_FALSE(full.enqueue(3));
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    empty.shutdown();
+    full.shutdown();
+}
+
+TEST(TQueue, Bulk)
+{
+    TQueue<int> queue;
+    std::vector<int> in{1, 2, 3, 4, 5, 6, 7};
+    queue.enqueue_bulk(in);
+    std::vector<int> out;
+    EXPECT_EQ(queue.dequeue_bulk(std::back_inserter(out), 5), 5);
+    EXPECT_EQ(queue.dequeue_bulk(std::back_inserter(out), 5), 2);
+    EXPECT_EQ(queue.dequeue_bulk(std::back_inserter(out), 5), 0);
+    EXPECT_EQ(out, in);
+}
+
+TEST(RingQueue, Bulk)
+{
+    RingQueue<std::unique_ptr<int>> queue(8);
+    std::vector<std::unique_ptr<int>> in;
+    for (int i = 0; i < 6; i++)
+    {
+        in.push_back(std::make_unique<int>(i));
+    }
+    EXPECT_EQ(queue.enqueue_bulk(in), 6);
+    std::vector<std::unique_ptr<int>> out;
+    EXPECT_EQ(queue.dequeue_bulk(std::back_inserter(out), 4), 4);
+    // wraps around the end of the ring
+    EXPECT_EQ(queue.enqueue_bulk(std::vector<std::unique_ptr<int>>(5)), 5);
+    EXPECT_EQ(queue.dequeue_bulk(std::back_inserter(out), 16), 7);
+    ASSERT_EQ(out.size(), 11);
+    for (int i = 0; i < 6; i++)
+    {
+        EXPECT_EQ(*out[i], i);
+    }
+    EXPECT_FALSE(out[6]);
+}
+
+TEST(RingQueue, BulkManyProducersConsumers)
+{
+    constexpr int threads = 4;
+    constexpr int batches = 2000;
+    constexpr int batch = 16;
+    RingQueue<int> queue(64);
+    std::atomic<long long> sum{0};
+    std::atomic<int> received{0};
+    std::vector<std::jthread> consumers;
+    for (int c = 0; c < threads; c++)
+    {
+        consumers.emplace_back([&]()
+        {
+            std::vector<int> out;
+            while (!queue.is_shutdown())
+            {
+                out.clear();
+                if (queue.dequeue_bulk(std::back_inserter(out), batch) == 0)
+                {
+                    queue.wait_for_entry_or_shutdown();
+                    continue;
+                }
+                for (int v : out)
+                {
+                    sum += v;
+                }
+                received += (int)out.size();
+            }
+        });
+    }
+    {
+        std::vector<std::jthread> producers;
+        for (int p = 0; p < threads; p++)
+        {
+            producers.emplace_back([&queue]()
+            {
+                std::vector<int> in(batch, 1);
+                for (int i = 0; i < batches; i++)
+                {
+                    queue.enqueue_bulk(in);
+                }
+            });
+        }
+    }
+    while (received.load() < threads * batches * batch)
+    {
+        std::this_thread::yield();
+    }
+    queue.shutdown();
+    consumers.clear();
+    EXPECT_EQ(sum.load(), threads * batches * batch);
+}
+
+TEST(TQueue, Bounded)
+{
+    using namespace std::chrono_literals;
+    TQueue<int> queue(2);
+    EXPECT_EQ(queue.capacity(), 2);
+    EXPECT_TRUE(queue.try_enqueue(1));
+    EXPECT_TRUE(queue.enqueue(2));
+    EXPECT_FALSE(queue.try_enqueue(3));
+    EXPECT_FALSE(queue.enqueue_for(3, 10ms));
+    std::jthread consumer([&queue]()
+    {
+        std::this_thread::sleep_for(10ms);
+        EXPECT_EQ(queue.dequeue(), 1);
+    });
+    // blocks until the consumer makes room
+    EXPECT_TRUE(queue.enqueue(3));
+    EXPECT_EQ(queue.size(), 2);
+}
+
+TEST(TQueue, TimedWaits)
+{
+    using namespace std::chrono_literals;
+    TQueue<int> queue;
+    EXPECT_FALSE(queue.wait_for_entry_for(5ms));
+    EXPECT_FALSE(queue.dequeue_for(5ms).has_value());
+    std::jthread producer([&queue]()
+    {
+        std::this_thread::sleep_for(5ms);
+        queue.enqueue(7);
+    });
+    EXPECT_EQ(queue.dequeue_for(10s), 7);
+}
+
+TEST(TQueue, ShutdownReleasesProducer)
+{
+    TQueue<int> queue(1);
+    EXPECT_TRUE(queue.enqueue(1));
+    std::jthread producer([&queue]()
+    {
+        EXPECT_FALSE(queue.enqueue(2));
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    queue.shutdown();
+}
+
+TEST(RingQueue, TimedWaits)
+{
+    using namespace std::chrono_literals;
+    RingQueue<int> queue(2);
+    EXPECT_FALSE(queue.wait_for_entry_for(5ms));
+    EXPECT_FALSE(queue.dequeue_for(5ms).has_value());
+    EXPECT_TRUE(queue.enqueue_for(1, 5ms));
+    EXPECT_TRUE(queue.enqueue_for(2, 5ms));
+    EXPECT_FALSE(queue.enqueue_for(3, 5ms));
+    std::jthread consumer([&queue]()
+    {
+        std::this_thread::sleep_for(5ms);
+        EXPECT_EQ(queue.dequeue(), 1);
+    });
+    EXPECT_TRUE(queue.enqueue_for(3, 10s));
+    consumer.join();
+    EXPECT_EQ(queue.dequeue_for(10s), 2);
+    EXPECT_EQ(queue.dequeue_for(10s), 3);
+}
+
+TEST(SpscQueue, Fifo)
+{
+    TQueue<std::unique_ptr<int>, tqueue::spsc> queue(4);
+    EXPECT_EQ(queue.capacity(), 4);
+    for (int round = 0; round < 3; round++)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            EXPECT_TRUE(queue.try_enqueue(std::make_unique<int>(i)));
+        }
+        std::unique_ptr<int> extra = std::make_unique<int>(4);
+        EXPECT_FALSE(queue.try_enqueue(std::move(extra)));
+        ASSERT_TRUE(extra);
+        for (int i = 0; i < 4; i++)
+        {
+            EXPECT_EQ(**queue.dequeue(), i);
+        }
+        EXPECT_FALSE(queue.dequeue().has_value());
+    }
+}
+
+TEST(SpscQueue, Pipeline)
+{
+    constexpr int count = 200000;
+    TQueue<int, tqueue::spsc> queue(64);
+    std::jthread producer([&queue]()
+    {
+        std::vector<int> batch;
+        for (int i = 0; i < count; i++)
+        {
+            if (i % 3 == 0)
+            {
+                queue.enqueue(std::move(i));
+                continue;
+            }
+            batch.push_back(i);
+            if (batch.size() == 8)
+            {
+                queue.enqueue_bulk(batch);
+                batch.clear();
+            }
+        }
+        queue.enqueue_bulk(batch);
+    });
+    std::vector<int> out;
+    while ((int)out.size() < count)
+    {
+        if (queue.dequeue_bulk(std::back_inserter(out), 16) == 0)
+        {
+            queue.wait_for_entry_or_shutdown();
+        }
+    }
+    std::sort(out.begin(), out.end());
+    for (int i = 0; i < count; i++)
+    {
+        ASSERT_EQ(out[i], i);
+    }
+}
+
+TEST(QueuePolicy, Mpmc)
+{
+    TQueue<int, tqueue::mpmc> queue(16);
+    EXPECT_EQ(queue.capacity(), 16);
+    EXPECT_TRUE(queue.enqueue(1));
+    EXPECT_EQ(queue.dequeue(), 1);
+    queue.shutdown();
+    EXPECT_FALSE(queue.dequeue_wait().has_value());
+}
+
+TEST(PriorityQueue, Order)
+{
+    TQueue<int, tqueue::priority<std::less<int>>> queue;
+    for (int v : {3, 1, 4, 1, 5, 9, 2, 6, 5, 3, 5})
+    {
+        EXPECT_TRUE(queue.enqueue(std::move(v)));
+    }
+    std::vector<int> out;
+    while (std::optional<int> v = queue.dequeue())
+    {
+        out.push_back(*v);
+    }
+    EXPECT_EQ(out, (std::vector<int>{9, 6, 5, 5, 5, 4, 3, 3, 2, 1, 1}));
+}
+
+struct Job
+{
+    int priority;
+    int id;
+};
+
+struct JobOrder
+{
+    bool operator()(const Job& a, const Job& b) const
+    {
+        return a.priority < b.priority;
+    }
+};
+
+TEST(PriorityQueue, StableAndExpiring)
+{
+    using namespace std::chrono_literals;
+    using clock = std::chrono::steady_clock;
+    TQueue<Job, tqueue::priority<JobOrder>> queue;
+    std::vector<int> dropped;
+    queue.on_expired([&dropped](Job&& job)
+    {
+        dropped.push_back(job.id);
+    });
+    queue.enqueue(Job{0, 1});
+    queue.enqueue(Job{0, 2}, clock::now() - 1ms);
+    queue.enqueue(Job{1, 3});
+    queue.enqueue(Job{1, 4}, clock::now() - 1ms);
+    queue.enqueue(Job{0, 5}, clock::now() + 1h);
+    queue.enqueue(Job{1, 6});
+
+    std::vector<int> out;
+    while (std::optional<Job> job = queue.dequeue())
+    {
+        out.push_back(job->id);
+    }
+    EXPECT_EQ(out, (std::vector<int>{3, 6, 1, 5}));
+    EXPECT_EQ(dropped, (std::vector<int>{4, 2}));
+    EXPECT_EQ(queue.expired_count(), 2);
+}
+
+TEST(PriorityQueue, Concurrent)
+{
+    using namespace std::chrono_literals;
+    constexpr int threads = 4;
+    constexpr int per_producer = 5000;
+    TQueue<int, tqueue::priority<std::less<int>>> queue(64);
+    std::atomic<long long> sum{0};
+    std::atomic<int> received{0};
+    std::vector<std::jthread> consumers;
+    for (int c = 0; c < threads; c++)
+    {
+        consumers.emplace_back([&]()
+        {
+            while (received.load() < threads * per_producer)
+            {
+                if (std::optional<int> v = queue.dequeue_for(1ms))
+                {
+                    sum += *v;
+                    received++;
+                }
+            }
+        });
+    }
+    std::vector<std::jthread> producers;
+    for (int p = 0; p < threads; p++)
+    {
+        producers.emplace_back([&queue]()
+        {
+            for (int i = 1; i <= per_producer; i++)
+            {
+                queue.enqueue(std::move(i));
+            }
+        });
+    }
+    producers.clear();
+    consumers.clear();
+    EXPECT_EQ(sum.load(), threads * (long long)per_producer * (per_producer + 1) / 2);
+}
+
+TEST(PriorityQueue, DeadlineBoundsEnqueue)
+{
+    using namespace std::chrono_literals;
+    using clock = std::chrono::steady_clock;
+    TQueue<int, tqueue::priority<std::less<int>>> queue(1);
+    EXPECT_TRUE(queue.enqueue(1));
+    auto start = clock::now();
+    EXPECT_FALSE(queue.enqueue(2, start + 10ms));
+    EXPECT_LT(clock::now() - start, 5s);
+    EXPECT_FALSE(queue.enqueue_for(2, 5ms));
+    std::jthread consumer([&queue]()
+    {
+        std::this_thread::sleep_for(5ms);
+        EXPECT_EQ(queue.dequeue(), 1);
+    });
+    EXPECT_TRUE(queue.enqueue_for(2, 10s));
+    consumer.join();
+    EXPECT_EQ(queue.dequeue(), 2);
+}
+
+TEST(PriorityQueue, DrainsAfterShutdown)
+{
+    using namespace std::chrono_literals;
+    TQueue<int, tqueue::priority<std::less<int>>> queue;
+    EXPECT_FALSE(queue.dequeue_for(5ms).has_value());
+    queue.enqueue(1);
+    queue.enqueue(2);
+    queue.shutdown();
+    EXPECT_TRUE(queue.is_shutdown());
+    EXPECT_EQ(queue.dequeue_for(10s), 2);
+    EXPECT_EQ(queue.dequeue_wait(), 1);
+    EXPECT_FALSE(queue.dequeue_for(10s).has_value());
+    EXPECT_FALSE(queue.dequeue_wait().has_value());
+}
+
+TEST(PriorityQueue, Bulk)
+{
+    using namespace std::chrono_literals;
+    using clock = std::chrono::steady_clock;
+    TQueue<int, tqueue::priority<std::less<int>>> queue;
+    int dropped = 0;
+    queue.on_expired([&dropped](int&& v)
+    {
+        dropped = v;
+    });
+    EXPECT_EQ(queue.enqueue_bulk(std::vector<int>{3, 1, 4, 1, 5}), 5);
+    queue.enqueue(9, clock::now() - 1ms);
+    std::vector<int> out;
+    EXPECT_EQ(queue.dequeue_bulk(std::back_inserter(out), 3), 3);
+    EXPECT_EQ(queue.dequeue_bulk(std::back_inserter(out), 8), 2);
+    EXPECT_EQ(out, (std::vector<int>{5, 4, 3, 1, 1}));
+    EXPECT_EQ(dropped, 9);
+}
+
+TEST(PriorityQueue, StopWaitingForEntry)
+{
+    TQueue<int, tqueue::priority<std::less<int>>> queue;
+    std::jthread waiter([&queue](std::stop_token stop)
+    {
+        queue.wait_for_entry(stop);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    waiter.request_stop();
+}
@@ -0,0 +1,323 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <malloc.h>
+
+#include "table.h"
+#include "log.h"
+
+#define SEED 0x2545f4914f6cdd1dUL
+
+/* weather stations reporting in turn, one reading a minute each */
+#define STATIONS 64
+#define INTERVAL 60
+#define T0 1609459200
+#define DAY 86400
+#define YEAR (365 * DAY)
+
+/* point lookups timed per size, at most */
+#define LOOKUPS 1000000
+/* range scans of an hour each */
+#define RANGES 1000
+#define HOUR 3600
+
+void usage (void) {
+    const char *usage = "NAME                                           \n\
+       recbench                                                         \n\
+                                                                        \n\
+SYNOPSIS                                                                \n\
+       recbench [-m min records] [-n max records] [-r repeats]          \n\
+                                                                        \n\
+DESCRIPTION                                                             \n\
+       Builds tables of synthetic sensor readings from min (default     \n\
+       1000) to max (default 1000000) records, ten times more each      \n\
+       step, and reports insert, lookup, missed lookup and remove       \n\
+       Mops/s, range scan and aggregate Mrows/s and heap bytes per      \n\
+       record. Lookups and scans are checked, exits 1 on a mismatch.    \n\
+\n";
+
+    fprintf (stdout, "%s", usage);
+}
+
+static double now (void) {
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static unsigned long rng = SEED;
+
+/* xorshift64* */
+static unsigned long next (void) {
+    rng ^= rng >> 12;
+    rng ^= rng << 25;
+    rng ^= rng >> 27;
+    return rng * SEED;
+}
+
+static double uniform (void) {
+    return (next () >> 11) * (1.0 / (1UL << 53));
+}
+
+/* Box-Muller */
+static double gaussian (void) {
+    double u = uniform () + 1e-300, v = uniform ();
+
+    return sqrt (-2.0 * log (u)) * cos (2.0 * M_PI * v);
+}
+
+/* readings of STATIONS stations in time order with some jitter, each
+ * with its own climate: temperature follows the season and the time of
+ * day, relative humidity runs against it, both to 2 decimals */
+static void generate (record *rows, unsigned long n) {
+    double base[STATIONS], drift[STATIONS];
+    double season, daily, temp, relhum;
+    time_t t;
+    unsigned long i;
+    int s;
+
+    rng = SEED;
+    for (s = 0; s < STATIONS; s++) {
+        base[s] = 5.0 + 15.0 * uniform ();
+        drift[s] = 0.0;
+    }
+    for (i = 0; i < n; i++) {
+        s = i % STATIONS;
+        t = T0 + (time_t)(i / STATIONS) * INTERVAL + (time_t)(next () % 5);
+        season = -10.0 * cos (2.0 * M_PI * ((t - T0) % YEAR) / YEAR);
+        daily = -4.0 * cos (2.0 * M_PI * ((t - T0) % DAY) / DAY);
+        /* weather wanders slowly around the climate */
+        drift[s] = 0.999 * drift[s] + 0.2 * gaussian ();
+        temp = base[s] + season + daily + drift[s] + 0.1 * gaussian ();
+        relhum = 70.0 - 1.5 * (daily + drift[s]) + 0.5 * gaussian ();
+        relhum = relhum < 0.0 ? 0.0 : relhum > 100.0 ? 100.0 : relhum;
+        record_init (&rows[i], (int)i, t, round (temp * 100.0) / 100.0, round (relhum * 100.0) / 100.0);
+    }
+}
+
+static size_t heap (void) {
+    struct mallinfo2 mi = mallinfo2 ();
+
+    return mi.uordblks + mi.hblkhd;
+}
+
+static void shuffle (unsigned long *order, unsigned long n) {
+    unsigned long i, j, x;
+
+    for (i = 0; i < n; i++) {
+        order[i] = i;
+    }
+    for (i = n - 1; i > 0; i--) {
+        j = next () % (i + 1);
+        x = order[i];
+        order[i] = order[j];
+        order[j] = x;
+    }
+}
+
+static void count (void *ctx, record *r) {
+    (*(unsigned long *)ctx)++;
+}
+
+typedef struct timing timing;
+
+typedef struct timing {
+    double insert;
+    double lookup;
+    double miss;
+    double remove;
+    double range;
+    double aggregate;
+    double bytes;
+    /* the same with the store compressed, store bytes per record */
+    double packedLookup;
+    double packedAggregate;
+    double packedBytes;
+    double storeRatio;
+    int ok;
+} timing;
+
+/* one table of n records, rates are the best of repeats */
+static void run (record *rows, unsigned long n, int repeats, timing *best) {
+    unsigned long *order = malloc (n * sizeof (unsigned long));
+    unsigned long lookups = n < LOOKUPS ? n : LOOKUPS;
+    unsigned long i, found, visited, scanned, packed;
+    time_t span = rows[n - 1].t - rows[0].t, from;
+    table *t = NULL;
+    record r, miss;
+    query q;
+    result res;
+    size_t before;
+    double secs, raw;
+    int rep;
+
+    memset (best, 0, sizeof (timing));
+    best->ok = order != NULL;
+    for (rep = 0; rep < repeats && best->ok; rep++) {
+        shuffle (order, n);
+
+        before = heap ();
+        t = table_new ();
+        secs = now ();
+        for (i = 0; i < n; i++) {
+            t->insertRecord (t, &rows[i]);
+        }
+        secs = now () - secs;
+        best->insert = fmax (best->insert, n / secs / 1e6);
+        best->bytes = (double)(heap () - before) / n;
+
+        found = 0;
+        secs = now ();
+        for (i = 0; i < lookups; i++) {
+            found += t->getRecord (t, rows[order[i]].getKey(&rows[order[i]]), &r) == STATUS_OK;
+        }
+        secs = now () - secs;
+        best->lookup = fmax (best->lookup, lookups / secs / 1e6);
+        best->ok &= found == lookups;
+
+        found = 0;
+        secs = now ();
+        for (i = 0; i < lookups; i++) {
+            record_init (&miss, 0, rows[order[i]].t, rows[order[i]].temp + 200.0, rows[order[i]].relhum);
+            found += t->getRecord (t, miss.getKey(&miss), &r) == STATUS_OK;
+        }
+        secs = now () - secs;
+        best->miss = fmax (best->miss, lookups / secs / 1e6);
+        best->ok &= found == 0;
+
+        visited = scanned = 0;
+        secs = now ();
+        for (i = 0; i < RANGES; i++) {
+            from = rows[0].t + (span > HOUR ? (time_t)(next () % (span - HOUR)) : 0);
+            visited += t->findRange (t, from, from + HOUR - 1, &count, &scanned);
+        }
+        secs = now () - secs;
+        best->range = fmax (best->range, visited / secs / 1e6);
+        best->ok &= visited == scanned;
+
+        query_init (&q);
+        q.bucket = HOUR;
+        secs = now ();
+        best->ok &= t->runQuery (t, &q, &res) == STATUS_OK && res.count == n;
+        secs = now () - secs;
+        best->aggregate = fmax (best->aggregate, n / secs / 1e6);
+        query_free (&res);
+
+        secs = now ();
+        for (i = 0; i < n; i++) {
+            t->removeRecord (t, rows[order[i]].getKey(&rows[order[i]]));
+        }
+        secs = now () - secs;
+        best->remove = fmax (best->remove, n / secs / 1e6);
+        best->ok &= t->count == 0;
+        table_destroy (t);
+
+        /* again compressed, only full blocks are */
+        t = table_new ();
+        for (i = 0; i < n; i++) {
+            t->insertRecord (t, &rows[i]);
+        }
+        table_compress (t);
+        for (i = 0, packed = 0; i < t->rows->nblocks; i++) {
+            packed += t->rows->packed[i] != NULL;
+        }
+        raw = (double)t->rows->nblocks * sizeof (sblock);
+        best->packedBytes = ((t->rows->nblocks - packed) * sizeof (sblock) + t->rows->packedBytes) / (double)n;
+        best->storeRatio = raw / n / best->packedBytes;
+
+        found = 0;
+        secs = now ();
+        for (i = 0; i < lookups; i++) {
+            found += t->getRecord (t, rows[order[i]].getKey(&rows[order[i]]), &r) == STATUS_OK &&
+                r.id == rows[order[i]].id;
+        }
+        secs = now () - secs;
+        best->packedLookup = fmax (best->packedLookup, lookups / secs / 1e6);
+        best->ok &= found == lookups;
+
+        secs = now ();
+        best->ok &= t->runQuery (t, &q, &res) == STATUS_OK && res.count == n;
+        secs = now () - secs;
+        best->packedAggregate = fmax (best->packedAggregate, n / secs / 1e6);
+        query_free (&res);
+
+        table_destroy (t);
+    }
+    free (order);
+}
+
+int main (int argc, char **argv) {
+    unsigned long min = 1000, max = 1000000, n, i, dups;
+    record *rows = NULL;
+    table *t = NULL;
+    timing best;
+    int repeats = 3, failed = 0, c;
+
+    while ((c = getopt (argc, argv, "m:n:r:h")) != -1) {
+        switch (c) {
+            case 'm':
+                min = strtoul (optarg, NULL, 10);
+                break;
+            case 'n':
+                max = strtoul (optarg, NULL, 10);
+                break;
+            case 'r':
+                repeats = atoi (optarg);
+                break;
+            default:
+                usage ();
+                return c == 'h' ? 0 : 1;
+        }
+    }
+    if (!min || max < min || repeats < 1) {
+        usage ();
+        return 1;
+    }
+
+    rows = malloc (max * sizeof (record));
+    if (!rows) {
+        LOG_ERROR(("Out of memory (bench)\n"));
+        return 1;
+    }
+    generate (rows, max);
+
+    /* readings may repeat a key, lookups and removes need unique ones */
+    t = table_new ();
+    for (i = 0, dups = 0; i < max; i++) {
+        if (table_findRow (t, rows[i].getKey(&rows[i])) != NO_ROW) {
+            rows[i].temp += 0.01 * (1 + dups++ % 50);
+            i--;
+            continue;
+        }
+        t->insertRecord (t, &rows[i]);
+    }
+    table_destroy (t);
+
+    fprintf (stdout, "INFO: %d stations, a reading a minute each, best of %d, %lu keys nudged apart\n",
+        STATIONS, repeats, dups);
+    fprintf (stdout, "%12s %8s %8s %8s %8s %8s %8s %8s %8s %8s %8s %8s %s\n", "records",
+        "insert", "lookup", "miss", "remove", "range", "agg", "B/rec", "plookup", "pagg", "pB/rec", "ratio", "check");
+    for (n = min; n <= max; n *= 10) {
+        run (rows, n, repeats, &best);
+        failed += !best.ok;
+        fprintf (stdout, "%12lu %8.2f %8.2f %8.2f %8.2f %8.1f %8.1f %8.1f %8.2f %8.1f %8.2f %8.1f %s\n", n,
+            best.insert, best.lookup, best.miss, best.remove, best.range, best.aggregate,
+            best.bytes, best.packedLookup, best.packedAggregate, best.packedBytes, best.storeRatio,
+            best.ok ? "ok" : "FAIL");
+        fflush (stdout);
+        if (n > ULONG_MAX / 10) {
+            break;
+        }
+    }
+    fprintf (stdout, "INFO: Mops/s, range and agg in Mrows/s, B/rec is heap growth per record\n");
+    fprintf (stdout, "INFO: p columns after table_compress, pB/rec and ratio are store bytes per record\n");
+
+    free (rows);
+
+    return failed ? 1 : 0;
+}
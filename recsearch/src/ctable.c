@@ -0,0 +1,298 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <float.h>
+#include <sched.h>
+
+#include "ctable.h"
+
+/* low hash bits pick the shard, the tables index by the top bits */
+static shard *ctable_shard (ctable *self, key k) {
+    return &self->shards[key_hash (k) & (self->nshards - 1)];
+}
+
+static void ctable_writeBegin (shard *sh) {
+    pthread_mutex_lock (&sh->lock);
+    __atomic_store_n (&sh->seq, sh->seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence (__ATOMIC_RELEASE);
+}
+
+static void ctable_writeEnd (shard *sh) {
+    __atomic_store_n (&sh->seq, sh->seq + 1, __ATOMIC_RELEASE);
+    pthread_mutex_unlock (&sh->lock);
+}
+
+status ctable_insertRecord (ctable *self, record *r) {
+    shard *sh = ctable_shard (self, r->getKey(r));
+    status s;
+
+    ctable_writeBegin (sh);
+    s = table_insertRecord (sh->t, r);
+    ctable_writeEnd (sh);
+
+    return s;
+}
+
+status ctable_addRecord (ctable *self, record *r) {
+    status s = ctable_insertRecord (self, r);
+
+    if (s == STATUS_OK) {
+        record_destroy (&r);
+    }
+
+    return s;
+}
+
+status ctable_removeRecord (ctable *self, key k) {
+    shard *sh = ctable_shard (self, k);
+    status s;
+
+    ctable_writeBegin (sh);
+    s = table_removeRecord (sh->t, k);
+    ctable_writeEnd (sh);
+
+    return s;
+}
+
+/* copy the newest record with key k into out. The table's arrays and
+ * row are read into locals and only used once seq shows no writer ran
+ * meanwhile, a torn read is retried. Every field a writer may change
+ * is loaded through SHARED_LOAD, see shared.h */
+status ctable_findRecord (ctable *self, key k, record *out) {
+    shard *sh = ctable_shard (self, k);
+    table *t = sh->t;
+    slots cur, old;
+    sblock **blocks = NULL;
+    sblock *b = NULL;
+    unsigned long seq, nblocks, i;
+    rowid row;
+    long found;
+    int slot;
+    status s = STATUS_NOT_FOUND;
+
+    slot = epoch_enter (self->readers);
+    if (slot < 0) {
+        /* more reader threads than epoch slots */
+        pthread_mutex_lock (&sh->lock);
+        row = table_findRow (t, k);
+        if (row != NO_ROW) {
+            store_get (t->rows, row, out);
+            s = STATUS_OK;
+        }
+        pthread_mutex_unlock (&sh->lock);
+        return s;
+    }
+
+    for (;;) {
+        seq = __atomic_load_n (&sh->seq, __ATOMIC_ACQUIRE);
+        if (seq & 1) {
+            sched_yield ();
+            continue;
+        }
+        slots_copy (&cur, &t->cur);
+        slots_copy (&old, &t->old);
+        blocks = SHARED_LOAD (&t->rows->blocks);
+        nblocks = SHARED_LOAD (&t->rows->nblocks);
+        __atomic_thread_fence (__ATOMIC_ACQUIRE);
+        if (__atomic_load_n (&sh->seq, __ATOMIC_RELAXED) != seq) {
+            continue;
+        }
+
+        /* consistent snapshot, the arrays stay allocated until we exit */
+        s = STATUS_NOT_FOUND;
+        row = NO_ROW;
+        found = slots_lookup (&cur, k);
+        if (found >= 0) {
+            row = SHARED_LOAD (&cur.data[found].row);
+        } else if (old.data && (found = slots_lookup (&old, k)) >= 0) {
+            row = SHARED_LOAD (&old.data[found].row);
+        }
+        if (row != NO_ROW && STORE_BLOCK_OF (row) < nblocks) {
+            b = SHARED_LOAD (&blocks[STORE_BLOCK_OF (row)]);
+            i = STORE_OFFSET_OF (row);
+            out->id = SHARED_LOAD (&b->id[i]);
+            out->t = SHARED_LOAD (&b->t[i]);
+            out->temp = SHARED_LOAD (&b->temp[i]);
+            out->relhum = SHARED_LOAD (&b->relhum[i]);
+            out->asString = &record_asString;
+            out->getKey = &record_getKey;
+            s = STATUS_OK;
+        }
+
+        __atomic_thread_fence (__ATOMIC_ACQUIRE);
+        if (__atomic_load_n (&sh->seq, __ATOMIC_RELAXED) == seq) {
+            break;
+        }
+    }
+    epoch_exit (self->readers, slot);
+
+    return s;
+}
+
+/* time order holds within a shard, not across shards */
+unsigned long ctable_findRange (ctable *self, time_t from, time_t to, visitor visit, void *ctx) {
+    unsigned long i, n = 0;
+
+    for (i = 0; i < self->nshards; i++) {
+        pthread_mutex_lock (&self->shards[i].lock);
+        n += table_findRange (self->shards[i].t, from, to, visit, ctx);
+        pthread_mutex_unlock (&self->shards[i].lock);
+    }
+
+    return n;
+}
+
+/* add the groups of part into res, both aligned to multiples of bucket */
+static status ctable_merge (result *res, result *part, time_t bucket) {
+    aggregate *groups = NULL, *g = NULL, *p = NULL;
+    time_t base, last;
+    unsigned long n, i;
+
+    if (!part->ngroups) {
+        return STATUS_OK;
+    }
+    if (!res->ngroups) {
+        *res = *part;
+        memset (part, 0, sizeof (result));
+        return STATUS_OK;
+    }
+
+    base = res->groups[0].start < part->groups[0].start ? res->groups[0].start : part->groups[0].start;
+    last = res->groups[res->ngroups - 1].start;
+    if (part->groups[part->ngroups - 1].start > last) {
+        last = part->groups[part->ngroups - 1].start;
+    }
+    if (query_groups (base, last, bucket, &n) != STATUS_OK) {
+        return STATUS_UNKNOWN;
+    }
+    groups = calloc (n, sizeof (aggregate));
+    if (!groups) {
+        LOG_ERROR(("Out of memory (query groups)\n"));
+        return STATUS_MEMORY_ERROR;
+    }
+    for (i = 0; i < n; i++) {
+        groups[i].start = base + (time_t)i * bucket;
+        groups[i].min = DBL_MAX;
+        groups[i].max = -DBL_MAX;
+    }
+    for (i = 0; i < res->ngroups + part->ngroups; i++) {
+        p = i < res->ngroups ? &res->groups[i] : &part->groups[i - res->ngroups];
+        if (!p->count) {
+            continue;
+        }
+        g = bucket ? &groups[((unsigned long)p->start - (unsigned long)base) / (unsigned long)bucket] : groups;
+        g->count += p->count;
+        g->sum += p->sum;
+        g->min = p->min < g->min ? p->min : g->min;
+        g->max = p->max > g->max ? p->max : g->max;
+    }
+    for (i = 0; i < n; i++) {
+        if (groups[i].count) {
+            groups[i].mean = groups[i].sum / groups[i].count;
+        } else {
+            groups[i].min = groups[i].max = 0.0;
+        }
+    }
+    query_free (res);
+    res->groups = groups;
+    res->ngroups = n;
+    res->count += part->count;
+
+    return STATUS_OK;
+}
+
+/* run the query on every shard and merge the groups */
+status ctable_runQuery (ctable *self, query *q, result *res) {
+    result part;
+    unsigned long i;
+    status s = STATUS_OK;
+
+    memset (res, 0, sizeof (result));
+    for (i = 0; i < self->nshards && s == STATUS_OK; i++) {
+        pthread_mutex_lock (&self->shards[i].lock);
+        s = table_runQuery (self->shards[i].t, q, &part);
+        pthread_mutex_unlock (&self->shards[i].lock);
+        if (s == STATUS_OK) {
+            s = ctable_merge (res, &part, q->bucket);
+        }
+        query_free (&part);
+    }
+
+    return s;
+}
+
+unsigned long ctable_count (ctable *self) {
+    unsigned long i, n = 0;
+
+    for (i = 0; i < self->nshards; i++) {
+        n += __atomic_load_n (&self->shards[i].t->count, __ATOMIC_RELAXED);
+    }
+
+    return n;
+}
+
+ctable *ctable_new (unsigned long nshards) {
+    ctable *c = NULL;
+    unsigned long i;
+
+    if (!nshards) {
+        nshards = CTABLE_SHARDS;
+    }
+    /* round up to a power of 2 */
+    for (i = 1; i < nshards; i <<= 1) {
+    }
+    nshards = i;
+
+    c = calloc (1, sizeof (ctable));
+    if (!c) {
+        LOG_ERROR(("Out of memory (ctable)\n"));
+        return NULL;
+    }
+    c->readers = epoch_new ();
+    c->shards = aligned_alloc (64, nshards * sizeof (shard));
+    if (!c->readers || !c->shards) {
+        LOG_ERROR(("Out of memory (ctable shards)\n"));
+        if (c->readers) {
+            epoch_destroy (c->readers);
+        }
+        free (c->shards);
+        free (c);
+        return NULL;
+    }
+    memset (c->shards, 0, nshards * sizeof (shard));
+    c->nshards = nshards;
+    for (i = 0; i < nshards; i++) {
+        pthread_mutex_init (&c->shards[i].lock, NULL);
+        c->shards[i].t = table_new ();
+        if (!c->shards[i].t) {
+            c->nshards = i;
+            ctable_destroy (c);
+            return NULL;
+        }
+        c->shards[i].t->reclaim = &c->readers->reclaim;
+        c->shards[i].t->rows->reclaim = &c->readers->reclaim;
+    }
+
+    c->addRecord = &ctable_addRecord;
+    c->insertRecord = &ctable_insertRecord;
+    c->removeRecord = &ctable_removeRecord;
+    c->findRecord = &ctable_findRecord;
+    c->findRange = &ctable_findRange;
+    c->runQuery = &ctable_runQuery;
+    c->count = &ctable_count;
+
+    return c;
+}
+
+/* no other thread may use the table any more */
+void ctable_destroy (ctable *self) {
+    unsigned long i;
+
+    for (i = 0; i < self->nshards; i++) {
+        table_destroy (self->shards[i].t);
+        pthread_mutex_destroy (&self->shards[i].lock);
+    }
+    free (self->shards);
+    epoch_destroy (self->readers);
+    free (self);
+}
@@ -0,0 +1,49 @@
+#ifndef _CTABLE_H
+#define _CTABLE_H
+#include <pthread.h>
+#include "table.h"
+#include "epoch.h"
+
+/* default number of shards, a power of 2 */
+#define CTABLE_SHARDS 64
+
+typedef struct shard shard;
+
+/* one table per shard, writers take the lock and make seq odd while
+ * they change the table, one cache line apart from other shards */
+typedef struct shard {
+    pthread_mutex_t lock;
+    unsigned long seq;
+    table *t;
+} __attribute__((aligned(64))) shard;
+
+typedef struct ctable ctable;
+
+/* concurrent table: keys are spread over shards by their hash, writes
+ * lock one shard. findRecord does not lock: it reads the shard
+ * optimistically and retries if seq changed meanwhile, while arrays a
+ * writer replaces are only freed once no reader entered before, see
+ * epoch.h. Range scans and queries lock each shard in turn */
+typedef struct ctable {
+    shard *shards;
+    unsigned long nshards;
+    epoch *readers;
+    status (*addRecord) (ctable *self, record *r);
+    status (*insertRecord) (ctable *self, record *r);
+    status (*removeRecord) (ctable *self, key k);
+    status (*findRecord) (ctable *self, key k, record *out);
+    unsigned long (*findRange) (ctable *self, time_t from, time_t to, visitor visit, void *ctx);
+    status (*runQuery) (ctable *self, query *q, result *res);
+    unsigned long (*count) (ctable *self);
+} ctable;
+
+status ctable_addRecord (ctable *self, record *r);
+status ctable_insertRecord (ctable *self, record *r);
+status ctable_removeRecord (ctable *self, key k);
+status ctable_findRecord (ctable *self, key k, record *out);
+unsigned long ctable_findRange (ctable *self, time_t from, time_t to, visitor visit, void *ctx);
+status ctable_runQuery (ctable *self, query *q, result *res);
+unsigned long ctable_count (ctable *self);
+ctable *ctable_new (unsigned long nshards);
+void ctable_destroy (ctable *self);
+#endif
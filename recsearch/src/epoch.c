@@ -0,0 +1,162 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "epoch.h"
+
+/* reader slot of this thread, shared by every epoch */
+static __thread int threadSlot = -1;
+
+/* slots never handed out and slots of exited threads */
+static int nextSlot = 0;
+static int freeSlots[EPOCH_THREADS];
+static int nfree = 0;
+static pthread_mutex_t slotLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t slotKey;
+static pthread_once_t slotOnce = PTHREAD_ONCE_INIT;
+
+/* thread exit, the slot is idle in every epoch as each read exits */
+static void epoch_release (void *p) {
+    pthread_mutex_lock (&slotLock);
+    freeSlots[nfree] = (int)(long)p - 1;
+    __atomic_store_n (&nfree, nfree + 1, __ATOMIC_RELAXED);
+    pthread_mutex_unlock (&slotLock);
+}
+
+static void epoch_keyInit (void) {
+    if (pthread_key_create (&slotKey, &epoch_release)) {
+        LOG_ERROR(("Could not create epoch slot key\n"));
+    }
+}
+
+/* a free slot for this thread, -1 while every slot is taken */
+static int epoch_claim (void) {
+    int slot = -1;
+
+    /* checked without the lock so readers past the limit stay cheap */
+    if (__atomic_load_n (&nextSlot, __ATOMIC_RELAXED) >= EPOCH_THREADS &&
+            !__atomic_load_n (&nfree, __ATOMIC_RELAXED)) {
+        return -1;
+    }
+    pthread_once (&slotOnce, &epoch_keyInit);
+    pthread_mutex_lock (&slotLock);
+    /* counts are stored atomically for the unlocked check above */
+    if (nfree) {
+        slot = freeSlots[nfree - 1];
+        __atomic_store_n (&nfree, nfree - 1, __ATOMIC_RELAXED);
+    } else if (nextSlot < EPOCH_THREADS) {
+        slot = nextSlot;
+        __atomic_store_n (&nextSlot, nextSlot + 1, __ATOMIC_RELAXED);
+    }
+    pthread_mutex_unlock (&slotLock);
+    /* stored off by one, the destructor only runs for non NULL values */
+    if (slot >= 0 && pthread_setspecific (slotKey, (void *)(long)(slot + 1))) {
+        /* cannot hand it back on exit, keep it */
+        LOG_ERROR(("Could not register epoch slot %d\n", slot));
+    }
+
+    return slot;
+}
+
+/* enter a read side critical section, returns the slot to exit with or
+ * -1 when this thread has no slot and must read under a lock */
+int epoch_enter (epoch *self) {
+    if (threadSlot < 0) {
+        threadSlot = epoch_claim ();
+    }
+    if (threadSlot < 0) {
+        return -1;
+    }
+    /* seq_cst so the loads that follow cannot be seen before this */
+    __atomic_store_n (&self->slots[threadSlot].active,
+        __atomic_load_n (&self->global, __ATOMIC_SEQ_CST), __ATOMIC_SEQ_CST);
+
+    return threadSlot;
+}
+
+void epoch_exit (epoch *self, int slot) {
+    if (slot >= 0) {
+        __atomic_store_n (&self->slots[slot].active, 0, __ATOMIC_RELEASE);
+    }
+}
+
+/* free retired memory no reader can reach, caller holds the lock */
+static void epoch_free (epoch *self) {
+    unsigned long min = (unsigned long)-1, e;
+    retired **pp = &self->list, *r = NULL;
+    int i;
+
+    for (i = 0; i < EPOCH_THREADS; i++) {
+        e = __atomic_load_n (&self->slots[i].active, __ATOMIC_SEQ_CST);
+        if (e && e < min) {
+            min = e;
+        }
+    }
+    while ((r = *pp)) {
+        if (r->epoch < min) {
+            *pp = r->next;
+            free (r->p);
+            free (r);
+            self->pending--;
+        } else {
+            pp = &r->next;
+        }
+    }
+}
+
+/* reclaimer callback, p is already unreachable for new readers */
+void epoch_retire (void *ctx, void *p) {
+    epoch *self = (epoch *)ctx;
+    retired *r = malloc (sizeof (retired));
+
+    pthread_mutex_lock (&self->lock);
+    if (!r) {
+        /* cannot track it, leaking beats freeing under a reader */
+        LOG_ERROR(("Out of memory (epoch)\n"));
+        pthread_mutex_unlock (&self->lock);
+        return;
+    }
+    r->p = p;
+    r->epoch = __atomic_fetch_add (&self->global, 1, __ATOMIC_SEQ_CST);
+    r->next = self->list;
+    self->list = r;
+    if (++self->pending >= EPOCH_BATCH) {
+        epoch_free (self);
+    }
+    pthread_mutex_unlock (&self->lock);
+}
+
+void epoch_collect (epoch *self) {
+    pthread_mutex_lock (&self->lock);
+    epoch_free (self);
+    pthread_mutex_unlock (&self->lock);
+}
+
+epoch *epoch_new (void) {
+    epoch *e = calloc (1, sizeof (epoch));
+    if (!e) {
+        LOG_ERROR(("Out of memory (epoch)\n"));
+        return NULL;
+    }
+    /* 0 marks an idle reader */
+    e->global = 1;
+    pthread_mutex_init (&e->lock, NULL);
+    e->reclaim.retire = &epoch_retire;
+    e->reclaim.ctx = e;
+
+    return e;
+}
+
+/* no readers left, free everything */
+void epoch_destroy (epoch *self) {
+    retired *r = self->list, *next = NULL;
+
+    while (r) {
+        next = r->next;
+        free (r->p);
+        free (r);
+        r = next;
+    }
+    pthread_mutex_destroy (&self->lock);
+    free (self);
+}
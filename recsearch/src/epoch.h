@@ -0,0 +1,50 @@
+#ifndef _EPOCH_H
+#define _EPOCH_H
+#include <pthread.h>
+#include "slab.h"
+#include "log.h"
+
+/* reader threads tracked at once, a slot is reused once its thread
+ * exits, readers beyond fall back to locking */
+#define EPOCH_THREADS 128
+
+/* retired pointers kept before trying to free them */
+#define EPOCH_BATCH 16
+
+typedef struct retired retired;
+
+typedef struct retired {
+    void *p;
+    unsigned long epoch;
+    retired *next;
+} retired;
+
+typedef struct epochSlot epochSlot;
+
+/* epoch a reader entered at, 0 when outside, one cache line each */
+typedef struct epochSlot {
+    unsigned long active;
+    char pad[64 - sizeof (unsigned long)];
+} epochSlot;
+
+typedef struct epoch epoch;
+
+/* epoch based reclamation: readers publish the epoch they enter at,
+ * memory retired at epoch e is freed once every active reader entered
+ * after e, so no reader can still hold it */
+typedef struct epoch {
+    epochSlot slots[EPOCH_THREADS];
+    unsigned long global;
+    pthread_mutex_t lock;
+    retired *list;
+    unsigned long pending;
+    reclaimer reclaim;
+} epoch;
+
+epoch *epoch_new (void);
+int epoch_enter (epoch *self);
+void epoch_exit (epoch *self, int slot);
+void epoch_retire (void *ctx, void *p);
+void epoch_collect (epoch *self);
+void epoch_destroy (epoch *self);
+#endif
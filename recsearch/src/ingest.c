@@ -0,0 +1,520 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "ingest.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define SIMDTARGET __attribute__((target("avx2")))
+#endif
+
+/* most significant digits a double holds exactly, 2^53 */
+#define EXACT_MANTISSA (1UL << 53)
+/* largest power of 10 a double holds exactly */
+#define EXACT_POW10 22
+
+static const double pow10s[EXACT_POW10 + 1] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/* whole field as a decimal integer, returns 0 if it is not one */
+int ingest_parseLong (const char *p, const char *end, long *out) {
+    unsigned long v = 0;
+    int neg = 0, digits = 0;
+
+    if (p < end && (*p == '-' || *p == '+')) {
+        neg = *p++ == '-';
+    }
+    for (; p < end && *p >= '0' && *p <= '9'; p++, digits++) {
+        v = v * 10 + (*p - '0');
+    }
+    /* 18 digits cannot overflow */
+    if (p != end || !digits || digits > 18) {
+        return 0;
+    }
+    *out = neg ? -(long)v : (long)v;
+
+    return 1;
+}
+
+/* whole field as a double. Plain decimals with up to 15 digits or so
+ * are one integer division by an exact power of 10, which rounds
+ * correctly because both operands are exact, anything else goes to
+ * strtod */
+int ingest_parseDouble (const char *p, const char *end, double *out) {
+    const char *start = p;
+    char buf[64], *stop = NULL;
+    unsigned long m = 0;
+    int neg = 0, digits = 0, frac = 0;
+
+    if (p < end && (*p == '-' || *p == '+')) {
+        neg = *p++ == '-';
+    }
+    for (; p < end && *p >= '0' && *p <= '9'; p++, digits++) {
+        m = m * 10 + (*p - '0');
+    }
+    if (p < end && *p == '.') {
+        for (p++; p < end && *p >= '0' && *p <= '9'; p++, frac++) {
+            m = m * 10 + (*p - '0');
+        }
+    }
+    if (!digits && !frac) {
+        return 0;
+    }
+    if (p == end && digits + frac <= 19 && m < EXACT_MANTISSA && frac <= EXACT_POW10) {
+        *out = neg ? -(m / pow10s[frac]) : m / pow10s[frac];
+        return 1;
+    }
+
+    /* exponent or long mantissa */
+    if (end - start >= (long)sizeof (buf)) {
+        return 0;
+    }
+    memcpy (buf, start, end - start);
+    buf[end - start] = '\0';
+    *out = strtod (buf, &stop);
+
+    return *stop == '\0';
+}
+
+typedef struct scanner scanner;
+
+/* finds ',' and '\n' 64 bytes at a time, one bit per byte */
+typedef struct scanner {
+    const char *p;
+    const char *end;
+    unsigned long mask;
+    int simd;
+} scanner;
+
+static unsigned long scan_maskScalar (const char *p, long n) {
+    unsigned long mask = 0;
+    long i;
+
+    for (i = 0; i < n; i++) {
+        if (p[i] == ',' || p[i] == '\n') {
+            mask |= 1UL << i;
+        }
+    }
+
+    return mask;
+}
+
+#if defined(__x86_64__)
+SIMDTARGET
+static unsigned long scan_maskAVX2 (const char *p) {
+    __m256i comma = _mm256_set1_epi8 (','), nl = _mm256_set1_epi8 ('\n');
+    __m256i lo = _mm256_loadu_si256 ((const __m256i *)p);
+    __m256i hi = _mm256_loadu_si256 ((const __m256i *)(p + 32));
+    unsigned int mlo = _mm256_movemask_epi8 (_mm256_or_si256 (
+        _mm256_cmpeq_epi8 (lo, comma), _mm256_cmpeq_epi8 (lo, nl)));
+    unsigned int mhi = _mm256_movemask_epi8 (_mm256_or_si256 (
+        _mm256_cmpeq_epi8 (hi, comma), _mm256_cmpeq_epi8 (hi, nl)));
+
+    return (unsigned long)mlo | ((unsigned long)mhi << 32);
+}
+#endif
+
+static unsigned long scan_block (scanner *s) {
+    long n = s->end - s->p;
+
+#if defined(__x86_64__)
+    if (s->simd && n >= 64) {
+        return scan_maskAVX2 (s->p);
+    }
+#endif
+
+    return scan_maskScalar (s->p, n < 64 ? n : 64);
+}
+
+static void scan_init (scanner *s, const char *p, const char *end, int simd) {
+    s->p = p;
+    s->end = end;
+    s->simd = simd;
+    s->mask = p < end ? scan_block (s) : 0;
+}
+
+/* next delimiter, NULL at the end of the input */
+static const char *scan_next (scanner *s) {
+    int i;
+
+    while (!s->mask) {
+        s->p += 64;
+        if (s->p >= s->end) {
+            return NULL;
+        }
+        s->mask = scan_block (s);
+    }
+    i = __builtin_ctzl (s->mask);
+    s->mask &= s->mask - 1;
+
+    return s->p + i;
+}
+
+/* grow every column to capacity. A column that grew is kept even if a
+ * later one fails, the capacity only moves once all four have */
+static status batch_grow (batch *b, unsigned long capacity) {
+    int *id = NULL;
+    time_t *t = NULL;
+    double *temp = NULL, *relhum = NULL;
+
+    if (!(id = realloc (b->id, capacity * sizeof (int)))) {
+        goto fail;
+    }
+    b->id = id;
+    if (!(t = realloc (b->t, capacity * sizeof (time_t)))) {
+        goto fail;
+    }
+    b->t = t;
+    if (!(temp = realloc (b->temp, capacity * sizeof (double)))) {
+        goto fail;
+    }
+    b->temp = temp;
+    if (!(relhum = realloc (b->relhum, capacity * sizeof (double)))) {
+        goto fail;
+    }
+    b->relhum = relhum;
+    b->capacity = capacity;
+
+    return STATUS_OK;
+
+fail:
+    LOG_ERROR(("Out of memory (batch)\n"));
+    return STATUS_MEMORY_ERROR;
+}
+
+static status batch_push (batch *b, long id, long t, double temp, double relhum) {
+    if (b->count == b->capacity && batch_grow (b, b->capacity ? 2 * b->capacity : 4096) != STATUS_OK) {
+        return STATUS_MEMORY_ERROR;
+    }
+    b->id[b->count] = (int)id;
+    b->t[b->count] = t;
+    b->temp[b->count] = temp;
+    b->relhum[b->count] = relhum;
+    b->count++;
+
+    return STATUS_OK;
+}
+
+/* id,t,temp,relhum lines, blank lines skipped, bad ones counted */
+static status ingest_parseCSV (ingest *in, const char *p, const char *end, batch *b) {
+    const char *from[4], *to[4];
+    const char *line = p, *start = NULL, *d = NULL, *stop = NULL;
+    scanner s;
+    long id, t;
+    double temp, relhum;
+    int nf;
+
+    scan_init (&s, p, end, in->simd);
+    for (;;) {
+        nf = 0;
+        start = line;
+        do {
+            d = scan_next (&s);
+            stop = d ? d : end;
+            if (nf < 4) {
+                from[nf] = start;
+                to[nf] = stop;
+            }
+            nf++;
+            start = stop + 1;
+        } while (d && *d == ',');
+
+        if (nf == 4 && to[3] > from[3] && to[3][-1] == '\r') {
+            to[3]--;
+        }
+        if (stop > line && !(stop == line + 1 && *line == '\r')) {
+            if (nf == 4 &&
+                    ingest_parseLong (from[0], to[0], &id) && id >= INT_MIN && id <= INT_MAX &&
+                    ingest_parseLong (from[1], to[1], &t) &&
+                    ingest_parseDouble (from[2], to[2], &temp) &&
+                    ingest_parseDouble (from[3], to[3], &relhum)) {
+                if (batch_push (b, id, t, temp, relhum) != STATUS_OK) {
+                    return STATUS_MEMORY_ERROR;
+                }
+            }
+            else {
+                b->bad++;
+            }
+        }
+        if (!d) {
+            break;
+        }
+        line = d + 1;
+    }
+
+    return STATUS_OK;
+}
+
+static status ingest_insertBatch (ingest *in, batch *b) {
+    record r;
+    unsigned long i;
+
+    for (i = 0; i < b->count; i++) {
+        record_init (&r, b->id[i], b->t[i], b->temp[i], b->relhum[i]);
+        if (table_insertRecord (in->t, &r) != STATUS_OK) {
+            return STATUS_MEMORY_ERROR;
+        }
+    }
+
+    return STATUS_OK;
+}
+
+/* binary rows are already fields, they go in straight from the map */
+static status ingest_insertPacked (ingest *in, const char *p, const char *end, unsigned long *rows) {
+    packedRow row;
+    record r;
+
+    for (; p + sizeof (packedRow) <= end; p += sizeof (packedRow)) {
+        memcpy (&row, p, sizeof (packedRow));
+        record_init (&r, row.id, row.t, row.temp, row.relhum);
+        if (table_insertRecord (in->t, &r) != STATUS_OK) {
+            return STATUS_MEMORY_ERROR;
+        }
+        (*rows)++;
+    }
+
+    return STATUS_OK;
+}
+
+static void *ingest_worker (void *arg) {
+    ingest *in = (ingest *)arg;
+    batch b;
+    unsigned long k, rows;
+    const char *from = NULL, *to = NULL;
+    status s;
+
+    memset (&b, 0, sizeof (batch));
+    for (;;) {
+        k = __atomic_fetch_add (&in->next, 1, __ATOMIC_RELAXED);
+        if (k >= in->nchunks) {
+            break;
+        }
+        from = in->data + in->cuts[k];
+        to = in->data + in->cuts[k + 1];
+        b.count = b.bad = 0;
+        rows = 0;
+        s = in->format == INGEST_CSV ? ingest_parseCSV (in, from, to, &b) : STATUS_OK;
+
+        /* chunks go into the table in input order */
+        pthread_mutex_lock (&in->lock);
+        while (in->turn != k) {
+            pthread_cond_wait (&in->done, &in->lock);
+        }
+        pthread_mutex_unlock (&in->lock);
+
+        if (s == STATUS_OK && in->error == STATUS_OK) {
+            if (in->format == INGEST_CSV) {
+                s = ingest_insertBatch (in, &b);
+                rows = b.count;
+            }
+            else {
+                s = ingest_insertPacked (in, from, to, &rows);
+            }
+        }
+
+        pthread_mutex_lock (&in->lock);
+        if (s != STATUS_OK && in->error == STATUS_OK) {
+            in->error = s;
+        }
+        in->stats.rows += rows;
+        in->stats.bad += b.bad;
+        in->turn++;
+        pthread_cond_broadcast (&in->done);
+        pthread_mutex_unlock (&in->lock);
+    }
+    free (b.id);
+    free (b.t);
+    free (b.temp);
+    free (b.relhum);
+
+    return NULL;
+}
+
+/* chunk boundaries from start on, CSV chunks end after a newline and
+ * binary ones after a whole row */
+static status ingest_cut (ingest *in, unsigned long start) {
+    unsigned long n = (in->size - start + INGEST_CHUNK - 1) / INGEST_CHUNK;
+    unsigned long step = INGEST_CHUNK, pos, k;
+    const char *nl = NULL;
+
+    in->cuts = malloc ((n + 1) * sizeof (unsigned long));
+    if (!in->cuts) {
+        LOG_ERROR(("Out of memory (ingest chunks)\n"));
+        return STATUS_MEMORY_ERROR;
+    }
+    if (in->format == INGEST_BINARY) {
+        step -= step % sizeof (packedRow);
+    }
+    in->cuts[0] = start;
+    for (k = 1; in->cuts[k - 1] < in->size; k++) {
+        pos = start + k * step;
+        if (pos <= in->cuts[k - 1]) {
+            pos = in->cuts[k - 1] + 1;
+        }
+        if (pos >= in->size) {
+            pos = in->size;
+        }
+        else if (in->format == INGEST_CSV) {
+            nl = memchr (in->data + pos - 1, '\n', in->size - pos + 1);
+            pos = nl ? (unsigned long)(nl - in->data) + 1 : in->size;
+        }
+        in->cuts[k] = pos;
+    }
+    in->nchunks = k - 1;
+
+    return STATUS_OK;
+}
+
+static double ingest_now (void) {
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* load a CSV or binary file into t with nthreads parsers, 0 for the
+ * default. A CSV header line is skipped */
+status ingest_file (table *t, const char *path, int format, int nthreads, ingestStats *stats) {
+    ingest in;
+    pthread_t threads[64];
+    binHeader *h = NULL;
+    const char *nl = NULL;
+    struct stat st;
+    void *map = MAP_FAILED;
+    unsigned long start = 0;
+    double started = ingest_now ();
+    int fd, i, n = 0;
+
+    memset (&in, 0, sizeof (ingest));
+    fd = open (path, O_RDONLY);
+    if (fd < 0 || fstat (fd, &st) < 0) {
+        LOG_ERROR(("Could not open %s: %s\n", path, strerror (errno)));
+        if (fd >= 0) {
+            close (fd);
+        }
+        return STATUS_UNKNOWN;
+    }
+    in.t = t;
+    in.format = format;
+    in.size = st.st_size;
+    in.simd = query_simd ();
+    in.error = STATUS_OK;
+    pthread_mutex_init (&in.lock, NULL);
+    pthread_cond_init (&in.done, NULL);
+
+    if (in.size) {
+        map = mmap (NULL, in.size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map == MAP_FAILED) {
+            LOG_ERROR(("Could not map %s: %s\n", path, strerror (errno)));
+            in.error = STATUS_UNKNOWN;
+            goto done;
+        }
+        madvise (map, in.size, MADV_SEQUENTIAL);
+        in.data = (const char *)map;
+    }
+
+    if (format == INGEST_BINARY) {
+        h = (binHeader *)map;
+        if (in.size < sizeof (binHeader) || memcmp (h->magic, INGEST_MAGIC, sizeof (h->magic)) ||
+                in.size < sizeof (binHeader) + h->count * sizeof (packedRow)) {
+            LOG_ERROR(("%s is not a record file\n", path));
+            in.error = STATUS_UNKNOWN;
+            goto done;
+        }
+        start = sizeof (binHeader);
+        in.size = start + h->count * sizeof (packedRow);
+        table_reserve (t, h->count);
+    }
+    else if (in.size && !(in.data[0] == '-' || in.data[0] == '+' || (in.data[0] >= '0' && in.data[0] <= '9'))) {
+        /* header line */
+        nl = memchr (in.data, '\n', in.size);
+        start = nl ? (unsigned long)(nl - in.data) + 1 : in.size;
+    }
+
+    if ((in.error = ingest_cut (&in, start)) != STATUS_OK) {
+        goto done;
+    }
+    if (nthreads <= 0) {
+        nthreads = INGEST_THREADS;
+    }
+    if ((unsigned long)nthreads > in.nchunks) {
+        nthreads = (int)in.nchunks;
+    }
+    if (nthreads > (int)(sizeof (threads) / sizeof (threads[0]))) {
+        nthreads = sizeof (threads) / sizeof (threads[0]);
+    }
+    for (n = 0; n < nthreads; n++) {
+        if (pthread_create (&threads[n], NULL, &ingest_worker, &in)) {
+            break;
+        }
+    }
+    if (!n && in.nchunks) {
+        /* no threads, parse here */
+        ingest_worker (&in);
+    }
+    for (i = 0; i < n; i++) {
+        pthread_join (threads[i], NULL);
+    }
+
+    in.stats.bytes = in.size - start;
+    in.stats.seconds = ingest_now () - started;
+    in.stats.rowsPerSecond = in.stats.seconds > 0.0 ? in.stats.rows / in.stats.seconds : 0.0;
+    LOG_INFO(("Ingested %lu rows from %s in %.2fs, %.0f rows/s, %lu bad lines\n",
+        in.stats.rows, path, in.stats.seconds, in.stats.rowsPerSecond, in.stats.bad));
+
+done:
+    if (stats) {
+        *stats = in.stats;
+    }
+    if (map != MAP_FAILED) {
+        munmap (map, st.st_size);
+    }
+    close (fd);
+    free (in.cuts);
+    pthread_mutex_destroy (&in.lock);
+    pthread_cond_destroy (&in.done);
+
+    return in.error;
+}
+
+/* write records in the binary input format */
+status ingest_writeBinary (const char *path, record *rows, unsigned long count) {
+    FILE *f = fopen (path, "wb");
+    binHeader h;
+    packedRow row;
+    unsigned long i;
+    int ok = 1;
+
+    if (!f) {
+        LOG_ERROR(("Could not create %s: %s\n", path, strerror (errno)));
+        return STATUS_UNKNOWN;
+    }
+    memset (&h, 0, sizeof (binHeader));
+    memcpy (h.magic, INGEST_MAGIC, sizeof (h.magic));
+    h.count = count;
+    ok = fwrite (&h, sizeof (binHeader), 1, f) == 1;
+    memset (&row, 0, sizeof (packedRow));
+    for (i = 0; ok && i < count; i++) {
+        row.t = rows[i].t;
+        row.temp = rows[i].temp;
+        row.relhum = rows[i].relhum;
+        row.id = rows[i].id;
+        ok = fwrite (&row, sizeof (packedRow), 1, f) == 1;
+    }
+    if (fclose (f) != 0 || !ok) {
+        LOG_ERROR(("Could not write %s\n", path));
+        return STATUS_UNKNOWN;
+    }
+
+    return STATUS_OK;
+}
@@ -0,0 +1,85 @@
+#ifndef _INGEST_H
+#define _INGEST_H
+#include <pthread.h>
+#include "table.h"
+
+#define INGEST_CSV 0
+#define INGEST_BINARY 1
+
+/* bytes of input per task, cut at a line or row boundary */
+#define INGEST_CHUNK (4UL << 20)
+
+/* parser threads when none are given */
+#define INGEST_THREADS 4
+
+#define INGEST_MAGIC "RECBIN01"
+
+typedef struct binHeader binHeader;
+
+/* binary input: this header then count packed rows, host byte order */
+typedef struct binHeader {
+    char magic[8];
+    unsigned long count;
+} binHeader;
+
+typedef struct packedRow packedRow;
+
+typedef struct packedRow {
+    time_t t;
+    double temp;
+    double relhum;
+    int id;
+    int pad;
+} packedRow;
+
+typedef struct ingestStats ingestStats;
+
+typedef struct ingestStats {
+    unsigned long rows;
+    /* lines that did not parse, skipped */
+    unsigned long bad;
+    unsigned long bytes;
+    double seconds;
+    double rowsPerSecond;
+} ingestStats;
+
+typedef struct batch batch;
+
+/* rows parsed from one chunk, by column */
+typedef struct batch {
+    int *id;
+    time_t *t;
+    double *temp;
+    double *relhum;
+    unsigned long count;
+    unsigned long capacity;
+    unsigned long bad;
+} batch;
+
+typedef struct ingest ingest;
+
+/* input is mapped and cut into chunks that threads take in order and
+ * parse into batches, which go into the table one at a time in input
+ * order, so later rows with the same key win as with addRecord */
+typedef struct ingest {
+    table *t;
+    int format;
+    const char *data;
+    unsigned long size;
+    /* chunk k is data[cuts[k]..cuts[k + 1]) */
+    unsigned long *cuts;
+    unsigned long nchunks;
+    unsigned long next;
+    unsigned long turn;
+    status error;
+    int simd;
+    pthread_mutex_t lock;
+    pthread_cond_t done;
+    ingestStats stats;
+} ingest;
+
+int ingest_parseLong (const char *p, const char *end, long *out);
+int ingest_parseDouble (const char *p, const char *end, double *out);
+status ingest_file (table *t, const char *path, int format, int nthreads, ingestStats *stats);
+status ingest_writeBinary (const char *path, record *rows, unsigned long count);
+#endif
@@ -0,0 +1,551 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#include "pack.h"
+#include "store.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define SIMDTARGET __attribute__((target("avx2")))
+#endif
+
+/* unpacking reads a whole word past the last value */
+#define PACK_PADDING 8
+
+/* widest values the gather kernel unpacks, 7 bit shift + 25 = 32 */
+#define PACK_GATHER_BITS 25
+
+static inline int pack_fits (long v) {
+    return v >= INT_MIN && v <= INT_MAX;
+}
+
+/* differences of x, relative to base, for a lag or delta of delta. 0
+ * if any does not fit 32 bits */
+static int pack_diff (const long *x, int lag, long *y, int *delta) {
+    long d, prev = 0;
+    int j;
+
+    y[0] = 0;
+    *delta = 0;
+    for (j = 1; j < PACK_GROUP; j++) {
+        if (lag == PACK_DOD) {
+            d = x[j] - x[j - 1];
+            if (!pack_fits (d)) {
+                return 0;
+            }
+            y[j] = j == 1 ? 0 : d - prev;
+            if (j == 1) {
+                *delta = (int)d;
+            }
+            prev = d;
+        }
+        else {
+            y[j] = x[j] - (j < lag ? x[0] : x[j - lag]);
+        }
+        if (!pack_fits (y[j])) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+static unsigned int pack_width (unsigned long range) {
+    return range ? 64 - __builtin_clzl (range) : 0;
+}
+
+/* values ahead of the tail */
+static inline int pack_head (const pgroup *g) {
+    return g->lag >= PACK_MIN_LAG ? g->lag : 0;
+}
+
+static inline unsigned long pack_headBytes (const pgroup *g) {
+    return ((unsigned long)pack_head (g) * g->headBits + 7) / 8;
+}
+
+/* bytes of the packed values of one group */
+static inline unsigned long pack_valueBytes (const pgroup *g) {
+    return pack_headBytes (g) + ((unsigned long)(PACK_GROUP - pack_head (g)) * g->bits + 7) / 8;
+}
+
+/* ints per checkpoint */
+static inline int pack_checkpoint (const pgroup *g) {
+    return g->lag == PACK_DOD ? 2 : g->lag == 1 ? 1 : 0;
+}
+
+/* bytes of one group, checkpoints included */
+static inline unsigned long pack_bytes (const pgroup *g) {
+    return pack_valueBytes (g) + (PACK_FRAMES - 1) * pack_checkpoint (g) * sizeof (int);
+}
+
+/* checkpoints of the group at x after its values */
+static void pack_writeFrames (unsigned char *out, const pgroup *g, const long *x) {
+    int cp[2];
+    int k, s;
+
+    for (k = 1; k < PACK_FRAMES; k++) {
+        s = k * PACK_FRAME;
+        cp[0] = (int)(x[s] - x[0]);
+        cp[1] = (int)(x[s] - x[s - 1]);
+        memcpy (out, cp, pack_checkpoint (g) * sizeof (int));
+        out += pack_checkpoint (g) * sizeof (int);
+    }
+}
+
+/* smallest value and bits of the range of y[from..to) */
+static unsigned int pack_range (const long *y, int from, int to, long *lo) {
+    long hi;
+    int j;
+
+    if (from >= to) {
+        *lo = 0;
+        return 0;
+    }
+    *lo = hi = y[from];
+    for (j = from + 1; j < to; j++) {
+        *lo = y[j] < *lo ? y[j] : *lo;
+        hi = y[j] > hi ? y[j] : hi;
+    }
+
+    return pack_width ((unsigned long)(hi - *lo));
+}
+
+/* pick the narrowest difference for one group of a column, its values
+ * less their ref go to v */
+static int pack_group (const long *x, pgroup *g, unsigned int *v) {
+    long y[PACK_GROUP], lo, headLo;
+    unsigned long cost, best = ULONG_MAX;
+    unsigned int bits, headBits;
+    int lag, head, delta, j;
+
+    /* decoding sums in 32 bits relative to the base */
+    for (j = 1; j < PACK_GROUP; j++) {
+        if (!pack_fits (x[j] - x[0])) {
+            return 0;
+        }
+    }
+    g->base = x[0];
+    for (lag = PACK_DOD; lag <= PACK_MAX_LAG; lag = lag == 1 ? PACK_MIN_LAG : lag + 1) {
+        if (!pack_diff (x, lag, y, &delta)) {
+            continue;
+        }
+        head = lag >= PACK_MIN_LAG ? lag : 0;
+        headBits = pack_range (y, 0, head, &headLo);
+        bits = pack_range (y, head, PACK_GROUP, &lo);
+        if (bits > 32 || headBits > 32) {
+            continue;
+        }
+        cost = (unsigned long)head * headBits + (unsigned long)(PACK_GROUP - head) * bits;
+        if (cost < best) {
+            best = cost;
+            g->lag = (unsigned char)lag;
+            g->ref = (int)lo;
+            g->headRef = (int)headLo;
+            g->bits = (unsigned char)bits;
+            g->headBits = (unsigned char)headBits;
+            g->delta = delta;
+            for (j = 0; j < PACK_GROUP; j++) {
+                v[j] = (unsigned int)(y[j] - (j < head ? headLo : lo));
+            }
+        }
+    }
+
+    return best != ULONG_MAX;
+}
+
+static unsigned char *pack_write (unsigned char *out, const unsigned int *v, int count, unsigned int bits) {
+    unsigned long acc = 0;
+    int n = 0, j;
+
+    for (j = 0; j < count; j++) {
+        acc |= (unsigned long)v[j] << n;
+        n += bits;
+        while (n >= 8) {
+            *out++ = (unsigned char)acc;
+            acc >>= 8;
+            n -= 8;
+        }
+    }
+    if (n) {
+        *out++ = (unsigned char)acc;
+    }
+
+    return out;
+}
+
+/* compress a full block, NULL when a difference does not fit 32 bits or
+ * out of memory, the block then stays as it is */
+pblock *pblock_encode (const sblock *b) {
+    long *cols = malloc (PACK_COLUMNS * PACK_ROWS * sizeof (long));
+    unsigned int *v = malloc (PACK_COLUMNS * PACK_ROWS * sizeof (unsigned int));
+    pblock *p = NULL;
+    pgroup groups[PACK_COLUMNS][PACK_GROUPS], *pg = NULL;
+    unsigned char *out = NULL;
+    unsigned long size = 0, i, r, first;
+    int c, g;
+
+    if (!cols || !v) {
+        LOG_ERROR(("Out of memory (pack)\n"));
+        goto done;
+    }
+
+    /* removed rows repeat the previous live one, or the first */
+    for (first = 0; first < PACK_ROWS && !b->live[first]; first++) {
+    }
+    for (i = 0; i < PACK_ROWS; i++) {
+        if (!b->live[i] && first < i) {
+            for (c = 0; c < PACK_COLUMNS; c++) {
+                cols[c * PACK_ROWS + i] = cols[c * PACK_ROWS + i - 1];
+            }
+            continue;
+        }
+        r = b->live[i] || first == PACK_ROWS ? i : first;
+        cols[PACK_ID * PACK_ROWS + i] = b->id[r];
+        cols[PACK_T * PACK_ROWS + i] = b->t[r];
+        cols[PACK_TEMP * PACK_ROWS + i] = getScaledMeasurement (b->temp[r]);
+        cols[PACK_RELHUM * PACK_ROWS + i] = getScaledMeasurement (b->relhum[r]);
+    }
+
+    for (c = 0; c < PACK_COLUMNS; c++) {
+        for (g = 0; g < PACK_GROUPS; g++) {
+            i = c * PACK_ROWS + g * PACK_GROUP;
+            if (!pack_group (&cols[i], &groups[c][g], &v[i])) {
+                goto done;
+            }
+            groups[c][g].offset = size;
+            size += pack_bytes (&groups[c][g]);
+        }
+    }
+
+    p = malloc (sizeof (pblock) + size + PACK_PADDING);
+    if (!p) {
+        LOG_ERROR(("Out of memory (pack)\n"));
+        goto done;
+    }
+    p->tmin = b->tmin;
+    p->tmax = b->tmax;
+    p->size = size;
+    memcpy (p->groups, groups, sizeof (groups));
+    memset (p->live, 0, sizeof (p->live));
+    for (i = 0; i < PACK_ROWS; i++) {
+        p->live[i / 8] |= (b->live[i] != 0) << (i % 8);
+    }
+    memset (p->data + size, 0, PACK_PADDING);
+    for (c = 0; c < PACK_COLUMNS; c++) {
+        for (g = 0; g < PACK_GROUPS; g++) {
+            pg = &groups[c][g];
+            i = c * PACK_ROWS + g * PACK_GROUP;
+            out = pack_write (p->data + pg->offset, &v[i], pack_head (pg), pg->headBits);
+            out = pack_write (out, &v[i + pack_head (pg)], PACK_GROUP - pack_head (pg), pg->bits);
+            pack_writeFrames (out, pg, &cols[i]);
+        }
+    }
+
+done:
+    free (cols);
+    free (v);
+
+    return p;
+}
+
+/* values from..n of a packed run */
+static void pack_readScalar (const unsigned char *in, unsigned int bits, int *v, int from, int n) {
+    unsigned long w, mask = (1UL << bits) - 1, o;
+    int j;
+
+    for (j = from, o = (unsigned long)from * bits; j < n; j++, o += bits) {
+        memcpy (&w, in + (o >> 3), sizeof (w));
+        v[j] = (int)((w >> (o & 7)) & mask);
+    }
+}
+
+/* running sum of v + add */
+static void pack_prefixScalar (const int *v, int add, int *out) {
+    int x = 0, j;
+
+    for (j = 0; j < PACK_GROUP; j++) {
+        x += v[j] + add;
+        out[j] = x;
+    }
+}
+
+static void pack_lagScalar (const int *v, int headAdd, int add, int lag, int from, int *out) {
+    int j;
+
+    for (j = from; j < PACK_GROUP; j++) {
+        out[j] = j < lag ? v[j] + headAdd : out[j - lag] + v[j] + add;
+    }
+}
+
+#if defined(__x86_64__)
+
+/* 8 values per step: each lane gathers the word holding its value and
+ * shifts it down */
+SIMDTARGET
+static void pack_readAVX2 (const unsigned char *in, unsigned int bits, int *v, int n) {
+    const __m256i mask = _mm256_set1_epi32 ((int)((1U << bits) - 1));
+    const __m256i step = _mm256_set1_epi32 (8 * bits);
+    const __m256i seven = _mm256_set1_epi32 (7);
+    __m256i off = _mm256_mullo_epi32 (_mm256_setr_epi32 (0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32 (bits));
+    __m256i w;
+    int j;
+
+    for (j = 0; j + 8 <= n; j += 8) {
+        w = _mm256_i32gather_epi32 ((const int *)in, _mm256_srli_epi32 (off, 3), 1);
+        w = _mm256_and_si256 (_mm256_srlv_epi32 (w, _mm256_and_si256 (off, seven)), mask);
+        _mm256_storeu_si256 ((__m256i *)&v[j], w);
+        off = _mm256_add_epi32 (off, step);
+    }
+    pack_readScalar (in, bits, v, j, n);
+}
+
+/* prefix sums within each 128 bit lane, then the low lane's total into
+ * the high lane, then the total of earlier steps */
+SIMDTARGET
+static void pack_prefixAVX2 (const int *v, int add, int *out) {
+    const __m256i last = _mm256_set1_epi32 (7);
+    const __m256i a = _mm256_set1_epi32 (add);
+    __m256i carry = _mm256_setzero_si256 (), x;
+    int j;
+
+    for (j = 0; j < PACK_GROUP; j += 8) {
+        x = _mm256_add_epi32 (_mm256_loadu_si256 ((const __m256i *)&v[j]), a);
+        x = _mm256_add_epi32 (x, _mm256_slli_si256 (x, 4));
+        x = _mm256_add_epi32 (x, _mm256_slli_si256 (x, 8));
+        x = _mm256_add_epi32 (x, _mm256_shuffle_epi32 (_mm256_permute2x128_si256 (x, x, 0x08), 0xff));
+        x = _mm256_add_epi32 (x, carry);
+        _mm256_storeu_si256 ((__m256i *)&out[j], x);
+        carry = _mm256_permutevar8x32_epi32 (x, last);
+    }
+}
+
+/* a lag of at least 8 leaves the 8 lanes independent */
+SIMDTARGET
+static void pack_lagAVX2 (const int *v, int headAdd, int add, int lag, int *out) {
+    const __m256i a = _mm256_set1_epi32 (add);
+    int j;
+
+    for (j = 0; j < lag; j++) {
+        out[j] = v[j] + headAdd;
+    }
+    for (j = lag; j + 8 <= PACK_GROUP; j += 8) {
+        _mm256_storeu_si256 ((__m256i *)&out[j], _mm256_add_epi32 (
+            _mm256_loadu_si256 ((const __m256i *)&out[j - lag]),
+            _mm256_add_epi32 (_mm256_loadu_si256 ((const __m256i *)&v[j]), a)));
+    }
+    pack_lagScalar (v, headAdd, add, lag, j, out);
+}
+
+SIMDTARGET
+static void pack_scaleAVX2 (const int *x, int base, double *out) {
+    const __m256d scale = _mm256_set1_pd (PRECISION_SCALE);
+    const __m128i b = _mm_set1_epi32 (base);
+    int j;
+
+    for (j = 0; j < PACK_GROUP; j += 4) {
+        _mm256_storeu_pd (&out[j], _mm256_div_pd (_mm256_cvtepi32_pd (
+            _mm_add_epi32 (_mm_loadu_si128 ((const __m128i *)&x[j]), b)), scale));
+    }
+}
+
+#endif
+
+static void pack_read (const unsigned char *in, unsigned int bits, int *v, int n, int simd) {
+    if (!bits) {
+        memset (v, 0, n * sizeof (int));
+    }
+#if defined(__x86_64__)
+    else if (simd && bits <= PACK_GATHER_BITS) {
+        pack_readAVX2 (in, bits, v, n);
+    }
+#endif
+    else {
+        pack_readScalar (in, bits, v, 0, n);
+    }
+}
+
+static void pack_prefix (const int *v, int add, int *out, int simd) {
+#if defined(__x86_64__)
+    if (simd) {
+        pack_prefixAVX2 (v, add, out);
+        return;
+    }
+#endif
+    pack_prefixScalar (v, add, out);
+}
+
+/* values of one group relative to its base */
+static void pack_column (const pblock *p, int c, int g, int *rel, int simd) {
+    const pgroup *pg = &p->groups[c][g];
+    const unsigned char *in = p->data + pg->offset;
+    int v[PACK_GROUP], d[PACK_GROUP];
+    int head = pack_head (pg);
+
+    pack_read (in, pg->headBits, v, head, simd);
+    pack_read (in + pack_headBytes (pg), pg->bits, v + head, PACK_GROUP - head, simd);
+    if (pg->lag == PACK_DOD) {
+        /* differences first, the first one is kept aside */
+        v[1] = pg->delta - pg->ref;
+        pack_prefix (v, pg->ref, d, simd);
+        pack_prefix (d, 0, rel, simd);
+    }
+    else if (pg->lag == 1) {
+        pack_prefix (v, pg->ref, rel, simd);
+    }
+#if defined(__x86_64__)
+    else if (simd) {
+        pack_lagAVX2 (v, pg->headRef, pg->ref, pg->lag, rel);
+    }
+#endif
+    else {
+        pack_lagScalar (v, pg->headRef, pg->ref, pg->lag, 0, rel);
+    }
+}
+
+/* expand every row into out, simd as returned by query_simd */
+void pblock_decode (const pblock *p, sblock *out, int simd) {
+    int rel[PACK_GROUP];
+    const pgroup *pg = NULL;
+    unsigned long i, s;
+    int g, j;
+
+    for (g = 0; g < PACK_GROUPS; g++) {
+        s = (unsigned long)g * PACK_GROUP;
+
+        pg = &p->groups[PACK_ID][g];
+        pack_column (p, PACK_ID, g, rel, simd);
+        for (j = 0; j < PACK_GROUP; j++) {
+            out->id[s + j] = (int)pg->base + rel[j];
+        }
+
+        pg = &p->groups[PACK_T][g];
+        pack_column (p, PACK_T, g, rel, simd);
+        for (j = 0; j < PACK_GROUP; j++) {
+            out->t[s + j] = pg->base + rel[j];
+        }
+
+        for (i = PACK_TEMP; i <= PACK_RELHUM; i++) {
+            pg = &p->groups[i][g];
+            pack_column (p, i, g, rel, simd);
+#if defined(__x86_64__)
+            if (simd) {
+                pack_scaleAVX2 (rel, (int)pg->base, i == PACK_TEMP ? &out->temp[s] : &out->relhum[s]);
+                continue;
+            }
+#endif
+            for (j = 0; j < PACK_GROUP; j++) {
+                (i == PACK_TEMP ? out->temp : out->relhum)[s + j] = (double)((int)pg->base + rel[j]) / PRECISION_SCALE;
+            }
+        }
+    }
+    for (i = 0; i < PACK_ROWS; i++) {
+        out->live[i] = (p->live[i / 8] >> (i % 8)) & 1;
+    }
+    out->tmin = p->tmin;
+    out->tmax = p->tmax;
+}
+
+static inline long pack_at (const pgroup *pg, const unsigned char *in, int j) {
+    unsigned long w, o;
+    unsigned int bits = pg->bits;
+    int ref = pg->ref, head = pack_head (pg);
+
+    if (j < head) {
+        bits = pg->headBits;
+        ref = pg->headRef;
+    }
+    else {
+        in += pack_headBytes (pg);
+        j -= head;
+    }
+    if (!bits) {
+        return ref;
+    }
+    o = (unsigned long)j * bits;
+    memcpy (&w, in + (o >> 3), sizeof (w));
+
+    return (long)((w >> (o & 7)) & ((1UL << bits) - 1)) + ref;
+}
+
+/* value i of column c, decoding only what it depends on: from the
+ * nearest checkpoint for delta of delta and lag 1, along the sensor's
+ * readings for a longer lag */
+static long pack_value (const pblock *p, int c, unsigned long i) {
+    const pgroup *pg = &p->groups[c][i / PACK_GROUP];
+    const unsigned char *in = p->data + pg->offset;
+    long x = 0, d = pg->delta;
+    int cp[2] = {0, 0};
+    int j, s, k, n = i % PACK_GROUP;
+    long m;
+
+    if (pack_checkpoint (pg)) {
+        k = n / PACK_FRAME;
+        s = 0;
+        if (k) {
+            memcpy (cp, in + pack_valueBytes (pg) + (k - 1) * pack_checkpoint (pg) * sizeof (int),
+                pack_checkpoint (pg) * sizeof (int));
+            s = k * PACK_FRAME;
+            x = cp[0];
+            d = cp[1];
+        }
+        if (!pg->bits && n > s) {
+            /* every difference is ref, a steady rate or consecutive ids */
+            m = n - s;
+            if (pg->lag == 1) {
+                return pg->base + x + m * pg->ref;
+            }
+            /* the group's first difference is delta, not d + ref */
+            if (!s) {
+                d -= pg->ref;
+            }
+            return pg->base + x + m * d + pg->ref * m * (m + 1) / 2;
+        }
+        for (j = s + 1; j <= n; j++) {
+            if (pg->lag == 1) {
+                x += pack_at (pg, in, j);
+                continue;
+            }
+            d += j > 1 ? pack_at (pg, in, j) : 0;
+            x += d;
+        }
+    }
+    else {
+        for (j = n; j > 0; j -= pg->lag) {
+            x += pack_at (pg, in, j);
+            if (j < pg->lag) {
+                break;
+            }
+        }
+    }
+
+    return pg->base + x;
+}
+
+/* fill r from row i */
+void pblock_get (const pblock *p, unsigned long i, record *r) {
+    r->id = (int)pack_value (p, PACK_ID, i);
+    r->t = (time_t)pack_value (p, PACK_T, i);
+    r->temp = (double)pack_value (p, PACK_TEMP, i) / PRECISION_SCALE;
+    r->relhum = (double)pack_value (p, PACK_RELHUM, i) / PRECISION_SCALE;
+    r->asString = &record_asString;
+    r->getKey = &record_getKey;
+}
+
+int pblock_live (const pblock *p, unsigned long i) {
+    return (p->live[i / 8] >> (i % 8)) & 1;
+}
+
+/* mark row i removed, returns whether it was live */
+int pblock_kill (pblock *p, unsigned long i) {
+    int live = pblock_live (p, i);
+
+    p->live[i / 8] &= ~(1 << (i % 8));
+
+    return live;
+}
+
+unsigned long pblock_bytes (const pblock *p) {
+    return sizeof (pblock) + p->size + PACK_PADDING;
+}
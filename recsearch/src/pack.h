@@ -0,0 +1,84 @@
+#ifndef _PACK_H
+#define _PACK_H
+#include <time.h>
+#include "record.h"
+
+/* values sharing a bit width, decoded together */
+#define PACK_GROUP 1024
+
+/* rows of a block, same as STORE_BLOCK */
+#define PACK_ROWS 4096
+#define PACK_GROUPS (PACK_ROWS / PACK_GROUP)
+
+/* values between the checkpoints of a delta of delta or lag 1 group,
+ * a point lookup sums at most this many */
+#define PACK_FRAME 64
+#define PACK_FRAMES (PACK_GROUP / PACK_FRAME)
+
+#define PACK_ID 0
+#define PACK_T 1
+#define PACK_TEMP 2
+#define PACK_RELHUM 3
+#define PACK_COLUMNS 4
+
+typedef struct sblock sblock;
+
+typedef struct pgroup pgroup;
+
+/* largest lag tried, readings of up to this many interleaved sensors
+ * are differenced against the same sensor's previous reading */
+#define PACK_MAX_LAG 64
+/* smallest lag past 1, the decoder adds 8 values at a time */
+#define PACK_MIN_LAG 8
+/* lag value for delta of delta */
+#define PACK_DOD 0
+
+/* values of one column in one group: the first is base, the others are
+ * differences minus ref, bits wide from data + offset. With a lag the
+ * first lag values have no earlier reading of their sensor, they are
+ * differences from base packed ahead at their own width.
+ *
+ * Delta of delta and lag 1 groups are followed by a checkpoint at the
+ * start of every PACK_FRAME values past the first, the value less base
+ * and, for delta of delta, the difference into it, as ints. A point
+ * lookup starts from the nearest one instead of the group's start */
+typedef struct pgroup {
+    long base;
+    int ref;
+    int headRef;
+    /* delta of delta only, the group's first difference */
+    int delta;
+    unsigned int offset;
+    unsigned char bits;
+    unsigned char headBits;
+    unsigned char lag;
+} pgroup;
+
+typedef struct pblock pblock;
+
+/* a full store block compressed by column, measurements scaled to
+ * PRECISION_SCALE, keeping the 2 decimals records are keyed on. Each
+ * group of each column takes whichever difference packs narrowest:
+ *   delta of delta    readings at a steady rate, consecutive ids
+ *   lag 1 delta       one slowly changing series
+ *   lag 8..64 delta   the same sensor's previous reading when several
+ *                     sensors report in turn
+ * less the group's smallest difference, at the widest one's bit width.
+ * Removed rows repeat the previous value so they cost nothing */
+typedef struct pblock {
+    time_t tmin;
+    time_t tmax;
+    pgroup groups[PACK_COLUMNS][PACK_GROUPS];
+    unsigned char live[PACK_ROWS / 8];
+    /* bytes of data */
+    unsigned long size;
+    unsigned char data[];
+} pblock;
+
+pblock *pblock_encode (const sblock *b);
+void pblock_decode (const pblock *p, sblock *out, int simd);
+void pblock_get (const pblock *p, unsigned long i, record *r);
+int pblock_live (const pblock *p, unsigned long i);
+int pblock_kill (pblock *p, unsigned long i);
+unsigned long pblock_bytes (const pblock *p);
+#endif
@@ -0,0 +1,613 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <stddef.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "ptable.h"
+
+#define FNV_OFFSET 0xcbf29ce484222325UL
+#define FNV_PRIME 0x100000001b3UL
+
+/* FNV-1a over the entry's fields and the log generation */
+static unsigned long wal_check (walEntry *e, unsigned long gen) {
+    const unsigned char *p = (const unsigned char *)e;
+    unsigned long h = FNV_OFFSET ^ gen;
+    size_t i;
+
+    for (i = 0; i < offsetof (walEntry, check); i++) {
+        h = (h ^ p[i]) * FNV_PRIME;
+    }
+
+    return h;
+}
+
+static char *ptable_path (ptable *self, const char *name) {
+    char *path = malloc (strlen (self->dir) + strlen (name) + 2);
+
+    if (!path) {
+        LOG_ERROR(("Out of memory (path)\n"));
+        return NULL;
+    }
+    sprintf (path, "%s/%s", self->dir, name);
+
+    return path;
+}
+
+static status ptable_writeAll (int fd, const void *buf, size_t len) {
+    const char *p = (const char *)buf;
+    ssize_t n;
+
+    while (len) {
+        n = write (fd, p, len);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            LOG_ERROR(("Write failed: %s\n", strerror (errno)));
+            return STATUS_UNKNOWN;
+        }
+        p += n;
+        len -= n;
+    }
+
+    return STATUS_OK;
+}
+
+/* a rename is only durable once its directory is synced */
+static void ptable_syncDir (ptable *self) {
+    int fd = open (self->dir, O_RDONLY | O_DIRECTORY);
+
+    if (fd >= 0) {
+        fsync (fd);
+        close (fd);
+    }
+}
+
+static status ptable_flush (ptable *self) {
+    status s = STATUS_OK;
+
+    if (self->nbuf) {
+        s = ptable_writeAll (self->wal, self->buf, self->nbuf * sizeof (walEntry));
+        self->nbuf = 0;
+    }
+
+    return s;
+}
+
+/* write out buffered entries, every write so far survives a crash once
+ * this returns */
+status ptable_sync (ptable *self) {
+    status s = ptable_flush (self);
+
+    if (s == STATUS_OK && fdatasync (self->wal) < 0) {
+        LOG_ERROR(("Could not sync the log: %s\n", strerror (errno)));
+        s = STATUS_UNKNOWN;
+    }
+
+    return s;
+}
+
+/* start an empty log of the current generation, entries still buffered
+ * are in the snapshot just taken */
+static status ptable_resetWal (ptable *self) {
+    walHeader h;
+
+    self->nbuf = 0;
+    self->logged = 0;
+    memset (&h, 0, sizeof (walHeader));
+    memcpy (h.magic, PTABLE_WAL_MAGIC, sizeof (h.magic));
+    h.gen = self->gen;
+    if (ftruncate (self->wal, 0) < 0) {
+        LOG_ERROR(("Could not truncate the log: %s\n", strerror (errno)));
+        return STATUS_UNKNOWN;
+    }
+    if (ptable_writeAll (self->wal, &h, sizeof (walHeader)) != STATUS_OK) {
+        return STATUS_UNKNOWN;
+    }
+    fdatasync (self->wal);
+
+    return STATUS_OK;
+}
+
+static status ptable_log (ptable *self, walEntry *e) {
+    status s = STATUS_OK;
+
+    e->check = wal_check (e, self->gen);
+    self->buf[self->nbuf++] = *e;
+    self->logged++;
+    if (self->nbuf == PTABLE_WAL_BUFFER) {
+        s = ptable_flush (self);
+    }
+    if (s == STATUS_OK && self->syncWrites) {
+        s = ptable_sync (self);
+    }
+
+    return s;
+}
+
+/* log r once the table has it */
+static status ptable_logAdd (ptable *self, record *r) {
+    walEntry e;
+
+    memset (&e, 0, sizeof (walEntry));
+    e.op = WAL_ADD;
+    e.id = r->id;
+    e.t = r->t;
+    e.rtemp = r->temp;
+    e.rrelhum = r->relhum;
+
+    return ptable_log (self, &e);
+}
+
+/* copy r's fields in and log them, the caller keeps r */
+status ptable_insertRecord (ptable *self, record *r) {
+    status s = table_insertRecord (self->t, r);
+
+    if (s != STATUS_OK) {
+        return s;
+    }
+
+    return ptable_logAdd (self, r);
+}
+
+/* the table takes r, see table_addRecord */
+status ptable_addRecord (ptable *self, record *r) {
+    status s = table_addRecord (self->t, r);
+
+    if (s != STATUS_OK) {
+        return s;
+    }
+
+    return ptable_logAdd (self, r);
+}
+
+status ptable_removeRecord (ptable *self, key k) {
+    walEntry e;
+    status s = table_removeRecord (self->t, k);
+
+    if (s != STATUS_OK) {
+        return s;
+    }
+    memset (&e, 0, sizeof (walEntry));
+    e.op = WAL_REMOVE;
+    e.t = k.t;
+    e.temp = k.temp;
+    e.relhum = k.relhum;
+
+    return ptable_log (self, &e);
+}
+
+record *ptable_findRecord (ptable *self, key k) {
+    return table_findRecord (self->t, k);
+}
+
+status ptable_getRecord (ptable *self, key k, record *out) {
+    return table_getRecord (self->t, k, out);
+}
+
+typedef struct snapLayout snapLayout;
+
+/* byte offsets of the sections and the file size */
+typedef struct snapLayout {
+    size_t slots;
+    size_t blocks;
+    size_t tblocks;
+    size_t freeRows;
+    size_t size;
+} snapLayout;
+
+#define SNAP_ROUND(n) (((n) + SNAP_ALIGN - 1) & ~(size_t)(SNAP_ALIGN - 1))
+
+static void snap_layout (snapLayout *l, const snapHeader *h) {
+    l->slots = SNAP_ROUND (sizeof (snapHeader));
+    l->blocks = SNAP_ROUND (l->slots + h->nslots * sizeof (slot));
+    l->tblocks = SNAP_ROUND (l->blocks + h->nblocks * sizeof (sblock));
+    l->freeRows = SNAP_ROUND (l->tblocks + h->ntblocks * sizeof (tblock));
+    l->size = l->freeRows + h->nfree * sizeof (rowid);
+}
+
+/* copy the live rows of the store into blocks densely, in row order,
+ * and note each row's new id in renumber, NO_ROW for removed ones */
+static status snap_rows (store *s, sblock *blocks, rowid *renumber, unsigned long count) {
+    sblock *scratch = malloc (sizeof (sblock));
+    const sblock *b = NULL;
+    sblock *out = NULL;
+    rowid row, next = 0;
+    unsigned long i, j, k;
+
+    if (!scratch) {
+        LOG_ERROR(("Out of memory (snapshot)\n"));
+        return STATUS_MEMORY_ERROR;
+    }
+    for (i = 0; i < s->nblocks; i++) {
+        b = store_block (s, i, scratch, 0);
+        for (j = 0; j < STORE_BLOCK && (row = i * STORE_BLOCK + j) < s->rows; j++) {
+            if (!b->live[j]) {
+                renumber[row] = NO_ROW;
+                continue;
+            }
+            if (next == count) {
+                free (scratch);
+                return STATUS_UNKNOWN;
+            }
+            out = &blocks[STORE_BLOCK_OF (next)];
+            k = STORE_OFFSET_OF (next);
+            if (!k || b->t[j] < out->tmin) {
+                out->tmin = b->t[j];
+            }
+            if (!k || b->t[j] > out->tmax) {
+                out->tmax = b->t[j];
+            }
+            out->id[k] = b->id[j];
+            out->t[k] = b->t[j];
+            out->temp[k] = b->temp[j];
+            out->relhum[k] = b->relhum[j];
+            out->live[k] = 1;
+            renumber[row] = next++;
+        }
+    }
+    free (scratch);
+
+    return next == count ? STATUS_OK : STATUS_UNKNOWN;
+}
+
+/* the time index over the renumbered rows, blocks filled in time order */
+static status snap_index (tindex *index, tblock *blocks, const rowid *renumber, unsigned long count) {
+    const tblock *b = NULL;
+    tblock *out = NULL;
+    unsigned long i, j, next = 0;
+
+    for (i = 0; i < index->nblocks; i++) {
+        b = index->blocks[i];
+        for (j = 0; j < b->count; j++) {
+            if (next == count || renumber[b->entries[j].row] == NO_ROW) {
+                return STATUS_UNKNOWN;
+            }
+            out = &blocks[next / TINDEX_BLOCK];
+            out->entries[out->count].t = b->entries[j].t;
+            out->entries[out->count].row = renumber[b->entries[j].row];
+            out->count++;
+            next++;
+        }
+    }
+
+    return next == count ? STATUS_OK : STATUS_UNKNOWN;
+}
+
+/* write the table compacted to a new snapshot of the next generation,
+ * swap it in and restart the log. Costs a pass over the whole table and
+ * a rowid per store row, call it between writes, see ptable_maintain */
+status ptable_snapshot (ptable *self) {
+    char *tmp = ptable_path (self, PTABLE_SNAPSHOT_TMP);
+    char *path = ptable_path (self, PTABLE_SNAPSHOT);
+    table *t = self->t;
+    snapHeader h;
+    snapLayout l;
+    slot *slots = NULL;
+    rowid *renumber = NULL;
+    char *map = MAP_FAILED;
+    unsigned long i;
+    int fd = -1;
+    status s = STATUS_UNKNOWN;
+
+    if (!tmp || !path) {
+        goto done;
+    }
+    renumber = malloc ((t->rows->rows ? t->rows->rows : 1) * sizeof (rowid));
+    if (!renumber) {
+        LOG_ERROR(("Out of memory (snapshot)\n"));
+        goto done;
+    }
+    /* one slot array to write */
+    table_settle (t);
+    memset (&h, 0, sizeof (snapHeader));
+    memcpy (h.magic, PTABLE_SNAPSHOT_MAGIC, sizeof (h.magic));
+    h.gen = self->gen + 1;
+    h.count = t->count;
+    h.nslots = t->cur.size;
+    h.rows = t->count;
+    h.nblocks = (t->count + STORE_BLOCK - 1) / STORE_BLOCK;
+    h.ntblocks = (t->count + TINDEX_BLOCK - 1) / TINDEX_BLOCK;
+    h.nfree = 0;
+    snap_layout (&l, &h);
+
+    fd = open (tmp, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0 || ftruncate (fd, l.size) < 0) {
+        LOG_ERROR(("Could not create snapshot %s: %s\n", tmp, strerror (errno)));
+        goto done;
+    }
+    map = mmap (NULL, l.size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        LOG_ERROR(("Could not map snapshot %s: %s\n", tmp, strerror (errno)));
+        goto done;
+    }
+
+    /* the file is zero filled, rows past count stay removed */
+    memcpy (map, &h, sizeof (snapHeader));
+    if (snap_rows (t->rows, (sblock *)(map + l.blocks), renumber, h.count) != STATUS_OK ||
+            snap_index (t->byTime, (tblock *)(map + l.tblocks), renumber, h.count) != STATUS_OK) {
+        LOG_ERROR(("Table and store disagree, snapshot not taken\n"));
+        goto done;
+    }
+    slots = (slot *)(map + l.slots);
+    memcpy (slots, t->cur.data, h.nslots * sizeof (slot));
+    for (i = 0; i < h.nslots; i++) {
+        if (slots[i].used && (slots[i].row = renumber[slots[i].row]) == NO_ROW) {
+            LOG_ERROR(("Table and store disagree, snapshot not taken\n"));
+            goto done;
+        }
+    }
+
+    if (msync (map, l.size, MS_SYNC) < 0 || fsync (fd) < 0) {
+        LOG_ERROR(("Could not sync snapshot %s: %s\n", tmp, strerror (errno)));
+        goto done;
+    }
+    if (rename (tmp, path) < 0) {
+        LOG_ERROR(("Could not rename snapshot %s: %s\n", tmp, strerror (errno)));
+        goto done;
+    }
+    ptable_syncDir (self);
+
+    /* a crash from here on finds a log older than the snapshot */
+    self->gen++;
+    s = ptable_resetWal (self);
+
+done:
+    if (map != MAP_FAILED) {
+        munmap (map, l.size);
+    }
+    if (fd >= 0) {
+        close (fd);
+    }
+    free (renumber);
+    free (tmp);
+    free (path);
+
+    return s;
+}
+
+/* take a snapshot once snapshotEvery entries were logged since the last
+ * one. Writes never snapshot themselves, a snapshot writes the whole
+ * table, so the owner calls this where a pause is acceptable, between
+ * batches or from a timer. A failed snapshot loses nothing, the log
+ * still holds every write */
+status ptable_maintain (ptable *self) {
+    if (!self->snapshotEvery || self->logged < self->snapshotEvery) {
+        return STATUS_OK;
+    }
+
+    return ptable_snapshot (self);
+}
+
+/* whether the header describes a table this build can use in place */
+static int snap_valid (const snapHeader *h, size_t size) {
+    snapLayout l;
+
+    if (memcmp (h->magic, PTABLE_SNAPSHOT_MAGIC, sizeof (h->magic)) ||
+            !h->nslots || (h->nslots & (h->nslots - 1)) ||
+            h->count * 100 > h->nslots * MAX_LOAD_PERCENT ||
+            (h->rows + STORE_BLOCK - 1) / STORE_BLOCK != h->nblocks ||
+            h->count + h->nfree > h->rows ||
+            h->ntblocks > h->count) {
+        return 0;
+    }
+    snap_layout (&l, h);
+
+    return l.size == size;
+}
+
+/* map the snapshot, if any, and hand its sections to the table. The
+ * mapping is private, pages the table writes to are copied, and stays
+ * until ptable_close */
+static status ptable_load (ptable *self) {
+    char *path = ptable_path (self, PTABLE_SNAPSHOT);
+    struct stat st;
+    snapHeader *h = NULL;
+    snapLayout l;
+    char *map = NULL;
+    int fd = -1;
+    status s = STATUS_UNKNOWN;
+
+    if (!path) {
+        return STATUS_MEMORY_ERROR;
+    }
+    fd = open (path, O_RDONLY);
+    if (fd < 0) {
+        s = errno == ENOENT ? STATUS_OK : STATUS_UNKNOWN;
+        if (s != STATUS_OK) {
+            LOG_ERROR(("Could not open snapshot %s: %s\n", path, strerror (errno)));
+        }
+        free (path);
+        return s;
+    }
+    if (fstat (fd, &st) < 0 || st.st_size < (off_t)sizeof (snapHeader)) {
+        LOG_ERROR(("Snapshot %s is truncated\n", path));
+        goto done;
+    }
+    map = mmap (NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) {
+        LOG_ERROR(("Could not map snapshot %s: %s\n", path, strerror (errno)));
+        goto done;
+    }
+    /* unmapped by ptable_close after the table, even if it is corrupt */
+    self->map = map;
+    self->mapSize = st.st_size;
+
+    h = (snapHeader *)map;
+    if (!snap_valid (h, st.st_size)) {
+        LOG_ERROR(("Snapshot %s is corrupt\n", path));
+        goto done;
+    }
+    snap_layout (&l, h);
+    s = store_adopt (self->t->rows, (sblock *)(map + l.blocks), h->nblocks, h->rows,
+        h->count, (rowid *)(map + l.freeRows), h->nfree);
+    if (s == STATUS_OK) {
+        s = tindex_adopt (self->t->byTime, (tblock *)(map + l.tblocks), h->ntblocks);
+    }
+    if (s == STATUS_OK) {
+        s = table_adopt (self->t, (slot *)(map + l.slots), h->nslots, h->count);
+    }
+    if (s != STATUS_OK || self->t->byTime->count != h->count) {
+        LOG_ERROR(("Snapshot %s is corrupt\n", path));
+        s = STATUS_UNKNOWN;
+        goto done;
+    }
+    self->gen = h->gen;
+
+done:
+    close (fd);
+    free (path);
+
+    return s;
+}
+
+/* apply the log of the snapshot's generation, cutting off a torn tail */
+static status ptable_replay (ptable *self) {
+    char *path = ptable_path (self, PTABLE_WAL);
+    walHeader h;
+    walEntry *e = NULL;
+    record r;
+    key k;
+    off_t off = sizeof (walHeader);
+    ssize_t n;
+    unsigned long i, count;
+    int torn = 0;
+
+    if (!path) {
+        return STATUS_MEMORY_ERROR;
+    }
+    self->wal = open (path, O_RDWR | O_CREAT | O_APPEND, 0644);
+    if (self->wal < 0) {
+        LOG_ERROR(("Could not open log %s: %s\n", path, strerror (errno)));
+        free (path);
+        return STATUS_UNKNOWN;
+    }
+
+    n = pread (self->wal, &h, sizeof (walHeader), 0);
+    if (n == 0) {
+        free (path);
+        return ptable_resetWal (self);
+    }
+    if (n != sizeof (walHeader) || memcmp (h.magic, PTABLE_WAL_MAGIC, sizeof (h.magic))) {
+        LOG_ERROR(("Log %s is corrupt\n", path));
+        free (path);
+        return STATUS_UNKNOWN;
+    }
+    if (h.gen < self->gen) {
+        /* the snapshot was taken but the log not restarted */
+        free (path);
+        return ptable_resetWal (self);
+    }
+    if (h.gen > self->gen) {
+        LOG_ERROR(("Log %s is newer than the snapshot\n", path));
+        free (path);
+        return STATUS_UNKNOWN;
+    }
+
+    while (!torn) {
+        n = pread (self->wal, self->buf, PTABLE_WAL_BUFFER * sizeof (walEntry), off);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        count = n / sizeof (walEntry);
+        torn = count < PTABLE_WAL_BUFFER;
+        for (i = 0; i < count; i++) {
+            e = &self->buf[i];
+            if (e->check != wal_check (e, self->gen)) {
+                torn = 1;
+                break;
+            }
+            if (e->op == WAL_ADD) {
+                record_init (&r, e->id, e->t, e->rtemp, e->rrelhum);
+                if (table_insertRecord (self->t, &r) != STATUS_OK) {
+                    free (path);
+                    return STATUS_MEMORY_ERROR;
+                }
+            }
+            else if (e->op == WAL_REMOVE) {
+                k.t = e->t;
+                k.temp = e->temp;
+                k.relhum = e->relhum;
+                table_removeRecord (self->t, k);
+            }
+            off += sizeof (walEntry);
+            self->logged++;
+        }
+    }
+    if (ftruncate (self->wal, off) < 0) {
+        LOG_ERROR(("Could not truncate log %s: %s\n", path, strerror (errno)));
+        free (path);
+        return STATUS_UNKNOWN;
+    }
+    free (path);
+
+    return STATUS_OK;
+}
+
+/* open the table in dir, created if missing */
+ptable *ptable_open (const char *dir) {
+    ptable *p = calloc (1, sizeof (ptable));
+
+    if (!p) {
+        LOG_ERROR(("Out of memory (ptable)\n"));
+        return NULL;
+    }
+    p->wal = -1;
+    if (mkdir (dir, 0755) < 0 && errno != EEXIST) {
+        LOG_ERROR(("Could not create %s: %s\n", dir, strerror (errno)));
+        free (p);
+        return NULL;
+    }
+    p->dir = strdup (dir);
+    p->buf = malloc (PTABLE_WAL_BUFFER * sizeof (walEntry));
+    p->t = table_new ();
+    if (!p->dir || !p->buf || !p->t) {
+        LOG_ERROR(("Out of memory (ptable)\n"));
+        ptable_close (p);
+        return NULL;
+    }
+    p->snapshotEvery = PTABLE_SNAPSHOT_EVERY;
+
+    if (ptable_load (p) != STATUS_OK || ptable_replay (p) != STATUS_OK) {
+        ptable_close (p);
+        return NULL;
+    }
+
+    p->addRecord = &ptable_addRecord;
+    p->insertRecord = &ptable_insertRecord;
+    p->removeRecord = &ptable_removeRecord;
+    p->findRecord = &ptable_findRecord;
+    p->getRecord = &ptable_getRecord;
+    p->sync = &ptable_sync;
+    p->snapshot = &ptable_snapshot;
+    p->maintain = &ptable_maintain;
+
+    return p;
+}
+
+/* sync the log and free the table, the files stay */
+void ptable_close (ptable *self) {
+    if (self->wal >= 0) {
+        ptable_sync (self);
+        close (self->wal);
+    }
+    if (self->t) {
+        table_destroy (self->t);
+    }
+    /* the table may point into it until destroyed */
+    if (self->map) {
+        munmap (self->map, self->mapSize);
+    }
+    free (self->buf);
+    free (self->dir);
+    free (self);
+}
@@ -0,0 +1,117 @@
+#ifndef _PTABLE_H
+#define _PTABLE_H
+#include "table.h"
+
+/* file names inside the table's directory */
+#define PTABLE_SNAPSHOT "snapshot"
+#define PTABLE_SNAPSHOT_TMP "snapshot.tmp"
+#define PTABLE_WAL "wal"
+
+#define PTABLE_SNAPSHOT_MAGIC "RECSNAP2"
+#define PTABLE_WAL_MAGIC "RECWAL01"
+
+/* log entries buffered before they are written out */
+#define PTABLE_WAL_BUFFER 4096
+
+/* log entries after which ptable_maintain takes a new snapshot, 0 for never */
+#define PTABLE_SNAPSHOT_EVERY (1UL << 22)
+
+#define WAL_ADD 1
+#define WAL_REMOVE 2
+
+/* snapshot sections start on a cache line */
+#define SNAP_ALIGN 64
+
+typedef struct snapHeader snapHeader;
+
+/* snapshot file: this header then the table compacted, the slot array,
+ * the store blocks, the time index blocks and the store's free rows,
+ * each section aligned to SNAP_ALIGN. Live rows are renumbered densely
+ * in row order, so removed rows are not carried over and there are no
+ * free rows. Opening maps the file copy on write and the table uses the
+ * sections in place, so loading costs a page fault per page touched
+ * instead of an insert per record. Compressed blocks are written decoded */
+typedef struct snapHeader {
+    char magic[8];
+    /* log generation that follows this snapshot */
+    unsigned long gen;
+    /* live records */
+    unsigned long count;
+    unsigned long nslots;
+    /* store rows appended and blocks holding them */
+    unsigned long rows;
+    unsigned long nblocks;
+    unsigned long ntblocks;
+    unsigned long nfree;
+} snapHeader;
+
+typedef struct walHeader walHeader;
+
+typedef struct walHeader {
+    char magic[8];
+    unsigned long gen;
+} walHeader;
+
+typedef struct walEntry walEntry;
+
+/* one write, replay stops at the first entry failing its check, which
+ * is where a crash tore the log */
+typedef struct walEntry {
+    unsigned int op;
+    int id;
+    /* scaled key of a removal */
+    int temp;
+    int relhum;
+    time_t t;
+    /* fields of an added record */
+    double rtemp;
+    double rrelhum;
+    unsigned long check;
+} walEntry;
+
+typedef struct ptable ptable;
+
+/* a table kept in a directory: every write is appended to a log, a
+ * compacted snapshot of the live records is taken by snapshot, or by
+ * maintain once snapshotEvery entries were logged, and the log restarts
+ * with the next generation. Opening loads the
+ * snapshot and replays the log of its generation, a log older than the
+ * snapshot is already in it.
+ *
+ * Entries are buffered, writes are durable once sync returns, or at
+ * once when syncWrites is set. Reads go to the table directly */
+typedef struct ptable {
+    table *t;
+    char *dir;
+    int wal;
+    unsigned long gen;
+    walEntry *buf;
+    unsigned long nbuf;
+    /* entries logged since the last snapshot */
+    unsigned long logged;
+    unsigned long snapshotEvery;
+    int syncWrites;
+    /* snapshot the table was loaded from, mapped until close */
+    void *map;
+    size_t mapSize;
+    status (*addRecord) (ptable *self, record *r);
+    status (*insertRecord) (ptable *self, record *r);
+    status (*removeRecord) (ptable *self, key k);
+    record *(*findRecord) (ptable *self, key k);
+    status (*getRecord) (ptable *self, key k, record *out);
+    status (*sync) (ptable *self);
+    status (*snapshot) (ptable *self);
+    status (*maintain) (ptable *self);
+} ptable;
+
+status ptable_addRecord (ptable *self, record *r);
+status ptable_insertRecord (ptable *self, record *r);
+status ptable_removeRecord (ptable *self, key k);
+record *ptable_findRecord (ptable *self, key k);
+status ptable_getRecord (ptable *self, key k, record *out);
+status ptable_sync (ptable *self);
+status ptable_snapshot (ptable *self);
+status ptable_maintain (ptable *self);
+ptable *ptable_open (const char *dir);
+void ptable_close (ptable *self);
+#endif
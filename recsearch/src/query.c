@@ -0,0 +1,285 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <float.h>
+#include <limits.h>
+
+#include "query.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define SIMDTARGET __attribute__((target("avx2")))
+#endif
+
+#define TIME_MIN ((time_t)LONG_MIN)
+#define TIME_MAX ((time_t)LONG_MAX)
+
+typedef struct groups groups;
+
+/* where a scan accumulates */
+typedef struct groups {
+    aggregate *data;
+    time_t base;
+    time_t bucket;
+} groups;
+
+/* no predicates, temp over a single group */
+void query_init (query *q) {
+    q->from = TIME_MIN;
+    q->to = TIME_MAX;
+    q->tempMin = -DBL_MAX;
+    q->tempMax = DBL_MAX;
+    q->relhumMin = -DBL_MAX;
+    q->relhumMax = DBL_MAX;
+    q->agg = FIELD_TEMP;
+    q->bucket = 0;
+    q->noSimd = 0;
+}
+
+/* start of the bucket holding t, rounding down for negative times */
+static time_t query_floor (time_t t, time_t bucket) {
+    time_t g = t / bucket * bucket;
+
+    if (g > t) {
+        g -= bucket;
+    }
+
+    return g;
+}
+
+static inline aggregate *query_group (groups *g, time_t t) {
+    if (!g->bucket) {
+        return g->data;
+    }
+
+    return &g->data[((unsigned long)query_floor (t, g->bucket) - (unsigned long)g->base) / (unsigned long)g->bucket];
+}
+
+static inline void query_add (aggregate *a, double v) {
+    a->count++;
+    a->sum += v;
+    if (v < a->min) {
+        a->min = v;
+    }
+    if (v > a->max) {
+        a->max = v;
+    }
+}
+
+static inline int query_match (const sblock *b, unsigned long i, const query *q) {
+    return b->live[i] &&
+        b->t[i] >= q->from && b->t[i] <= q->to &&
+        b->temp[i] >= q->tempMin && b->temp[i] <= q->tempMax &&
+        b->relhum[i] >= q->relhumMin && b->relhum[i] <= q->relhumMax;
+}
+
+static void query_blockScalar (const sblock *b, unsigned long from, unsigned long n, const query *q, groups *g) {
+    const double *v = q->agg == FIELD_TEMP ? b->temp : b->relhum;
+    unsigned long i;
+
+    for (i = from; i < n; i++) {
+        if (query_match (b, i, q)) {
+            query_add (query_group (g, b->t[i]), v[i]);
+        }
+    }
+}
+
+#if defined(__x86_64__)
+
+int query_simd (void) {
+    __builtin_cpu_init ();
+    return __builtin_cpu_supports ("avx2");
+}
+
+/* 4 rows per step: the predicates build a lane mask, a single group is
+ * then reduced in registers, grouped rows are added per set lane */
+SIMDTARGET
+static void query_blockAVX2 (const sblock *b, unsigned long n, const query *q, groups *g) {
+    const double *v = q->agg == FIELD_TEMP ? b->temp : b->relhum;
+    const __m256i from = _mm256_set1_epi64x (q->from);
+    const __m256i to = _mm256_set1_epi64x (q->to);
+    const __m256i zero = _mm256_setzero_si256 ();
+    const __m256d tempMin = _mm256_set1_pd (q->tempMin);
+    const __m256d tempMax = _mm256_set1_pd (q->tempMax);
+    const __m256d relhumMin = _mm256_set1_pd (q->relhumMin);
+    const __m256d relhumMax = _mm256_set1_pd (q->relhumMax);
+    const __m256d inf = _mm256_set1_pd (DBL_MAX);
+    const __m256d ninf = _mm256_set1_pd (-DBL_MAX);
+    __m256d sum = _mm256_setzero_pd (), min = inf, max = ninf;
+    __m256i count = zero, bad, live;
+    __m256d m, val;
+    double lanes[4];
+    long long counts[4];
+    unsigned long i;
+    int bits, j, x;
+
+    for (i = 0; i + 4 <= n; i += 4) {
+        bad = _mm256_loadu_si256 ((const __m256i *)&b->t[i]);
+        bad = _mm256_or_si256 (_mm256_cmpgt_epi64 (from, bad), _mm256_cmpgt_epi64 (bad, to));
+        memcpy (&x, &b->live[i], sizeof (x));
+        live = _mm256_cvtepu8_epi64 (_mm_cvtsi32_si128 (x));
+        bad = _mm256_or_si256 (bad, _mm256_cmpeq_epi64 (live, zero));
+
+        val = _mm256_loadu_pd (&b->temp[i]);
+        m = _mm256_and_pd (_mm256_cmp_pd (val, tempMin, _CMP_GE_OQ), _mm256_cmp_pd (val, tempMax, _CMP_LE_OQ));
+        val = _mm256_loadu_pd (&b->relhum[i]);
+        m = _mm256_and_pd (m, _mm256_cmp_pd (val, relhumMin, _CMP_GE_OQ));
+        m = _mm256_and_pd (m, _mm256_cmp_pd (val, relhumMax, _CMP_LE_OQ));
+        m = _mm256_andnot_pd (_mm256_castsi256_pd (bad), m);
+
+        val = _mm256_loadu_pd (&v[i]);
+        if (!g->bucket) {
+            sum = _mm256_add_pd (sum, _mm256_and_pd (m, val));
+            min = _mm256_min_pd (min, _mm256_blendv_pd (inf, val, m));
+            max = _mm256_max_pd (max, _mm256_blendv_pd (ninf, val, m));
+            count = _mm256_sub_epi64 (count, _mm256_castpd_si256 (m));
+        }
+        else {
+            for (bits = _mm256_movemask_pd (m); bits; bits &= bits - 1) {
+                j = __builtin_ctz (bits);
+                query_add (query_group (g, b->t[i + j]), v[i + j]);
+            }
+        }
+    }
+
+    if (!g->bucket) {
+        _mm256_storeu_si256 ((__m256i *)counts, count);
+        g->data->count += counts[0] + counts[1] + counts[2] + counts[3];
+        _mm256_storeu_pd (lanes, sum);
+        g->data->sum += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+        _mm256_storeu_pd (lanes, min);
+        for (j = 0; j < 4; j++) {
+            if (lanes[j] < g->data->min) {
+                g->data->min = lanes[j];
+            }
+        }
+        _mm256_storeu_pd (lanes, max);
+        for (j = 0; j < 4; j++) {
+            if (lanes[j] > g->data->max) {
+                g->data->max = lanes[j];
+            }
+        }
+    }
+    query_blockScalar (b, i, n, q, g);
+}
+
+#else
+
+/* no AVX2, every block runs the scalar kernel */
+int query_simd (void) {
+    return 0;
+}
+
+static void query_blockAVX2 (const sblock *b, unsigned long n, const query *q, groups *g) {
+    query_blockScalar (b, 0, n, q, g);
+}
+
+#endif
+
+static unsigned long query_rows (store *s, unsigned long i) {
+    return i == s->nblocks - 1 ? s->rows - i * STORE_BLOCK : STORE_BLOCK;
+}
+
+/* number of groups from the one starting at base to the one at last, both
+ * multiples of bucket. The span is taken unsigned so it cannot overflow */
+status query_groups (time_t base, time_t last, time_t bucket, unsigned long *n) {
+    *n = bucket ? ((unsigned long)last - (unsigned long)base) / (unsigned long)bucket + 1 : 1;
+    if (*n > QUERY_MAX_GROUPS) {
+        LOG_ERROR(("Query needs %lu groups, more than %lu: use a wider bucket or a narrower range\n", *n, QUERY_MAX_GROUPS));
+        *n = 0;
+        return STATUS_UNKNOWN;
+    }
+
+    return STATUS_OK;
+}
+
+/* filter and aggregate every row, blocks outside [from, to] are skipped */
+status query_run (store *s, query *q, result *res) {
+    groups g;
+    const sblock *b = NULL;
+    sblock *scratch = NULL;
+    time_t lo = TIME_MAX, hi = TIME_MIN, tmin, tmax;
+    unsigned long i, n = 0;
+    int simd = !q->noSimd && query_simd ();
+
+    memset (res, 0, sizeof (result));
+    if (q->bucket < 0) {
+        return STATUS_UNKNOWN;
+    }
+
+    /* time range of the data to group, from the block zone maps */
+    for (i = 0; i < s->nblocks; i++) {
+        store_span (s, i, &tmin, &tmax);
+        if (tmax < q->from || tmin > q->to) {
+            continue;
+        }
+        lo = tmin > lo ? lo : tmin;
+        hi = tmax < hi ? hi : tmax;
+        n++;
+    }
+    if (!n) {
+        return STATUS_OK;
+    }
+    lo = lo < q->from ? q->from : lo;
+    hi = hi > q->to ? q->to : hi;
+
+    g.bucket = q->bucket;
+    g.base = q->bucket ? query_floor (lo, q->bucket) : lo;
+    if (query_groups (g.base, q->bucket ? query_floor (hi, q->bucket) : lo, q->bucket, &res->ngroups) != STATUS_OK) {
+        return STATUS_UNKNOWN;
+    }
+    res->groups = calloc (res->ngroups, sizeof (aggregate));
+    if (!res->groups) {
+        LOG_ERROR(("Out of memory (query groups)\n"));
+        res->ngroups = 0;
+        return STATUS_MEMORY_ERROR;
+    }
+    for (i = 0; i < res->ngroups; i++) {
+        res->groups[i].start = g.base + (time_t)i * q->bucket;
+        res->groups[i].min = DBL_MAX;
+        res->groups[i].max = -DBL_MAX;
+    }
+    g.data = res->groups;
+
+    for (i = 0; i < s->nblocks; i++) {
+        store_span (s, i, &tmin, &tmax);
+        if (tmax < q->from || tmin > q->to) {
+            continue;
+        }
+        if (!s->blocks[i] && !scratch) {
+            /* packed blocks are decoded here one at a time */
+            scratch = malloc (sizeof (sblock));
+            if (!scratch) {
+                LOG_ERROR(("Out of memory (query)\n"));
+                query_free (res);
+                return STATUS_MEMORY_ERROR;
+            }
+        }
+        b = store_block (s, i, scratch, simd);
+        if (simd) {
+            query_blockAVX2 (b, query_rows (s, i), q, &g);
+        }
+        else {
+            query_blockScalar (b, 0, query_rows (s, i), q, &g);
+        }
+    }
+
+    for (i = 0; i < res->ngroups; i++) {
+        if (res->groups[i].count) {
+            res->groups[i].mean = res->groups[i].sum / res->groups[i].count;
+        }
+        else {
+            res->groups[i].min = res->groups[i].max = 0.0;
+        }
+        res->count += res->groups[i].count;
+    }
+    free (scratch);
+
+    return STATUS_OK;
+}
+
+void query_free (result *res) {
+    free (res->groups);
+    res->groups = NULL;
+    res->ngroups = 0;
+}
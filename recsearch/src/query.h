@@ -0,0 +1,60 @@
+#ifndef _QUERY_H
+#define _QUERY_H
+#include "store.h"
+#include "status.h"
+#include "log.h"
+
+typedef enum {
+    FIELD_TEMP,
+    FIELD_RELHUM
+} field;
+
+/* groups are allocated densely over the matching time range, queries
+ * needing more than this many are refused */
+#define QUERY_MAX_GROUPS (1UL << 20)
+
+typedef struct query query;
+
+/* rows with from <= t <= to and temp and relhum within their inclusive
+ * ranges, field aggregated per group of bucket seconds aligned to
+ * multiples of bucket, bucket 0 for a single group */
+typedef struct query {
+    time_t from;
+    time_t to;
+    double tempMin;
+    double tempMax;
+    double relhumMin;
+    double relhumMax;
+    field agg;
+    time_t bucket;
+    /* run the scalar kernel even when AVX2 is available */
+    unsigned char noSimd;
+} query;
+
+typedef struct aggregate aggregate;
+
+typedef struct aggregate {
+    /* first second of the group, from for a single group */
+    time_t start;
+    unsigned long count;
+    double min;
+    double max;
+    double sum;
+    double mean;
+} aggregate;
+
+typedef struct result result;
+
+typedef struct result {
+    aggregate *groups;
+    unsigned long ngroups;
+    /* rows matching all predicates */
+    unsigned long count;
+} result;
+
+void query_init (query *q);
+status query_run (store *s, query *q, result *res);
+status query_groups (time_t base, time_t last, time_t bucket, unsigned long *n);
+void query_free (result *res);
+int query_simd (void);
+#endif
@@ -6,8 +6,11 @@
 
 #include "record.h"
 
+/* rounded, so 11.2 stored as 11.1999... still scales to 1120 */
 int getScaledMeasurement (double measurement) {
-    return (int)(measurement * PRECISION_SCALE);
+    double scaled = measurement * PRECISION_SCALE;
+
+    return (int)(scaled < 0 ? scaled - 0.5 : scaled + 0.5);
 }
 
 char * record_asString (record *self) {
@@ -26,15 +29,52 @@ char * record_asString (record *self) {
 }
 
 key record_getKey (record *self) {
-    key k = 5;
+    key k;
 
-    k = 17 * k + (long)self->t;
-    k = 17 * k + getScaledMeasurement (self->temp),
-    k = 17 * k + getScaledMeasurement (self->relhum);
+    k.t = self->t;
+    k.temp = getScaledMeasurement (self->temp);
+    k.relhum = getScaledMeasurement (self->relhum);
 
     return k;
 }
 
+/* wyhash constants and 64x64->128 bit multiply-fold mixing */
+#define WYP0 0xa0761d6478bd642fUL
+#define WYP1 0xe7037ed1a0b428dbUL
+#define WYP2 0x8ebc6af09c88c6e3UL
+#define WYP3 0x589965cc75374cc3UL
+
+static inline unsigned long key_mix (unsigned long a, unsigned long b) {
+    __uint128_t r = (__uint128_t)a * b;
+
+    return (unsigned long)(r ^ (r >> 64));
+}
+
+/* every input bit affects every output bit, so the top bits the table
+ * indexes by are well spread even for keys differing in one field */
+unsigned long key_hash (key k) {
+    unsigned long m = ((unsigned long)(unsigned int)k.temp << 32) | (unsigned int)k.relhum;
+
+    return key_mix (key_mix ((unsigned long)k.t ^ WYP0, m ^ WYP1) ^ WYP2, sizeof (key) ^ WYP3);
+}
+
+/* fill a record the caller owns, insertRecord copies it so bulk loads
+ * can reuse one record on the stack instead of allocating each */
+void record_init (
+    record *self,
+    int id,
+    time_t t,
+    double temp,
+    double relhum
+) {
+    self->id = id;
+    self->t = t;
+    self->temp = temp;
+    self->relhum = relhum;
+    self->asString = &record_asString;
+    self->getKey = &record_getKey;
+}
+
 record * record_new (
     int id,
     time_t t,
@@ -47,13 +87,7 @@ record * record_new (
         fprintf (stderr, "Out of memory (record)\n");
         return NULL;
     }
-
-    r->id = id;
-    r->t = t;
-    r->temp = temp;
-    r->relhum = relhum;
-    r->asString = &record_asString;
-    r->getKey = &record_getKey;
+    record_init (r, id, t, temp, relhum);
 
     return r;
 }
@@ -1,10 +1,21 @@
+#ifndef _RECORD_H
+#define _RECORD_H
 #include <time.h>
 
-typedef unsigned long key;
-
 /* retain 2 decimal precision */
 #define PRECISION_SCALE 100
 
+typedef struct key key;
+
+/* full composite key, measurements scaled to PRECISION_SCALE */
+typedef struct key {
+    time_t t;
+    int temp;
+    int relhum;
+} key;
+
+#define compEQ(a,b) ((a).t == (b).t && (a).temp == (b).temp && (a).relhum == (b).relhum)
+
 /* length of record key allowed */
 #define KEY_LENGTH 1024
 
@@ -24,5 +35,8 @@ int getScaledMeasurement (double measurement);
 
 char * record_asString (record *self);
 key record_getKey (record *self);
+unsigned long key_hash (key k);
+void record_init (record *self, int id, time_t t, double temp, double relhum);
 record * record_new ();
 void record_destroy (record **self);
+#endif
@@ -0,0 +1,19 @@
+#ifndef _SHARED_H
+#define _SHARED_H
+
+/* fields a ctable reader copies without taking the shard lock, see
+ * ctable.h. Writers hold the lock so they may read them plainly, but
+ * every store and every unlocked load goes through these. Relaxed is
+ * enough, the shard's seq orders the copy and a torn one is retried */
+#define SHARED_LOAD(p) ({ \
+    __typeof__ (*(p)) shared_v_; \
+    __atomic_load ((p), &shared_v_, __ATOMIC_RELAXED); \
+    shared_v_; \
+})
+
+#define SHARED_STORE(p, v) do { \
+    __typeof__ (*(p)) shared_v_ = (v); \
+    __atomic_store ((p), &shared_v_, __ATOMIC_RELAXED); \
+} while (0)
+
+#endif
@@ -0,0 +1,67 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "slab.h"
+
+void slab_init (slab *self, size_t size, unsigned long perChunk) {
+    memset (self, 0, sizeof (slab));
+    /* room for the free list link, rounded to a cache line */
+    if (size < sizeof (void *)) {
+        size = sizeof (void *);
+    }
+    self->size = (size + SLAB_HEADER - 1) / SLAB_HEADER * SLAB_HEADER;
+    self->perChunk = perChunk ? perChunk : 1;
+}
+
+void *slab_alloc (slab *self) {
+    void *p = NULL;
+    char *chunk = NULL;
+
+    if (self->free) {
+        p = self->free;
+        self->free = *(void **)p;
+        self->used++;
+        return p;
+    }
+
+    if (self->next == self->end) {
+        chunk = aligned_alloc (SLAB_HEADER, SLAB_HEADER + self->size * self->perChunk);
+        if (!chunk) {
+            LOG_ERROR(("Out of memory (slab)\n"));
+            return NULL;
+        }
+        *(void **)chunk = self->chunks;
+        self->chunks = chunk;
+        self->next = chunk + SLAB_HEADER;
+        self->end = self->next + self->size * self->perChunk;
+        self->nchunks++;
+    }
+    p = self->next;
+    self->next += self->size;
+    self->used++;
+
+    return p;
+}
+
+void slab_free (slab *self, void *p) {
+    *(void **)p = self->free;
+    self->free = p;
+    self->used--;
+}
+
+/* release every object, one free per chunk */
+void slab_destroy (slab *self) {
+    void *chunk = self->chunks, *next = NULL;
+
+    while (chunk) {
+        next = *(void **)chunk;
+        free (chunk);
+        chunk = next;
+    }
+    self->chunks = NULL;
+    self->next = self->end = NULL;
+    self->free = NULL;
+    self->used = 0;
+    self->nchunks = 0;
+}
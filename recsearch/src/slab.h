@@ -0,0 +1,49 @@
+#ifndef _SLAB_H
+#define _SLAB_H
+#include <stddef.h>
+#include <stdlib.h>
+#include "log.h"
+
+/* chunk header size, keeps objects cache line aligned */
+#define SLAB_HEADER 64
+
+typedef struct slab slab;
+
+/* fixed size objects carved from large chunks. Freed objects go on a
+ * free list threaded through them and are reused first, everything is
+ * released at once by freeing the chunks */
+typedef struct slab {
+    size_t size;
+    unsigned long perChunk;
+    /* chunks linked through their first word */
+    void *chunks;
+    /* unused space in the newest chunk */
+    char *next;
+    char *end;
+    void *free;
+    unsigned long used;
+    unsigned long nchunks;
+} slab;
+
+typedef struct reclaimer reclaimer;
+
+/* frees memory that lock free readers may still be using, see ctable,
+ * a NULL reclaimer frees straight away */
+typedef struct reclaimer {
+    void (*retire) (void *ctx, void *p);
+    void *ctx;
+} reclaimer;
+
+static inline void reclaim (reclaimer *r, void *p) {
+    if (r) {
+        r->retire (r->ctx, p);
+    } else {
+        free (p);
+    }
+}
+
+void slab_init (slab *self, size_t size, unsigned long perChunk);
+void *slab_alloc (slab *self);
+void slab_free (slab *self, void *p);
+void slab_destroy (slab *self);
+#endif
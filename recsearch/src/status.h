@@ -0,0 +1,10 @@
+#ifndef _STATUS_H
+#define _STATUS_H
+
+typedef enum {
+    STATUS_OK,
+    STATUS_NOT_FOUND,
+    STATUS_MEMORY_ERROR,
+    STATUS_UNKNOWN
+} status;
+#endif
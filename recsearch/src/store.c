@@ -0,0 +1,290 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "store.h"
+
+/* copy r into a free row or the next one, NO_ROW when out of memory */
+rowid store_append (store *self, record *r) {
+    sblock **blocks = NULL, **retired = NULL;
+    pblock **packed = NULL;
+    sblock *b = NULL;
+    rowid row;
+    unsigned long i;
+
+    if (self->nfree) {
+        row = self->freeRows[--self->nfree];
+    } else {
+        row = self->rows;
+    }
+    i = STORE_OFFSET_OF (row);
+
+    if (STORE_BLOCK_OF (row) == self->nblocks) {
+        if (self->nblocks == self->capacity) {
+            /* copied rather than realloc'ed, readers may hold the old array */
+            blocks = malloc (2 * self->capacity * sizeof (sblock *));
+            packed = calloc (2 * self->capacity, sizeof (pblock *));
+            if (!blocks || !packed) {
+                LOG_ERROR(("Out of memory (store blocks)\n"));
+                free (blocks);
+                free (packed);
+                return NO_ROW;
+            }
+            memcpy (blocks, self->blocks, self->nblocks * sizeof (sblock *));
+            memcpy (packed, self->packed, self->nblocks * sizeof (pblock *));
+            retired = self->blocks;
+            free (self->packed);
+            SHARED_STORE (&self->blocks, blocks);
+            self->packed = packed;
+            reclaim (self->reclaim, retired);
+            self->capacity *= 2;
+        }
+        b = slab_alloc (&self->alloc);
+        if (!b) {
+            return NO_ROW;
+        }
+        b->tmin = r->t;
+        b->tmax = r->t;
+        SHARED_STORE (&self->blocks[self->nblocks], b);
+        SHARED_STORE (&self->nblocks, self->nblocks + 1);
+    }
+
+    b = self->blocks[STORE_BLOCK_OF (row)];
+    if (r->t < b->tmin) {
+        b->tmin = r->t;
+    }
+    if (r->t > b->tmax) {
+        b->tmax = r->t;
+    }
+    /* a ctable reader may be copying a reused row */
+    SHARED_STORE (&b->id[i], r->id);
+    SHARED_STORE (&b->t[i], r->t);
+    SHARED_STORE (&b->temp[i], r->temp);
+    SHARED_STORE (&b->relhum[i], r->relhum);
+    b->live[i] = 1;
+    if (row == self->rows) {
+        self->rows++;
+    }
+    self->count++;
+    if (self->compress && STORE_OFFSET_OF (self->rows) == 0 && row == self->rows - 1) {
+        /* left as it is if it does not compress */
+        store_pack (self, STORE_BLOCK_OF (row));
+    }
+
+    return row;
+}
+
+/* mark a row removed and keep it for reuse */
+status store_remove (store *self, rowid row) {
+    sblock *b = self->blocks[STORE_BLOCK_OF (row)];
+    rowid *rows = NULL;
+
+    if (!b) {
+        if (!pblock_kill (self->packed[STORE_BLOCK_OF (row)], STORE_OFFSET_OF (row))) {
+            return STATUS_NOT_FOUND;
+        }
+        self->count--;
+        return STATUS_OK;
+    }
+    if (!b->live[STORE_OFFSET_OF (row)]) {
+        return STATUS_NOT_FOUND;
+    }
+    b->live[STORE_OFFSET_OF (row)] = 0;
+    self->count--;
+
+    if (self->nfree == self->freeCapacity) {
+        rows = realloc (self->freeRows, (self->freeCapacity ? 2 * self->freeCapacity : STORE_BLOCK) * sizeof (rowid));
+        if (!rows) {
+            /* still removed, just not reused */
+            LOG_ERROR(("Out of memory (store free rows)\n"));
+            return STATUS_MEMORY_ERROR;
+        }
+        self->freeRows = rows;
+        self->freeCapacity = self->freeCapacity ? 2 * self->freeCapacity : STORE_BLOCK;
+    }
+    self->freeRows[self->nfree++] = row;
+
+    return STATUS_OK;
+}
+
+/* fill r from a row */
+void store_get (store *self, rowid row, record *r) {
+    sblock *b = self->blocks[STORE_BLOCK_OF (row)];
+    unsigned long i = STORE_OFFSET_OF (row);
+
+    if (!b) {
+        pblock_get (self->packed[STORE_BLOCK_OF (row)], i, r);
+        return;
+    }
+    r->id = b->id[i];
+    r->t = b->t[i];
+    r->temp = b->temp[i];
+    r->relhum = b->relhum[i];
+    r->asString = &record_asString;
+    r->getKey = &record_getKey;
+}
+
+/* compress full block i, its removed rows are no longer reused. A ctable
+ * reader dereferences blocks[] without the lock, so a store shared with
+ * one (reclaim set) is refused rather than left with NULL blocks */
+status store_pack (store *self, unsigned long i) {
+    sblock *b = self->blocks[i];
+    pblock *p = NULL;
+    unsigned long j, n = 0;
+
+    if (self->reclaim) {
+        LOG_ERROR(("Cannot compress a store with lock-free readers\n"));
+        return STATUS_UNKNOWN;
+    }
+    if (!b || i >= STORE_BLOCK_OF (self->rows)) {
+        return STATUS_OK;
+    }
+    p = pblock_encode (b);
+    if (!p) {
+        return STATUS_UNKNOWN;
+    }
+    for (j = 0; j < self->nfree; j++) {
+        if (STORE_BLOCK_OF (self->freeRows[j]) != i) {
+            self->freeRows[n++] = self->freeRows[j];
+        }
+    }
+    self->nfree = n;
+    self->packed[i] = p;
+    self->packedBytes += pblock_bytes (p);
+    self->blocks[i] = NULL;
+    slab_free (&self->alloc, b);
+
+    return STATUS_OK;
+}
+
+/* compress every full block now and each block once it fills, blocks
+ * that do not compress stay as they are */
+status store_compress (store *self) {
+    unsigned long i;
+
+    if (self->reclaim) {
+        LOG_ERROR(("Cannot compress a store with lock-free readers\n"));
+        return STATUS_UNKNOWN;
+    }
+    self->compress = 1;
+    for (i = 0; i < self->nblocks; i++) {
+        store_pack (self, i);
+    }
+
+    return STATUS_OK;
+}
+
+/* block i for a scan, packed blocks are decoded into scratch */
+const sblock *store_block (store *self, unsigned long i, sblock *scratch, int simd) {
+    if (self->blocks[i]) {
+        return self->blocks[i];
+    }
+    pblock_decode (self->packed[i], scratch, simd);
+
+    return scratch;
+}
+
+void store_span (store *self, unsigned long i, time_t *tmin, time_t *tmax) {
+    if (self->blocks[i]) {
+        *tmin = self->blocks[i]->tmin;
+        *tmax = self->blocks[i]->tmax;
+    }
+    else {
+        *tmin = self->packed[i]->tmin;
+        *tmax = self->packed[i]->tmax;
+    }
+}
+
+/* use the n blocks at blocks, holding rows rows of which count are
+ * live, and reuse the nfree rows in freeRows first. Only while the store
+ * is empty, the blocks are written to but never freed, see ptable */
+status store_adopt (store *self, sblock *blocks, unsigned long n, rowid rows,
+        unsigned long count, const rowid *freeRows, unsigned long nfree) {
+    sblock **ptrs = NULL;
+    pblock **packed = NULL;
+    rowid *reuse = NULL;
+    unsigned long capacity = self->capacity, i;
+
+    if (self->rows || (rows + STORE_BLOCK - 1) / STORE_BLOCK != n) {
+        return STATUS_UNKNOWN;
+    }
+    while (capacity < n) {
+        capacity *= 2;
+    }
+    ptrs = malloc (capacity * sizeof (sblock *));
+    packed = calloc (capacity, sizeof (pblock *));
+    reuse = nfree ? malloc (nfree * sizeof (rowid)) : NULL;
+    if (!ptrs || !packed || (nfree && !reuse)) {
+        LOG_ERROR(("Out of memory (store blocks)\n"));
+        free (ptrs);
+        free (packed);
+        free (reuse);
+        return STATUS_MEMORY_ERROR;
+    }
+    for (i = 0; i < n; i++) {
+        ptrs[i] = &blocks[i];
+    }
+    if (nfree) {
+        memcpy (reuse, freeRows, nfree * sizeof (rowid));
+    }
+    free (self->blocks);
+    free (self->packed);
+    free (self->freeRows);
+    self->blocks = ptrs;
+    self->packed = packed;
+    self->capacity = capacity;
+    self->nblocks = n;
+    self->freeRows = reuse;
+    self->nfree = nfree;
+    self->freeCapacity = nfree;
+    self->rows = rows;
+    self->count = count;
+
+    return STATUS_OK;
+}
+
+/* drop every row, the blocks go back in one go */
+void store_clean (store *self) {
+    unsigned long i;
+
+    for (i = 0; i < self->nblocks; i++) {
+        free (self->packed[i]);
+        self->packed[i] = NULL;
+    }
+    self->packedBytes = 0;
+    slab_destroy (&self->alloc);
+    self->nblocks = 0;
+    self->rows = 0;
+    self->count = 0;
+    self->nfree = 0;
+}
+
+store *store_new (void) {
+    store *s = calloc (1, sizeof (store));
+    if (!s) {
+        LOG_ERROR(("Out of memory (store)\n"));
+        return NULL;
+    }
+
+    s->blocks = calloc (STORE_BLOCKS, sizeof (sblock *));
+    s->packed = calloc (STORE_BLOCKS, sizeof (pblock *));
+    if (!s->blocks || !s->packed) {
+        LOG_ERROR(("Out of memory (store blocks)\n"));
+        free (s->blocks);
+        free (s->packed);
+        free (s);
+        return NULL;
+    }
+    s->capacity = STORE_BLOCKS;
+    slab_init (&s->alloc, sizeof (sblock), STORE_CHUNK);
+
+    return s;
+}
+
+void store_destroy (store *self) {
+    store_clean (self);
+    free (self->freeRows);
+    free (self->blocks);
+    free (self->packed);
+    free (self);
+}
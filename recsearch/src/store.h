@@ -0,0 +1,85 @@
+#ifndef _STORE_H
+#define _STORE_H
+#include "record.h"
+#include "status.h"
+#include "slab.h"
+#include "pack.h"
+#include "shared.h"
+#include "log.h"
+
+/* rows per block, a power of 2 */
+#define STORE_BLOCK 4096
+
+/* initial number of blocks */
+#define STORE_BLOCKS 16
+
+/* blocks per slab chunk, about 2MB */
+#define STORE_CHUNK 16
+
+typedef unsigned long rowid;
+
+#define NO_ROW ((rowid)-1)
+
+#define STORE_BLOCK_OF(r) ((r) / STORE_BLOCK)
+#define STORE_OFFSET_OF(r) ((r) % STORE_BLOCK)
+
+typedef struct sblock sblock;
+
+/* one array per field so a scan over a field reads only that field,
+ * rows are never moved once appended */
+typedef struct sblock {
+    int id[STORE_BLOCK];
+    time_t t[STORE_BLOCK];
+    double temp[STORE_BLOCK];
+    double relhum[STORE_BLOCK];
+    /* 0 once removed, scans skip those rows */
+    unsigned char live[STORE_BLOCK];
+    /* time range of the rows appended, lets scans skip whole blocks */
+    time_t tmin;
+    time_t tmax;
+} sblock;
+
+typedef struct store store;
+
+/* columnar record storage, rows are appended in blocks and named by
+ * their row id, which the table's indexes point to. Removed rows are
+ * reused before new ones are appended.
+ *
+ * Full blocks can be compressed, see pack.h: blocks[i] is then NULL and
+ * packed[i] holds the rows, which keep their ids but are not reused.
+ * Stores with a reclaimer, those of a ctable, refuse to compress */
+typedef struct store {
+    sblock **blocks;
+    pblock **packed;
+    unsigned long nblocks;
+    unsigned long capacity;
+    slab alloc;
+    /* stack of removed rows */
+    rowid *freeRows;
+    unsigned long nfree;
+    unsigned long freeCapacity;
+    /* rows appended, the next new row id */
+    rowid rows;
+    /* rows not removed */
+    unsigned long count;
+    /* frees replaced block arrays, NULL to free at once */
+    reclaimer *reclaim;
+    /* compress each block once it fills */
+    unsigned char compress;
+    /* bytes held by packed blocks */
+    unsigned long packedBytes;
+} store;
+
+store *store_new (void);
+rowid store_append (store *self, record *r);
+status store_remove (store *self, rowid row);
+void store_get (store *self, rowid row, record *r);
+status store_pack (store *self, unsigned long i);
+status store_compress (store *self);
+const sblock *store_block (store *self, unsigned long i, sblock *scratch, int simd);
+void store_span (store *self, unsigned long i, time_t *tmin, time_t *tmax);
+status store_adopt (store *self, sblock *blocks, unsigned long n, rowid rows,
+        unsigned long count, const rowid *freeRows, unsigned long nfree);
+void store_clean (store *self);
+void store_destroy (store *self);
+#endif
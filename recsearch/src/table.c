@@ -6,143 +6,515 @@
 
 #include "table.h"
 
-bucket table_getBucket (key k) {
-    return k % NUM_BUCKETS;
+/* top bits of the key hash */
+static bucket slots_home (slots *s, key k) {
+    return (bucket)(key_hash (k) >> s->shift);
 }
 
+bucket table_getBucket (table *self, key k) {
+    return slots_home (&self->cur, k);
+}
+
+/* store a slot field by field, a ctable reader may be copying it */
+static void slot_set (slot *dst, slot v) {
+    SHARED_STORE (&dst->key.t, v.key.t);
+    SHARED_STORE (&dst->key.temp, v.key.temp);
+    SHARED_STORE (&dst->key.relhum, v.key.relhum);
+    SHARED_STORE (&dst->row, v.row);
+    SHARED_STORE (&dst->dist, v.dist);
+    SHARED_STORE (&dst->used, v.used);
+}
+
+static void slot_clear (slot *dst) {
+    slot empty;
+
+    memset (&empty, 0, sizeof (slot));
+    slot_set (dst, empty);
+}
+
+/* copy the array fields, a ctable reader copies them to a local while
+ * the writer replaces them */
+void slots_copy (slots *dst, slots *src) {
+    SHARED_STORE (&dst->data, SHARED_LOAD (&src->data));
+    SHARED_STORE (&dst->size, SHARED_LOAD (&src->size));
+    SHARED_STORE (&dst->mask, SHARED_LOAD (&src->mask));
+    SHARED_STORE (&dst->shift, SHARED_LOAD (&src->shift));
+}
+
+/* robin hood insert, no check for space. An equal key is displaced
+ * when newest is set so the newest record is found first as with the
+ * old chains, migrated entries are older and go behind */
+static void slots_place (slots *s, key k, rowid row, int newest) {
+    slot cur, tmp;
+    bucket i;
+
+    cur.key = k;
+    cur.row = row;
+    cur.dist = 0;
+    cur.used = 1;
+    i = slots_home (s, k);
+
+    while (s->data[i].used) {
+        if (s->data[i].dist < cur.dist ||
+                (newest && s->data[i].dist == cur.dist && compEQ (s->data[i].key, cur.key))) {
+            tmp = s->data[i];
+            slot_set (&s->data[i], cur);
+            cur = tmp;
+        }
+        i = (i + 1) & s->mask;
+        cur.dist++;
+    }
+    slot_set (&s->data[i], cur);
+}
+
+static status slots_alloc (slots *s, bucket size) {
+    int bits = 0;
+
+    s->data = calloc (size, sizeof (slot));
+    if (!s->data) {
+        LOG_ERROR(("Out of memory (data)\n"));
+        return STATUS_MEMORY_ERROR;
+    }
+    while ((1UL << bits) < size) {
+        bits++;
+    }
+    s->size = size;
+    s->mask = size - 1;
+    s->shift = 64 - bits;
+
+    return STATUS_OK;
+}
+
+/* slot holding k, or -1. Bounded by the array size so a reader racing
+ * a writer, see ctable, cannot loop forever */
+long slots_lookup (slots *s, key k) {
+    unsigned int dist = 0;
+    slot *sl = NULL;
+    bucket i;
+
+    if (!s->data) {
+        return -1;
+    }
+    i = slots_home (s, k);
+    while (SHARED_LOAD (&s->data[i].used) && dist <= s->mask) {
+        sl = &s->data[i];
+        /* k would have displaced an entry this close to home */
+        if (SHARED_LOAD (&sl->dist) < dist) {
+            break;
+        }
+        if (SHARED_LOAD (&sl->key.t) == k.t && SHARED_LOAD (&sl->key.temp) == k.temp &&
+                SHARED_LOAD (&sl->key.relhum) == k.relhum) {
+            return (long)i;
+        }
+        i = (i + 1) & s->mask;
+        dist++;
+    }
+
+    return -1;
+}
+
+/* empty slot i, shifting back the entries displaced past it */
+static void slots_remove (slots *s, bucket i) {
+    slot moved;
+    bucket j;
+
+    j = (i + 1) & s->mask;
+    while (s->data[j].used && s->data[j].dist) {
+        moved = s->data[j];
+        moved.dist--;
+        slot_set (&s->data[i], moved);
+        i = j;
+        j = (j + 1) & s->mask;
+    }
+    slot_clear (&s->data[i]);
+}
+
+/* free a replaced slot array, one borrowed from a mapping is dropped */
+static void table_release (table *self, slot *data) {
+    if (data && data == self->borrowed) {
+        self->borrowed = NULL;
+        return;
+    }
+    reclaim (self->reclaim, data);
+}
+
+/* move at least REHASH_STEP old slots, stopping between clusters */
+static void table_migrate (table *self) {
+    slots *old = &self->old, empty;
+    slot *sl = NULL;
+    int visited = 0;
+
+    while (old->data && (visited < REHASH_STEP || old->data[self->cursor].used)) {
+        sl = &old->data[self->cursor];
+        if (sl->used) {
+            slots_place (&self->cur, sl->key, sl->row, 0);
+            slot_clear (sl);
+        }
+        self->cursor = (self->cursor + 1) & old->mask;
+        visited++;
+        if (!--self->remaining) {
+            /* unpublished before it goes to the reclaimer */
+            sl = old->data;
+            memset (&empty, 0, sizeof (slots));
+            slots_copy (old, &empty);
+            table_release (self, sl);
+        }
+    }
+}
+
+/* start moving to an array twice the size */
+static status table_grow (table *self) {
+    slots next;
+
+    if (slots_alloc (&next, 2 * self->cur.size) != STATUS_OK) {
+        return STATUS_MEMORY_ERROR;
+    }
+    slots_copy (&self->old, &self->cur);
+    slots_copy (&self->cur, &next);
+    self->remaining = self->old.size;
+
+    /* below the load limit there is always an empty slot */
+    self->cursor = 0;
+    while (self->old.data[self->cursor].used) {
+        self->cursor++;
+    }
+
+    return STATUS_OK;
+}
+
+/* finish moving the old slots, a snapshot writes the current array only */
+void table_settle (table *self) {
+    while (self->old.data) {
+        table_migrate (self);
+    }
+}
+
+/* use size slots at data, holding count records whose rows are already
+ * in the store and the time index, only while the table is empty. The
+ * table writes to data but does not free it, see ptable */
+status table_adopt (table *self, slot *data, bucket size, unsigned long count) {
+    slots next;
+    int bits = 0;
+
+    if (self->count || self->old.data || !size || (size & (size - 1))) {
+        return STATUS_UNKNOWN;
+    }
+    while ((1UL << bits) < size) {
+        bits++;
+    }
+    next.data = data;
+    next.size = size;
+    next.mask = size - 1;
+    next.shift = 64 - bits;
+    table_release (self, self->cur.data);
+    slots_copy (&self->cur, &next);
+    self->borrowed = data;
+    self->count = count;
+
+    return STATUS_OK;
+}
+
+/* size the slots for n records up front so a bulk load never grows,
+ * only while the table is empty */
+status table_reserve (table *self, unsigned long n) {
+    slots next;
+    bucket size = self->cur.size;
+
+    if (self->count || self->old.data) {
+        return STATUS_OK;
+    }
+    while (n * 100 > size * MAX_LOAD_PERCENT) {
+        size <<= 1;
+    }
+    if (size == self->cur.size) {
+        return STATUS_OK;
+    }
+    if (slots_alloc (&next, size) != STATUS_OK) {
+        return STATUS_MEMORY_ERROR;
+    }
+    table_release (self, self->cur.data);
+    slots_copy (&self->cur, &next);
+
+    return STATUS_OK;
+}
+
+/* room in owned for every row the store has or is about to append */
+static status table_own (table *self) {
+    unsigned long n = self->ownedCapacity ? self->ownedCapacity : STORE_BLOCK;
+    record **owned = NULL;
+
+    if (self->rows->rows < self->ownedCapacity) {
+        return STATUS_OK;
+    }
+    while (n <= self->rows->rows) {
+        n <<= 1;
+    }
+    owned = realloc (self->owned, n * sizeof (record *));
+    if (!owned) {
+        LOG_ERROR(("Out of memory (owned)\n"));
+        return STATUS_MEMORY_ERROR;
+    }
+    memset (owned + self->ownedCapacity, 0, (n - self->ownedCapacity) * sizeof (record *));
+    self->owned = owned;
+    self->ownedCapacity = n;
+
+    return STATUS_OK;
+}
+
+/* free the record handed out for row, if any */
+static void table_disown (table *self, rowid row) {
+    if (row < self->ownedCapacity && self->owned[row]) {
+        record_destroy (&self->owned[row]);
+    }
+}
+
+/* append r's fields and index them, row is set to the new row */
+static status table_put (table *self, record *r, rowid *row) {
+    if (self->old.data) {
+        table_migrate (self);
+    }
+    /* the migration finishes well before the new array is full, see
+     * REHASH_STEP, so growth only starts from a single array */
+    else if ((self->count + 1) * 100 > self->cur.size * MAX_LOAD_PERCENT) {
+        if (table_grow (self) != STATUS_OK) {
+            return STATUS_MEMORY_ERROR;
+        }
+        table_migrate (self);
+    }
+    *row = store_append (self->rows, r);
+    if (*row == NO_ROW) {
+        return STATUS_MEMORY_ERROR;
+    }
+    if (tindex_add (self->byTime, r->t, *row) != STATUS_OK) {
+        store_remove (self->rows, *row);
+        return STATUS_MEMORY_ERROR;
+    }
+    slots_place (&self->cur, r->getKey(r), *row, 1);
+    SHARED_STORE (&self->count, self->count + 1);
+
+    return STATUS_OK;
+}
+
+/* copy r's fields in, the caller keeps r */
+status table_insertRecord (table *self, record *r) {
+    rowid row;
+
+    return table_put (self, r, &row);
+}
+
+/* the table takes r, findRecord returns it until the record is
+ * removed. Its fields are copied to the store when added, later
+ * changes to r are not seen by scans and queries */
 status table_addRecord (table *self, record *r) {
-    node *current, *new;
-    int bucket;
-    key k;
-
-    k = r->getKey(r);
-    bucket = self->getBucket(k);
-    current = self->data[bucket];
-    new = calloc (1, sizeof (node));
-    if (!new) {
+    rowid row;
+
+    if (table_own (self) != STATUS_OK) {
         return STATUS_MEMORY_ERROR;
     }
+    if (table_put (self, r, &row) != STATUS_OK) {
+        return STATUS_MEMORY_ERROR;
+    }
+    self->owned[row] = r;
 
-    self->data[bucket] = new;
-    new->key = k;
-    new->rec = r;
-    new->next = current;
-    
     return STATUS_OK;
 }
 
+/* row of the newest record with key k, or NO_ROW */
+rowid table_findRow (table *self, key k) {
+    long i = slots_lookup (&self->cur, k);
+
+    if (i >= 0) {
+        return self->cur.data[i].row;
+    }
+    i = slots_lookup (&self->old, k);
+    if (i >= 0) {
+        return self->old.data[i].row;
+    }
+
+    return NO_ROW;
+}
+
+/* the record is the table's and valid until it is removed. Rows
+ * stored by insertRecord get one allocated on first lookup, use
+ * getRecord to copy the fields out without allocating */
 record *table_findRecord (table *self, key k) {
-    int i = 0;
-    node *n = NULL;
+    rowid row = table_findRow (self, k);
     record *r = NULL;
 
-    i = self->getBucket (k);
-    n = self->data[i];
-    if (!n) {
+    if (row == NO_ROW) {
         return NULL;
     }
-    while (n) {
-        if (compEQ (n->key, k)) {
-            r = n->rec;
-            break;
-        }
-        n = n->next;
+    if (row < self->ownedCapacity && self->owned[row]) {
+        return self->owned[row];
+    }
+    if (table_own (self) != STATUS_OK) {
+        return NULL;
+    }
+    r = calloc (1, sizeof (record));
+    if (!r) {
+        LOG_ERROR(("Out of memory (record)\n"));
+        return NULL;
     }
+    store_get (self->rows, row, r);
+    self->owned[row] = r;
 
     return r;
 }
 
+/* copy the fields of the newest record with key k to out */
+status table_getRecord (table *self, key k, record *out) {
+    rowid row = table_findRow (self, k);
+
+    if (row == NO_ROW) {
+        return STATUS_NOT_FOUND;
+    }
+    store_get (self->rows, row, out);
+
+    return STATUS_OK;
+}
+
 status table_removeRecord (table *self, key k) {
-    int i = 0;
-    node *n = NULL, *p = NULL;
+    slots *s = &self->cur;
+    long i = slots_lookup (s, k);
+    record r;
+    rowid row;
 
-    i = self->getBucket (k);
-    n = self->data[i];
-    if (!n) {
+    if (i < 0) {
+        s = &self->old;
+        i = slots_lookup (s, k);
+    }
+    if (i < 0) {
         return STATUS_NOT_FOUND;
     }
-    while (n) {
-        if (compEQ (n->key, k)) {
-            break;
-        }
-        n = n->next;
-        p = n;
+    row = s->data[i].row;
+    store_get (self->rows, row, &r);
+    tindex_remove (self->byTime, r.t, row);
+    table_disown (self, row);
+    store_remove (self->rows, row);
+    slots_remove (s, (bucket)i);
+    SHARED_STORE (&self->count, self->count - 1);
+
+    if (self->old.data) {
+        table_migrate (self);
     }
 
-    if (n->next && p) {
-        p->next = n->next;
-    } else if (n->next && !p) {
-        self->data[i] = n->next;
-        n->next = NULL;
-    } else if (!n->next && p) {
-        p->next = NULL;
-    } else {
-        self->data[i] = NULL;
+    return STATUS_OK;
+}
+
+typedef struct rangeScan {
+    table *self;
+    visitor visit;
+    void *ctx;
+    record r;
+} rangeScan;
+
+static void table_visitRow (void *ctx, rowid row) {
+    rangeScan *scan = (rangeScan *)ctx;
+
+    store_get (scan->self->rows, row, &scan->r);
+    scan->visit (scan->ctx, &scan->r);
+}
+
+/* records with from <= t <= to in time order, visit may be NULL to
+ * only count them. The record passed to visit is only valid during
+ * the call */
+unsigned long table_findRange (table *self, time_t from, time_t to, visitor visit, void *ctx) {
+    rangeScan scan;
+
+    if (!visit) {
+        return tindex_scan (self->byTime, from, to, NULL, NULL);
     }
+    scan.self = self;
+    scan.visit = visit;
+    scan.ctx = ctx;
 
-    record_destroy (&n->rec);
-    free (n);
+    return tindex_scan (self->byTime, from, to, &table_visitRow, &scan);
+}
 
-    return STATUS_OK;
+/* compress full blocks of the store, see store_compress */
+status table_compress (table *self) {
+    return store_compress (self->rows);
 }
 
-void table_clean (table *self) {
-    int i = 0;
-    node *n = NULL, *tmp = NULL;
+/* filter and aggregate over the columns, see query.h, the caller frees
+ * res with query_free */
+status table_runQuery (table *self, query *q, result *res) {
+    return query_run (self->rows, q, res);
+}
 
-    for (i = 0; i < NUM_BUCKETS; i++) {
-        n = self->data[i];
-        while (n) {
-            tmp = n;
-            n = n->next;
+void table_clean (table *self) {
+    unsigned long i;
 
-            record_destroy (&tmp->rec);
-            free (tmp);
-        }
+    for (i = 0; i < self->ownedCapacity; i++) {
+        table_disown (self, i);
+    }
+    tindex_clean (self->byTime);
+    store_clean (self->rows);
+    memset (self->cur.data, 0, self->cur.size * sizeof (slot));
+    if (self->old.data) {
+        table_release (self, self->old.data);
+        memset (&self->old, 0, sizeof (slots));
     }
+    self->count = 0;
 
     return;
 }
 
-void table_print (table *self) {
-    int i = 0;
-    node *n = NULL;
-    char *s = NULL;
-
-    for (i = 0; i < NUM_BUCKETS; i++) {
-        n = self->data[i];
-        if (n) {
-            fprintf (stdout, "bucket=%d", i);
-
-            while (n) {
-                s = n->rec->asString(n->rec); 
-                fprintf (stdout, " node=%p record=%s", n, s);
-                free (s);
-
-                n = n->next;
-            }
-            fprintf (stdout, "\n");
+static void slots_print (table *self, slots *s, const char *name) {
+    bucket i;
+    record r;
+    char *str = NULL;
+
+    for (i = 0; i < s->size; i++) {
+        if (s->data[i].used) {
+            store_get (self->rows, s->data[i].row, &r);
+            str = r.asString(&r);
+            fprintf (stdout, "%s bucket=%lu dist=%u row=%lu record=%s\n", name, i, s->data[i].dist, s->data[i].row, str);
+            free (str);
         }
     }
 }
 
+void table_print (table *self) {
+    slots_print (self, &self->cur, "cur");
+    if (self->old.data) {
+        slots_print (self, &self->old, "old");
+    }
+}
+
 table *table_new (void) {
     table *t = calloc (1, sizeof (table));
     if (!t) {
-        LOG_ERROR(("Out of memory (table)"));
+        LOG_ERROR(("Out of memory (table)\n"));
         return NULL;
     }
 
-    t->data = calloc (NUM_BUCKETS, sizeof(node *));
-    if (!t->data) {
-        LOG_ERROR(("Out of memory (data)"));
+    if (slots_alloc (&t->cur, NUM_BUCKETS) != STATUS_OK) {
+        free (t);
+        return NULL;
+    }
+    t->rows = store_new ();
+    t->byTime = tindex_new ();
+    if (!t->rows || !t->byTime) {
+        if (t->rows) {
+            store_destroy (t->rows);
+        }
+        if (t->byTime) {
+            tindex_destroy (t->byTime);
+        }
+        free (t->cur.data);
+        free (t);
         return NULL;
     }
 
     t->getBucket = &table_getBucket;
     t->addRecord = &table_addRecord;
+    t->insertRecord = &table_insertRecord;
     t->removeRecord = &table_removeRecord;
     t->findRecord = &table_findRecord;
+    t->getRecord = &table_getRecord;
+    t->findRange = &table_findRange;
+    t->runQuery = &table_runQuery;
     t->clean = &table_clean;
     t->print = &table_print;
 
@@ -150,10 +522,17 @@ table *table_new (void) {
 }
 
 void table_destroy (table *self) {
-    if (self->data) {
+    if (self->cur.data) {
         self->clean(self);
-        free (self->data);
+        table_release (self, self->cur.data);
+    }
+    if (self->byTime) {
+        tindex_destroy (self->byTime);
+    }
+    if (self->rows) {
+        store_destroy (self->rows);
     }
+    free (self->owned);
     free (self);
 
     return;
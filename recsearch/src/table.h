@@ -1,47 +1,111 @@
 #ifndef _TABLE_H
 #define _TABLE_H
 #include "record.h"
+#include "status.h"
+#include "store.h"
+#include "shared.h"
+#include "tindex.h"
+#include "query.h"
 #include "log.h"
 
-typedef unsigned int bucket;
+typedef unsigned long bucket;
 
-/* default number of buckets */
+/* initial number of slots, always a power of 2 */
 #define NUM_BUCKETS 1024
 
-#define compEQ(a,b) (a == b)
+/* grow when more than this percentage of slots is used, robin hood
+ * probing keeps probe lengths short well past 80% */
+#define MAX_LOAD_PERCENT 85
 
-typedef enum {
-    STATUS_OK,
-    STATUS_NOT_FOUND,
-    STATUS_MEMORY_ERROR,
-    STATUS_UNKNOWN
-} status;
+/* old slots moved to the grown array per write, more when needed to
+ * finish a cluster, so growth never pauses for a full rehash */
+#define REHASH_STEP 16
 
-typedef struct node node;
 
-typedef struct node {
+typedef void (*visitor) (void *ctx, record *r);
+
+typedef struct slot slot;
+
+/* full keys are stored inline and compared field by field, a lookup
+ * touches one cache line in the common case, the record's fields are
+ * in the store at row */
+typedef struct slot {
     key key;
-    record *rec;
-    node *next;
-} node;
+    rowid row;
+    /* distance from the slot the key hashes to */
+    unsigned int dist;
+    unsigned int used;
+} slot;
+
+typedef struct slots slots;
+
+/* power of 2 array of slots */
+typedef struct slots {
+    slot *data;
+    bucket size;
+    bucket mask;
+    int shift;
+} slots;
 
 typedef struct table table;
 
+/* open addressing with robin hood probing: an insert takes the slot of
+ * any entry closer to its home than the new one, which bounds the
+ * variance of probe lengths, removal shifts the following entries back
+ * so no tombstones are needed.
+ *
+ * Growth is incremental: inserts go to the new array while each write
+ * moves whole clusters out of the old one, lookups check the new array
+ * then the old until it is empty. Clusters move whole and migration
+ * starts at an empty slot, so the old array only ever holds complete
+ * clusters and its probes stay valid. */
 typedef struct table {
-    node **data;
-    bucket (*getBucket) (key k);
+    slots cur;
+    slots old;
+    /* next old slot to move and old slots left to visit */
+    bucket cursor;
+    bucket remaining;
+    unsigned long count;
+    /* record fields by column, both indexes hold row ids */
+    store *rows;
+    /* ordered index on t for range scans */
+    tindex *byTime;
+    /* records handed out by addRecord and findRecord by row, freed
+     * with the row */
+    record **owned;
+    unsigned long ownedCapacity;
+    /* frees replaced slot arrays, NULL to free at once */
+    reclaimer *reclaim;
+    /* slot array the table uses but does not own, see table_adopt */
+    slot *borrowed;
+    bucket (*getBucket) (table *self, key k);
     status (*addRecord) (table *self, record *r);
+    status (*insertRecord) (table *self, record *r);
     status (*removeRecord) (table *self, key k);
     record *(*findRecord) (table *self, key k);
+    status (*getRecord) (table *self, key k, record *out);
+    unsigned long (*findRange) (table *self, time_t from, time_t to, visitor visit, void *ctx);
+    status (*runQuery) (table *self, query *q, result *res);
     void (*clean) (table *self);
     void (*print) (table *self);
 } table;
 
 
-bucket table_getBucket (key k);
+bucket table_getBucket (table *self, key k);
+long slots_lookup (slots *s, key k);
+void slots_copy (slots *dst, slots *src);
 status table_addRecord (table *self, record *r);
+status table_insertRecord (table *self, record *r);
+status table_reserve (table *self, unsigned long n);
+void table_settle (table *self);
+status table_adopt (table *self, slot *data, bucket size, unsigned long count);
+rowid table_findRow (table *self, key k);
 record *table_findRecord (table *self, key k);
+status table_getRecord (table *self, key k, record *out);
 status table_removeRecord (table *self, key k);
+unsigned long table_findRange (table *self, time_t from, time_t to, visitor visit, void *ctx);
+status table_runQuery (table *self, query *q, result *res);
+status table_compress (table *self);
 void table_clean (table *self);
 void table_print (table *self);
 table *table_new (void);
@@ -3,8 +3,14 @@
 #include <string.h>
 #include <math.h>
 #include <assert.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
 
 #include "table.h"
+#include "ctable.h"
+#include "ptable.h"
+#include "ingest.h"
 #include "log.h"
 
 int testAddAndRemove(void) {
@@ -25,13 +31,19 @@ int testAddAndRemove(void) {
 
     t->addRecord (t, r3);
 
+    /* the table keeps the records it was given */
+    if (t->findRecord (t, r1->getKey(r1)) != r1 || t->findRecord (t, r2->getKey(r2)) != r2) {
+        fprintf (stderr, "ERROR: findRecord did not return the added record\n");
+        failed++;
+    }
+
     fprintf (stdout, "DEBUG: printing out table\n");
     t->print(t);
 
-    fprintf (stdout, "DEBUG: removing record with key: %lu\n", k3);
+    fprintf (stdout, "DEBUG: removing record with key: t=%zu temp=%d relhum=%d\n", k3.t, k3.temp, k3.relhum);
     status s = t->removeRecord (t, k3);
     if (s != STATUS_OK) {
-        fprintf (stderr, "ERROR: could not remove record by key: %lu\n", k3);
+        fprintf (stderr, "ERROR: could not remove record by key hash: %lx\n", key_hash (k3));
         failed++;
     }
 
@@ -47,6 +59,771 @@ int testAddAndRemove(void) {
     return failed;
 }
 
+/* enough records to grow the table several times */
+#define NUM_RECORDS 200000
+
+int checkFound(table *t, int n) {
+    int failed = 0;
+    int i = 0;
+    record *r = NULL;
+
+    for (i = 0; i < n; i++) {
+        r = record_new (i, 1111220202 + i, 11.2 + (i % 7), 89.90);
+        record *found = t->findRecord (t, r->getKey(r));
+        if (!found || found->id != i) {
+            fprintf (stderr, "ERROR: record %d not found while growing\n", i);
+            failed++;
+        }
+        record_destroy (&r);
+    }
+
+    return failed;
+}
+
+int testGrowFindAndRemove(void) {
+    int failed = 0;
+    int i = 0;
+    table *t = table_new();
+    record *r = NULL;
+
+    for (i = 0; i < NUM_RECORDS; i++) {
+        r = record_new (i, 1111220202 + i, 11.2 + (i % 7), 89.90);
+        if (t->addRecord (t, r) != STATUS_OK) {
+            fprintf (stderr, "ERROR: could not add record: %d\n", i);
+            failed++;
+        }
+        /* while growing, every record must be in one of the arrays */
+        if (t->remaining && i % 1000 == 0) {
+            failed += checkFound (t, i + 1);
+        }
+    }
+    fprintf (stdout, "DEBUG: %lu records in %lu slots, %lu old slots to move\n", t->count, t->cur.size, t->remaining);
+
+    /* remove every other record, then the rest must still be found */
+    for (i = 0; i < NUM_RECORDS; i += 2) {
+        r = record_new (i, 1111220202 + i, 11.2 + (i % 7), 89.90);
+        if (t->removeRecord (t, r->getKey(r)) != STATUS_OK) {
+            fprintf (stderr, "ERROR: could not remove record: %d\n", i);
+            failed++;
+        }
+        record_destroy (&r);
+    }
+    for (i = 0; i < NUM_RECORDS; i++) {
+        r = record_new (i, 1111220202 + i, 11.2 + (i % 7), 89.90);
+        record *found = t->findRecord (t, r->getKey(r));
+        if ((i % 2 == 0) != (found == NULL) || (found && found->id != i)) {
+            fprintf (stderr, "ERROR: wrong lookup result for record: %d\n", i);
+            failed++;
+        }
+        record_destroy (&r);
+    }
+    if (t->count != NUM_RECORDS / 2 || t->rows->count != NUM_RECORDS / 2) {
+        fprintf (stderr, "ERROR: %lu records, %lu rows left, expected %d\n", t->count, t->rows->count, NUM_RECORDS / 2);
+        failed++;
+    }
+
+    /* removed rows are reused before the store grows */
+    for (i = 0; i < NUM_RECORDS; i += 2) {
+        t->addRecord (t, record_new (i, 1111220202 + i, 11.2 + (i % 7), 89.90));
+    }
+    if (t->rows->rows != NUM_RECORDS || t->rows->nfree) {
+        fprintf (stderr, "ERROR: %lu rows appended, %lu free, expected %d and 0\n", t->rows->rows, t->rows->nfree, NUM_RECORDS);
+        failed++;
+    }
+    failed += checkFound (t, NUM_RECORDS);
+
+    table_destroy(t);
+
+    return failed;
+}
+
+/* records per second of a day, inserted out of order */
+#define NUM_TIMES 86400
+#define T0 1111220202
+
+typedef struct scan {
+    time_t last;
+    int failed;
+} scan;
+
+void checkOrder(void *ctx, record *r) {
+    scan *sc = (scan *)ctx;
+
+    if (r->t < sc->last) {
+        fprintf (stderr, "ERROR: range scan out of order at t=%zu\n", r->t);
+        sc->failed++;
+    }
+    sc->last = r->t;
+}
+
+int testTimeRange(void) {
+    int failed = 0;
+    int i = 0;
+    unsigned long n = 0, expect = 0;
+    time_t from = 0, to = 0;
+    scan sc;
+    table *t = table_new();
+    record *r = NULL;
+
+    /* 7919 is prime so i * 7919 % NUM_TIMES visits every second once,
+     * every 10th time is added twice with another temperature */
+    for (i = 0; i < NUM_TIMES; i++) {
+        t->addRecord (t, record_new (i, T0 + (long)i * 7919 % NUM_TIMES, 11.2, 89.90));
+        if (i % 10 == 0) {
+            t->addRecord (t, record_new (i, T0 + (long)i * 7919 % NUM_TIMES, 12.2, 89.90));
+        }
+    }
+
+    for (from = T0 - 10; from < T0 + NUM_TIMES; from += 3607) {
+        to = from + 5000;
+        expect = 0;
+        for (i = 0; i < NUM_TIMES; i++) {
+            time_t ti = T0 + (long)i * 7919 % NUM_TIMES;
+            if (ti >= from && ti <= to) {
+                expect += (i % 10 == 0) ? 2 : 1;
+            }
+        }
+        sc.last = 0;
+        sc.failed = 0;
+        n = t->findRange (t, from, to, &checkOrder, &sc);
+        failed += sc.failed;
+        if (n != expect) {
+            fprintf (stderr, "ERROR: %lu records between %zu and %zu, expected %lu\n", n, from, to, expect);
+            failed++;
+        }
+    }
+
+    /* remove every duplicate, then each second holds one record */
+    for (i = 0; i < NUM_TIMES; i += 10) {
+        r = record_new (i, T0 + (long)i * 7919 % NUM_TIMES, 12.2, 89.90);
+        t->removeRecord (t, r->getKey(r));
+        record_destroy (&r);
+    }
+    n = t->findRange (t, T0, T0 + NUM_TIMES - 1, NULL, NULL);
+    if (n != NUM_TIMES) {
+        fprintf (stderr, "ERROR: %lu records after removal, expected %d\n", n, NUM_TIMES);
+        failed++;
+    }
+
+    table_destroy(t);
+
+    return failed;
+}
+
+/* a week of readings every 10 seconds, temp and relhum cycling */
+#define NUM_READINGS 60480
+#define HOUR 3600
+#define REMOVED_EVERY 97
+
+double readingTemp(int i) {
+    return -5.0 + (i * 37 % 400) / 10.0;
+}
+
+double readingRelhum(int i) {
+    return 20.0 + (i * 53 % 800) / 10.0;
+}
+
+int checkGroups(result *res, query *q, const char *kernel) {
+    int failed = 0;
+    int i = 0;
+    unsigned long g = 0, total = 0;
+    aggregate expect;
+
+    for (g = 0; g < res->ngroups; g++) {
+        memset (&expect, 0, sizeof (expect));
+        for (i = 0; i < NUM_READINGS; i++) {
+            time_t ti = T0 + (long)i * 10;
+            double temp = readingTemp (i), relhum = readingRelhum (i);
+            double v = q->agg == FIELD_TEMP ? temp : relhum;
+            if (i % REMOVED_EVERY == 0 || ti < q->from || ti > q->to || ti < res->groups[g].start ||
+                    (q->bucket && ti >= res->groups[g].start + q->bucket) ||
+                    temp < q->tempMin || temp > q->tempMax ||
+                    relhum < q->relhumMin || relhum > q->relhumMax) {
+                continue;
+            }
+            if (!expect.count || v < expect.min) {
+                expect.min = v;
+            }
+            if (!expect.count || v > expect.max) {
+                expect.max = v;
+            }
+            expect.sum += v;
+            expect.count++;
+        }
+        total += expect.count;
+        if (expect.count != res->groups[g].count ||
+                expect.min != res->groups[g].min || expect.max != res->groups[g].max ||
+                fabs (expect.sum - res->groups[g].sum) > 1e-6 * fabs (expect.sum) + 1e-9) {
+            fprintf (stderr, "ERROR: %s group %lu: count %lu min %g max %g sum %g, expected %lu %g %g %g\n",
+                kernel, g, res->groups[g].count, res->groups[g].min, res->groups[g].max, res->groups[g].sum,
+                expect.count, expect.min, expect.max, expect.sum);
+            failed++;
+        }
+    }
+    if (total != res->count) {
+        fprintf (stderr, "ERROR: %s %lu rows matched, expected %lu\n", kernel, res->count, total);
+        failed++;
+    }
+
+    return failed;
+}
+
+int testQuery(void) {
+    int failed = 0;
+    int i = 0, k = 0;
+    table *t = table_new();
+    record r;
+    query q;
+    result res;
+
+    for (i = 0; i < NUM_READINGS; i++) {
+        record_init (&r, i, T0 + (long)i * 10, readingTemp (i), readingRelhum (i));
+        t->insertRecord (t, &r);
+    }
+    /* removed rows must not be aggregated */
+    for (i = 0; i < NUM_READINGS; i += REMOVED_EVERY) {
+        record_init (&r, i, T0 + (long)i * 10, readingTemp (i), readingRelhum (i));
+        t->removeRecord (t, r.getKey(&r));
+    }
+
+    for (k = 0; k < 2; k++) {
+        /* whole table, one group */
+        query_init (&q);
+        q.noSimd = k;
+        t->runQuery (t, &q, &res);
+        failed += checkGroups (&res, &q, k ? "scalar" : "simd");
+        query_free (&res);
+
+        /* filtered, hourly relhum over a day and a bit */
+        query_init (&q);
+        q.noSimd = k;
+        q.from = T0 + 12345;
+        q.to = T0 + 12345 + 26 * HOUR;
+        q.tempMin = 10.0;
+        q.relhumMax = 60.0;
+        q.agg = FIELD_RELHUM;
+        q.bucket = HOUR;
+        t->runQuery (t, &q, &res);
+        if (res.ngroups != 27) {
+            fprintf (stderr, "ERROR: %lu hourly groups, expected 27\n", res.ngroups);
+            failed++;
+        }
+        failed += checkGroups (&res, &q, k ? "scalar" : "simd");
+        query_free (&res);
+    }
+    fprintf (stdout, "DEBUG: queries ran %s\n", query_simd () ? "AVX2 and scalar" : "scalar only");
+    table_destroy(t);
+
+    /* a span of centuries, too many minute groups but fine in wide buckets */
+    t = table_new();
+    record_init (&r, 1, -4000000000000000000L, 10.0, 50.0);
+    t->insertRecord (t, &r);
+    record_init (&r, 2, 4000000000000000000L, 20.0, 50.0);
+    t->insertRecord (t, &r);
+    query_init (&q);
+    q.bucket = 60;
+    if (t->runQuery (t, &q, &res) == STATUS_OK) {
+        fprintf (stderr, "ERROR: ran a query of %lu groups\n", res.ngroups);
+        failed++;
+    }
+    query_free (&res);
+    q.bucket = 4000000000000000000L;
+    if (t->runQuery (t, &q, &res) != STATUS_OK || res.ngroups != 3 || res.count != 2) {
+        fprintf (stderr, "ERROR: %lu groups of %lu rows over the widest span\n", res.ngroups, res.count);
+        failed++;
+    }
+    query_free (&res);
+
+    table_destroy(t);
+
+    return failed;
+}
+
+/* readings appended after compressing, filling more blocks */
+#define MORE_READINGS 10000
+#define REMOVED_PACKED_EVERY 89
+
+int sameGroups(result *a, result *b, const char *kernel) {
+    unsigned long g = 0;
+
+    if (a->ngroups != b->ngroups || a->count != b->count) {
+        fprintf (stderr, "ERROR: %s compressed query has %lu groups %lu rows, expected %lu %lu\n",
+            kernel, a->ngroups, a->count, b->ngroups, b->count);
+        return 1;
+    }
+    for (g = 0; g < a->ngroups; g++) {
+        if (a->groups[g].count != b->groups[g].count ||
+                fabs (a->groups[g].min - b->groups[g].min) > 1e-9 ||
+                fabs (a->groups[g].max - b->groups[g].max) > 1e-9 ||
+                fabs (a->groups[g].sum - b->groups[g].sum) > 1e-6) {
+            fprintf (stderr, "ERROR: %s compressed group %lu differs\n", kernel, g);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+int testCompression(void) {
+    int failed = 0;
+    int i = 0, k = 0;
+    table *raw = table_new();
+    table *t = table_new();
+    record r, found, expected;
+    status s;
+    query q;
+    result a, b;
+    unsigned long packed = 0, bytes = 0;
+
+    for (i = 0; i < NUM_READINGS; i++) {
+        record_init (&r, i, T0 + (long)i * 10, readingTemp (i), readingRelhum (i));
+        raw->insertRecord (raw, &r);
+        t->insertRecord (t, &r);
+    }
+    for (i = 0; i < NUM_READINGS; i += REMOVED_EVERY) {
+        record_init (&r, i, T0 + (long)i * 10, readingTemp (i), readingRelhum (i));
+        raw->removeRecord (raw, r.getKey(&r));
+        t->removeRecord (t, r.getKey(&r));
+    }
+    table_compress (t);
+    for (i = NUM_READINGS; i < NUM_READINGS + MORE_READINGS; i++) {
+        record_init (&r, i, T0 + (long)i * 10, readingTemp (i), readingRelhum (i));
+        raw->insertRecord (raw, &r);
+        t->insertRecord (t, &r);
+    }
+    for (i = 1; i < NUM_READINGS + MORE_READINGS; i += REMOVED_PACKED_EVERY) {
+        record_init (&r, i, T0 + (long)i * 10, readingTemp (i), readingRelhum (i));
+        if (raw->removeRecord (raw, r.getKey(&r)) != t->removeRecord (t, r.getKey(&r))) {
+            fprintf (stderr, "ERROR: removing %d from the compressed table\n", i);
+            failed++;
+        }
+    }
+
+    for (i = 0; i < NUM_READINGS + MORE_READINGS; i++) {
+        record_init (&r, i, T0 + (long)i * 10, readingTemp (i), readingRelhum (i));
+        s = t->getRecord (t, r.getKey(&r), &found);
+        if (s != raw->getRecord (raw, r.getKey(&r), &expected) ||
+                (s == STATUS_OK && (found.id != i || found.t != r.t || fabs (found.temp - r.temp) > 0.005))) {
+            fprintf (stderr, "ERROR: compressed table lost record %d\n", i);
+            failed++;
+            break;
+        }
+    }
+
+    for (k = 0; k < 2; k++) {
+        query_init (&q);
+        q.noSimd = k;
+        q.from = T0 + 12345;
+        q.tempMin = 0.0;
+        q.agg = FIELD_RELHUM;
+        q.bucket = HOUR;
+        raw->runQuery (raw, &q, &b);
+        t->runQuery (t, &q, &a);
+        failed += sameGroups (&a, &b, k ? "scalar" : "simd");
+        query_free (&a);
+        query_free (&b);
+    }
+
+    for (i = 0; i < (int)t->rows->nblocks; i++) {
+        packed += t->rows->packed[i] != NULL;
+    }
+    bytes = packed * sizeof (sblock);
+    if (packed != (NUM_READINGS + MORE_READINGS) / STORE_BLOCK || t->rows->packedBytes * 4 > bytes) {
+        fprintf (stderr, "ERROR: %lu blocks packed into %lu bytes\n", packed, t->rows->packedBytes);
+        failed++;
+    }
+    fprintf (stdout, "DEBUG: %lu blocks packed from %lu to %lu bytes\n", packed, bytes, t->rows->packedBytes);
+
+    table_destroy(raw);
+    table_destroy(t);
+
+    return failed;
+}
+
+/* keys equal under the old 17 * k + field folding, temp up by 0.01
+ * and relhum down by 0.17 */
+int testCollidingKeys(void) {
+    int failed = 0;
+    table *t = table_new();
+    record a, b;
+    record *found = NULL;
+
+    record_init (&a, 1, 1111220202, 11.20, 89.90);
+    record_init (&b, 2, 1111220202, 11.21, 89.73);
+    t->insertRecord (t, &a);
+    t->insertRecord (t, &b);
+
+    found = t->findRecord (t, a.getKey(&a));
+    if (!found || found->id != 1) {
+        fprintf (stderr, "ERROR: colliding key found the wrong record\n");
+        failed++;
+    }
+    if (t->removeRecord (t, b.getKey(&b)) != STATUS_OK) {
+        fprintf (stderr, "ERROR: could not remove colliding record\n");
+        failed++;
+    }
+    found = t->findRecord (t, a.getKey(&a));
+    if (!found || found->id != 1 || t->findRecord (t, b.getKey(&b))) {
+        fprintf (stderr, "ERROR: removing one colliding key removed the other\n");
+        failed++;
+    }
+
+    table_destroy(t);
+
+    return failed;
+}
+
+static void *enterOnce (void *arg) {
+    epoch *e = (epoch *)arg;
+    int slot = epoch_enter (e);
+
+    epoch_exit (e, slot);
+
+    return (void *)(long)slot;
+}
+
+/* threads that come and go one after another never run out of slots */
+int testEpochSlots(void) {
+    int failed = 0;
+    epoch *e = epoch_new();
+    pthread_t thread;
+    void *slot = NULL;
+    int i = 0;
+
+    for (i = 0; i < 3 * EPOCH_THREADS; i++) {
+        pthread_create (&thread, NULL, &enterOnce, e);
+        pthread_join (thread, &slot);
+        if ((long)slot < 0) {
+            fprintf (stderr, "ERROR: reader thread %d got no epoch slot\n", i);
+            failed++;
+            break;
+        }
+    }
+
+    epoch_destroy(e);
+
+    return failed;
+}
+
+/* keys below STABLE_KEYS stay while a writer churns the rest and grows
+ * the shards, readers must always find the stable ones intact */
+#define STABLE_KEYS 20000
+#define CHURN_KEYS 200000
+#define NUM_READERS 4
+
+typedef struct reader {
+    ctable *c;
+    int stop;
+    int failed;
+    unsigned long lookups;
+} reader;
+
+static void *readStable (void *arg) {
+    reader *rd = (reader *)arg;
+    record r, found;
+    int i = 0;
+
+    while (!__atomic_load_n (&rd->stop, __ATOMIC_ACQUIRE)) {
+        record_init (&r, i, 1111220202 + i, 11.2 + (i % 7), 89.90);
+        if (rd->c->findRecord (rd->c, r.getKey(&r), &found) != STATUS_OK ||
+                found.id != i || found.t != r.t) {
+            rd->failed++;
+        }
+        rd->lookups++;
+        i = (i + 7919) % STABLE_KEYS;
+    }
+
+    return NULL;
+}
+
+int testConcurrentReads(void) {
+    int failed = 0;
+    ctable *c = ctable_new(CTABLE_SHARDS);
+    reader readers[NUM_READERS];
+    pthread_t threads[NUM_READERS];
+    record r, found;
+    int i = 0;
+
+    for (i = 0; i < STABLE_KEYS; i++) {
+        record_init (&r, i, 1111220202 + i, 11.2 + (i % 7), 89.90);
+        c->insertRecord (c, &r);
+    }
+    for (i = 0; i < NUM_READERS; i++) {
+        memset (&readers[i], 0, sizeof (reader));
+        readers[i].c = c;
+        pthread_create (&threads[i], NULL, &readStable, &readers[i]);
+    }
+
+    for (i = STABLE_KEYS; i < CHURN_KEYS; i++) {
+        record_init (&r, i, 1111220202 + i, 11.2 + (i % 7), 89.90);
+        c->insertRecord (c, &r);
+        if (i % 3 == 0) {
+            c->removeRecord (c, r.getKey(&r));
+        }
+    }
+
+    for (i = 0; i < NUM_READERS; i++) {
+        __atomic_store_n (&readers[i].stop, 1, __ATOMIC_RELEASE);
+        pthread_join (threads[i], NULL);
+        if (readers[i].failed) {
+            fprintf (stderr, "ERROR: reader %d missed %d of %lu lookups\n", i, readers[i].failed, readers[i].lookups);
+            failed++;
+        }
+    }
+
+    for (i = STABLE_KEYS; i < CHURN_KEYS; i++) {
+        record_init (&r, i, 1111220202 + i, 11.2 + (i % 7), 89.90);
+        if ((c->findRecord (c, r.getKey(&r), &found) == STATUS_OK) != (i % 3 != 0)) {
+            fprintf (stderr, "ERROR: concurrent table has the wrong records after churn\n");
+            failed++;
+            break;
+        }
+    }
+    if (c->count(c) != STABLE_KEYS + (CHURN_KEYS - STABLE_KEYS) - (CHURN_KEYS - STABLE_KEYS + 2) / 3) {
+        fprintf (stderr, "ERROR: concurrent table counts %lu records\n", c->count(c));
+        failed++;
+    }
+    if (table_compress (c->shards[0].t) == STATUS_OK) {
+        fprintf (stderr, "ERROR: a ctable shard compressed its store\n");
+        failed++;
+    }
+
+    ctable_destroy(c);
+
+    return failed;
+}
+
+/* writes before and after a snapshot, one record removed in every
+ * PERSIST_REMOVED_EVERY */
+#define NUM_PERSISTED 50000
+#define PERSIST_REMOVED_EVERY 5
+
+typedef struct scanned {
+    time_t last;
+    unsigned long wrong;
+} scanned;
+
+static void checkScanned(void *ctx, record *r) {
+    scanned *s = (scanned *)ctx;
+
+    if (r->t != 1111220202 + r->id || r->t < s->last) {
+        s->wrong++;
+    }
+    s->last = r->t;
+}
+
+int checkPersisted(ptable *p, int n) {
+    int failed = 0;
+    int i = 0;
+    record r;
+    record *found = NULL;
+    scanned sc = { 0, 0 };
+
+    for (i = 0; i < n; i++) {
+        record_init (&r, i, 1111220202 + i, 11.2 + (i % 7), 89.90 - (i % 3));
+        found = p->findRecord (p, r.getKey(&r));
+        if ((found != NULL) != (i % PERSIST_REMOVED_EVERY != 0) ||
+                (found && (found->id != i || found->temp != r.temp))) {
+            fprintf (stderr, "ERROR: reopened table has the wrong record %d\n", i);
+            failed++;
+            break;
+        }
+    }
+    if (p->t->count != n - (n + PERSIST_REMOVED_EVERY - 1) / PERSIST_REMOVED_EVERY) {
+        fprintf (stderr, "ERROR: reopened table counts %lu records\n", p->t->count);
+        failed++;
+    }
+    /* the time index points at the rows the records landed in */
+    if (p->t->findRange (p->t, 0, 2 * 1111220202L, &checkScanned, &sc) != p->t->count || sc.wrong) {
+        fprintf (stderr, "ERROR: reopened table scans %lu wrong records by time\n", sc.wrong);
+        failed++;
+    }
+
+    return failed;
+}
+
+int testPersistence(void) {
+    int failed = 0;
+    char dir[] = "/tmp/recsearchXXXXXX";
+    char path[64];
+    ptable *p = NULL;
+    record r;
+    snapHeader h;
+    int i = 0, fd = -1;
+
+    if (!mkdtemp (dir)) {
+        fprintf (stderr, "ERROR: could not create a directory for the table\n");
+        return 1;
+    }
+
+    p = ptable_open (dir);
+    p->snapshotEvery = NUM_PERSISTED / 4;
+    for (i = 0; i < NUM_PERSISTED; i++) {
+        if (i == NUM_PERSISTED / 2) {
+            p->snapshot (p);
+        }
+        if (i % 1000 == 0) {
+            p->maintain (p);
+        }
+        record_init (&r, i, 1111220202 + i, 11.2 + (i % 7), 89.90 - (i % 3));
+        p->insertRecord (p, &r);
+        if (i % PERSIST_REMOVED_EVERY == 0) {
+            p->removeRecord (p, r.getKey(&r));
+        }
+    }
+    ptable_close (p);
+
+    /* snapshot and log */
+    p = ptable_open (dir);
+    failed += checkPersisted (p, NUM_PERSISTED);
+    p->snapshot (p);
+    ptable_close (p);
+
+    /* removed rows are compacted away */
+    sprintf (path, "%s/%s", dir, PTABLE_SNAPSHOT);
+    fd = open (path, O_RDONLY);
+    if (fd < 0 || read (fd, &h, sizeof (snapHeader)) != sizeof (snapHeader) ||
+            h.rows != h.count || h.nfree || h.count != NUM_PERSISTED - (NUM_PERSISTED + PERSIST_REMOVED_EVERY - 1) / PERSIST_REMOVED_EVERY) {
+        fprintf (stderr, "ERROR: snapshot is not compacted\n");
+        failed++;
+    }
+    close (fd);
+
+    /* snapshot only, then a log with a torn entry at the end */
+    sprintf (path, "%s/%s", dir, PTABLE_WAL);
+    fd = open (path, O_WRONLY | O_APPEND);
+    if (write (fd, "torn", 4) != 4) {
+        failed++;
+    }
+    close (fd);
+    p = ptable_open (dir);
+    failed += checkPersisted (p, NUM_PERSISTED);
+
+    /* the loaded table keeps growing and removing in the mapped snapshot */
+    for (i = NUM_PERSISTED; i < 4 * NUM_PERSISTED; i++) {
+        record_init (&r, i, 1111220202 + i, 11.2 + (i % 7), 89.90 - (i % 3));
+        p->insertRecord (p, &r);
+        if (i % PERSIST_REMOVED_EVERY == 0) {
+            p->removeRecord (p, r.getKey(&r));
+        }
+    }
+    failed += checkPersisted (p, 4 * NUM_PERSISTED);
+    ptable_close (p);
+
+    unlink (path);
+    sprintf (path, "%s/%s", dir, PTABLE_SNAPSHOT);
+    unlink (path);
+    rmdir (dir);
+
+    return failed;
+}
+
+/* enough CSV lines for several chunks */
+#define NUM_INGESTED 300000
+#define BAD_EVERY 1000
+
+int checkIngested(table *t, int n, const char *what) {
+    int failed = 0;
+    int i = 0;
+    record r;
+    record *found = NULL;
+
+    for (i = 0; i < n; i++) {
+        record_init (&r, i, 1111220202 + i, -5.25 + (i % 400) * 0.1, 40 + (i % 61) * 0.5);
+        found = t->findRecord (t, r.getKey(&r));
+        if (!found || found->id != i || fabs (found->temp - r.temp) > 1e-9) {
+            fprintf (stderr, "ERROR: %s ingest lost record %d\n", what, i);
+            failed++;
+            break;
+        }
+    }
+    if (t->count != (unsigned long)n) {
+        fprintf (stderr, "ERROR: %s ingest counts %lu records\n", what, t->count);
+        failed++;
+    }
+
+    return failed;
+}
+
+int testIngest(void) {
+    int failed = 0;
+    char path[] = "/tmp/recsearchXXXXXX";
+    const char *numbers[] = {"0.5", "-12.75", "3.14159", "1e3", "-2.5E-2", "123456789012345678901.5", "7", ".25"};
+    const char *bad[] = {"", "-", "1.2.3", "12a", "."};
+    ingestStats stats;
+    record *rows = NULL;
+    table *t = NULL;
+    FILE *f = NULL;
+    double v = 0.0;
+    int i = 0, fd = -1;
+
+    for (i = 0; i < (int)(sizeof (numbers) / sizeof (numbers[0])); i++) {
+        if (!ingest_parseDouble (numbers[i], numbers[i] + strlen (numbers[i]), &v) || v != strtod (numbers[i], NULL)) {
+            fprintf (stderr, "ERROR: parsed %s as %.17g\n", numbers[i], v);
+            failed++;
+        }
+    }
+    for (i = 0; i < (int)(sizeof (bad) / sizeof (bad[0])); i++) {
+        if (ingest_parseDouble (bad[i], bad[i] + strlen (bad[i]), &v)) {
+            fprintf (stderr, "ERROR: parsed '%s' as a number\n", bad[i]);
+            failed++;
+        }
+    }
+
+    fd = mkstemp (path);
+    f = fdopen (fd, "w");
+    fprintf (f, "id,t,temp,relhum\n");
+    for (i = 0; i < NUM_INGESTED; i++) {
+        fprintf (f, i % 2 ? "%d,%d,%.2f,%.1f\n" : "%d,%d,%.2f,%.1f\r\n",
+            i, 1111220202 + i, -5.25 + (i % 400) * 0.1, 40 + (i % 61) * 0.5);
+        if (i % BAD_EVERY == 0) {
+            fprintf (f, "%d,oops,1.0\n\n", i);
+        }
+    }
+    fclose (f);
+
+    t = table_new();
+    if (ingest_file (t, path, INGEST_CSV, 4, &stats) != STATUS_OK ||
+            stats.bad != NUM_INGESTED / BAD_EVERY) {
+        fprintf (stderr, "ERROR: CSV ingest failed, %lu bad lines\n", stats.bad);
+        failed++;
+    }
+    failed += checkIngested (t, NUM_INGESTED, "CSV");
+    table_destroy(t);
+
+    rows = malloc (NUM_INGESTED * sizeof (record));
+    for (i = 0; i < NUM_INGESTED; i++) {
+        record_init (&rows[i], i, 1111220202 + i, -5.25 + (i % 400) * 0.1, 40 + (i % 61) * 0.5);
+    }
+    ingest_writeBinary (path, rows, NUM_INGESTED);
+    free (rows);
+
+    t = table_new();
+    if (ingest_file (t, path, INGEST_BINARY, 4, &stats) != STATUS_OK || stats.rows != NUM_INGESTED) {
+        fprintf (stderr, "ERROR: binary ingest failed\n");
+        failed++;
+    }
+    failed += checkIngested (t, NUM_INGESTED, "binary");
+    table_destroy(t);
+
+    unlink (path);
+
+    return failed;
+}
+
 int main (int argc, char **argv) {
-    return testAddAndRemove();
+    int failed = 0;
+
+    failed += testAddAndRemove();
+    failed += testGrowFindAndRemove();
+    failed += testTimeRange();
+    failed += testQuery();
+    failed += testCompression();
+    failed += testCollidingKeys();
+    failed += testEpochSlots();
+    failed += testConcurrentReads();
+    failed += testPersistence();
+    failed += testIngest();
+
+    return failed;
 }
@@ -0,0 +1,269 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tindex.h"
+
+/* first block that can hold t: the last one starting at or before t,
+ * or before it when equal times may run back into the previous block */
+static unsigned long tindex_block (tindex *self, time_t t) {
+    unsigned long lo = 0, hi = self->nblocks;
+    unsigned long mid;
+
+    /* first block starting at or after t */
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (self->first[mid] < t) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return lo ? lo - 1 : 0;
+}
+
+/* first entry in b with time >= t, or > t when after is set */
+static unsigned long tblock_search (tblock *b, time_t t, int after) {
+    unsigned long lo = 0, hi = b->count;
+    unsigned long mid;
+
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (b->entries[mid].t < t || (after && b->entries[mid].t == t)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+/* open a gap for a block at position i */
+static status tindex_insertBlock (tindex *self, unsigned long i, tblock *b) {
+    tblock **blocks = NULL;
+    time_t *first = NULL;
+    unsigned long n = self->nblocks - i;
+
+    if (self->nblocks == self->capacity) {
+        blocks = realloc (self->blocks, 2 * self->capacity * sizeof (tblock *));
+        if (!blocks) {
+            LOG_ERROR(("Out of memory (index blocks)\n"));
+            return STATUS_MEMORY_ERROR;
+        }
+        self->blocks = blocks;
+        first = realloc (self->first, 2 * self->capacity * sizeof (time_t));
+        if (!first) {
+            LOG_ERROR(("Out of memory (index)\n"));
+            return STATUS_MEMORY_ERROR;
+        }
+        self->first = first;
+        self->capacity *= 2;
+    }
+    memmove (&self->blocks[i + 1], &self->blocks[i], n * sizeof (tblock *));
+    memmove (&self->first[i + 1], &self->first[i], n * sizeof (time_t));
+    self->blocks[i] = b;
+    self->first[i] = b->count ? b->entries[0].t : 0;
+    self->nblocks++;
+
+    return STATUS_OK;
+}
+
+static void tindex_removeBlock (tindex *self, unsigned long i) {
+    unsigned long n = self->nblocks - i - 1;
+
+    slab_free (&self->alloc, self->blocks[i]);
+    memmove (&self->blocks[i], &self->blocks[i + 1], n * sizeof (tblock *));
+    memmove (&self->first[i], &self->first[i + 1], n * sizeof (time_t));
+    self->nblocks--;
+}
+
+status tindex_add (tindex *self, time_t t, rowid row) {
+    tblock *b = NULL, *split = NULL;
+    unsigned long i, pos, half;
+    status s;
+
+    if (!self->nblocks) {
+        b = slab_alloc (&self->alloc);
+        if (!b) {
+            return STATUS_MEMORY_ERROR;
+        }
+        b->count = 0;
+        s = tindex_insertBlock (self, 0, b);
+        if (s != STATUS_OK) {
+            slab_free (&self->alloc, b);
+            return s;
+        }
+    }
+
+    /* last block starting at or before t, equal times go after the
+     * ones already indexed */
+    i = tindex_block (self, t);
+    while (i + 1 < self->nblocks && self->first[i + 1] <= t) {
+        i++;
+    }
+    b = self->blocks[i];
+
+    if (b->count == TINDEX_BLOCK) {
+        /* split, the upper half goes to a new block after this one */
+        split = slab_alloc (&self->alloc);
+        if (!split) {
+            return STATUS_MEMORY_ERROR;
+        }
+        half = b->count / 2;
+        split->count = b->count - half;
+        memcpy (split->entries, &b->entries[half], split->count * sizeof (tentry));
+        s = tindex_insertBlock (self, i + 1, split);
+        if (s != STATUS_OK) {
+            slab_free (&self->alloc, split);
+            return s;
+        }
+        b->count = half;
+        if (t >= split->entries[0].t) {
+            b = split;
+            i++;
+        }
+    }
+
+    pos = tblock_search (b, t, 1);
+    memmove (&b->entries[pos + 1], &b->entries[pos], (b->count - pos) * sizeof (tentry));
+    b->entries[pos].t = t;
+    b->entries[pos].row = row;
+    b->count++;
+    self->first[i] = b->entries[0].t;
+    self->count++;
+
+    return STATUS_OK;
+}
+
+status tindex_remove (tindex *self, time_t t, rowid row) {
+    tblock *b = NULL;
+    unsigned long i, pos;
+
+    /* equal times may span blocks, walk them for this row */
+    for (i = tindex_block (self, t); i < self->nblocks && self->first[i] <= t; i++) {
+        b = self->blocks[i];
+        for (pos = tblock_search (b, t, 0); pos < b->count && b->entries[pos].t == t; pos++) {
+            if (b->entries[pos].row != row) {
+                continue;
+            }
+            memmove (&b->entries[pos], &b->entries[pos + 1], (b->count - pos - 1) * sizeof (tentry));
+            b->count--;
+            self->count--;
+            if (!b->count) {
+                tindex_removeBlock (self, i);
+            } else {
+                self->first[i] = b->entries[0].t;
+            }
+            return STATUS_OK;
+        }
+    }
+
+    return STATUS_NOT_FOUND;
+}
+
+/* visit rows with from <= t <= to in time order, returns how many */
+unsigned long tindex_scan (tindex *self, time_t from, time_t to, rowVisitor visit, void *ctx) {
+    tblock *b = NULL;
+    unsigned long i, pos, n = 0;
+
+    if (!self->nblocks || from > to) {
+        return 0;
+    }
+    i = tindex_block (self, from);
+    pos = tblock_search (self->blocks[i], from, 0);
+    for (; i < self->nblocks; i++, pos = 0) {
+        b = self->blocks[i];
+        for (; pos < b->count; pos++) {
+            if (b->entries[pos].t > to) {
+                return n;
+            }
+            if (visit) {
+                visit (ctx, b->entries[pos].row);
+            }
+            n++;
+        }
+    }
+
+    return n;
+}
+
+/* use the n blocks at blocks, in time order, only while the index is
+ * empty. They are written to but never freed, see ptable */
+status tindex_adopt (tindex *self, tblock *blocks, unsigned long n) {
+    tblock **ptrs = NULL;
+    time_t *first = NULL;
+    unsigned long capacity = self->capacity, i;
+
+    if (self->nblocks) {
+        return STATUS_UNKNOWN;
+    }
+    while (capacity < n) {
+        capacity *= 2;
+    }
+    ptrs = malloc (capacity * sizeof (tblock *));
+    first = malloc (capacity * sizeof (time_t));
+    if (!ptrs || !first) {
+        LOG_ERROR(("Out of memory (index blocks)\n"));
+        free (ptrs);
+        free (first);
+        return STATUS_MEMORY_ERROR;
+    }
+    self->count = 0;
+    for (i = 0; i < n; i++) {
+        if (!blocks[i].count || blocks[i].count > TINDEX_BLOCK) {
+            free (ptrs);
+            free (first);
+            self->count = 0;
+            return STATUS_UNKNOWN;
+        }
+        ptrs[i] = &blocks[i];
+        first[i] = blocks[i].entries[0].t;
+        self->count += blocks[i].count;
+    }
+    free (self->blocks);
+    free (self->first);
+    self->blocks = ptrs;
+    self->first = first;
+    self->capacity = capacity;
+    self->nblocks = n;
+
+    return STATUS_OK;
+}
+
+/* drop every entry, the rows belong to the store */
+void tindex_clean (tindex *self) {
+    slab_destroy (&self->alloc);
+    self->nblocks = 0;
+    self->count = 0;
+}
+
+tindex *tindex_new (void) {
+    tindex *x = calloc (1, sizeof (tindex));
+    if (!x) {
+        LOG_ERROR(("Out of memory (index)\n"));
+        return NULL;
+    }
+
+    x->blocks = calloc (TINDEX_BLOCKS, sizeof (tblock *));
+    x->first = calloc (TINDEX_BLOCKS, sizeof (time_t));
+    if (!x->blocks || !x->first) {
+        LOG_ERROR(("Out of memory (index blocks)\n"));
+        free (x->blocks);
+        free (x->first);
+        free (x);
+        return NULL;
+    }
+    x->capacity = TINDEX_BLOCKS;
+    slab_init (&x->alloc, sizeof (tblock), TINDEX_CHUNK);
+
+    return x;
+}
+
+void tindex_destroy (tindex *self) {
+    tindex_clean (self);
+    free (self->blocks);
+    free (self->first);
+    free (self);
+}
@@ -0,0 +1,58 @@
+#ifndef _TINDEX_H
+#define _TINDEX_H
+#include "store.h"
+#include "status.h"
+#include "log.h"
+
+/* entries per block, inserts shift at most this many entries */
+#define TINDEX_BLOCK 512
+
+/* initial number of blocks */
+#define TINDEX_BLOCKS 16
+
+/* blocks per slab chunk */
+#define TINDEX_CHUNK 64
+
+typedef void (*rowVisitor) (void *ctx, rowid row);
+
+typedef struct tentry tentry;
+
+typedef struct tentry {
+    time_t t;
+    rowid row;
+} tentry;
+
+typedef struct tblock tblock;
+
+/* entries sorted by t, equal times in insertion order */
+typedef struct tblock {
+    unsigned long count;
+    tentry entries[TINDEX_BLOCK];
+} tblock;
+
+typedef struct tindex tindex;
+
+/* ordered index on record time: a sorted array of blocks and a sparse
+ * index of the first time in each block. A lookup is a binary search
+ * over the sparse index then one within a block, range scans then walk
+ * the blocks in order. Full blocks split in two, empty blocks are
+ * dropped, so out of order inserts only move entries within a block
+ * and, on a split, the block pointers after it. */
+typedef struct tindex {
+    tblock **blocks;
+    time_t *first;
+    unsigned long nblocks;
+    unsigned long capacity;
+    unsigned long count;
+    /* blocks, freed ones are reused by the next split */
+    slab alloc;
+} tindex;
+
+tindex *tindex_new (void);
+status tindex_add (tindex *self, time_t t, rowid row);
+status tindex_remove (tindex *self, time_t t, rowid row);
+unsigned long tindex_scan (tindex *self, time_t from, time_t to, rowVisitor visit, void *ctx);
+status tindex_adopt (tindex *self, tblock *blocks, unsigned long n);
+void tindex_clean (tindex *self);
+void tindex_destroy (tindex *self);
+#endif
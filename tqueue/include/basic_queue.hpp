@@ -0,0 +1,255 @@
+#pragma once
+
+#include <queue>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <optional>
+#include <chrono>
+#include <thread>
+#include <stop_token>
+#include <ranges>
+
+#include "queue_fwd.hpp"
+
+/**
+ * @brief Basic threadsafe queue
+ *
+ * Unbounded by default. Given a capacity, enqueue blocks while the queue is
+ * full so producers are throttled to the pace of the consumers.
+ */
+template <class T>
+class TQueue<T, tqueue::locked>
+{
+public:
+    TQueue() : TQueue(0)
+    {}
+
+    explicit TQueue(std::size_t capacity)
+    : shutdown_flag(false), queue(std::make_unique<std::queue<T>>()), max_entries(capacity)
+    {}
+
+    ~TQueue()
+    {
+        shutdown();
+    }
+
+    void shutdown()
+    {
+        if (shutdown_flag.load())
+        {
+            return;
+        }
+        shutdown_flag.store(true);
+        // waiters check the flag under the lock, take it so none misses the wakeup
+        std::lock_guard<std::mutex> lock(mutex);
+        has_entries.notify_all();
+        has_space.notify_all();
+    }
+
+    /**
+     * @brief Add an entry, waiting for space when bounded
+     * @return false if the queue was shut down while full, the entry is left untouched
+     */
+    bool enqueue(T&& entry)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        has_space.wait(lock, [this]()
+        {
+            return has_room() || shutdown_flag.load();
+        });
+        return push(std::move(entry));
+    }
+
+    /**
+     * @brief Add an entry only if there is room for it right now
+     */
+    bool try_enqueue(T&& entry)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return has_room() && push(std::move(entry));
+    }
+
+    /**
+     * @brief Add an entry, waiting at most timeout for space
+     */
+    template <class Rep, class Period>
+    bool enqueue_for(T&& entry, const std::chrono::duration<Rep, Period>& timeout)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        has_space.wait_for(lock, timeout, [this]()
+        {
+            return has_room() || shutdown_flag.load();
+        });
+        return has_room() && push(std::move(entry));
+    }
+
+    /**
+     * @brief Move every entry of a range in under one lock and wake consumers once
+     *
+     * When bounded the batch waits for space as it goes, entries already added
+     * are handed to consumers first so they can drain the queue.
+     * @return number of entries added, short only if the queue was shut down
+     */
+    template <std::ranges::input_range R>
+    std::size_t enqueue_bulk(R&& entries)
+    {
+        std::size_t count = 0;
+        std::unique_lock<std::mutex> lock(mutex);
+        for (auto&& entry : entries)
+        {
+            if (!has_room())
+            {
+                has_entries.notify_all();
+                has_space.wait(lock, [this]()
+                {
+                    return has_room() || shutdown_flag.load();
+                });
+                if (!has_room())
+                {
+                    break;
+                }
+            }
+            queue->push(std::move(entry));
+            count++;
+        }
+        if (count == 1)
+        {
+            has_entries.notify_one();
+        }
+        else if (count > 1)
+        {
+            has_entries.notify_all();
+        }
+        return count;
+    }
+
+    std::optional<T> dequeue()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return pop();
+    }
+
+    /**
+     * @brief Take the oldest entry, waiting at most timeout for one to arrive
+     */
+    template <class Rep, class Period>
+    std::optional<T> dequeue_for(const std::chrono::duration<Rep, Period>& timeout)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        has_entries.wait_for(lock, timeout, [this]()
+        {
+            return !queue->empty() || shutdown_flag.load();
+        });
+        return pop();
+    }
+
+    /**
+     * @brief Move up to max entries to out under one lock
+     * @return number of entries written
+     */
+    template <class OutputIt>
+    std::size_t dequeue_bulk(OutputIt out, std::size_t max)
+    {
+        std::size_t count = 0;
+        std::lock_guard<std::mutex> lock(mutex);
+        while (count < max && !queue->empty())
+        {
+            *out++ = std::move(queue->front());
+            queue->pop();
+            count++;
+        }
+        if (count > 0 && max_entries > 0)
+        {
+            has_space.notify_all();
+        }
+        return count;
+    }
+
+    void wait_for_entry_or_shutdown() const
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        has_entries.wait(lock, [this]()
+        {
+            return !queue->empty() || shutdown_flag.load();
+        });
+    }
+
+    void wait_for_entry(std::stop_token stop) const
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        has_entries.wait(lock, stop, [this]()
+        {
+            return !queue->empty();
+        });
+    }
+
+    /**
+     * @brief Wait at most timeout for an entry
+     * @return true if an entry is available or the queue was shut down
+     */
+    template <class Rep, class Period>
+    bool wait_for_entry_for(const std::chrono::duration<Rep, Period>& timeout) const
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        return has_entries.wait_for(lock, timeout, [this]()
+        {
+            return !queue->empty() || shutdown_flag.load();
+        });
+    }
+
+    std::size_t size() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return queue->size();
+    }
+
+    /**
+     * @brief Maximum number of entries, 0 when unbounded
+     */
+    std::size_t capacity() const
+    {
+        return max_entries;
+    }
+
+private:
+    bool has_room() const
+    {
+        return max_entries == 0 || queue->size() < max_entries;
+    }
+
+    // callers hold the lock
+    bool push(T&& entry)
+    {
+        if (!has_room())
+        {
+            return false;
+        }
+        queue->push(std::move(entry));
+        has_entries.notify_one();
+        return true;
+    }
+
+    std::optional<T> pop()
+    {
+        std::optional<T> entry;
+        if (!queue->empty())
+        {
+            entry.emplace(std::move(queue->front()));
+            queue->pop();
+            if (max_entries > 0)
+            {
+                has_space.notify_one();
+            }
+        }
+        return entry;
+    }
+
+private:
+    mutable std::mutex mutex;
+    mutable std::condition_variable has_entries;
+    std::condition_variable has_space;
+    std::atomic_bool shutdown_flag;
+    std::unique_ptr<std::queue<T>> queue;
+    const std::size_t max_entries;
+};
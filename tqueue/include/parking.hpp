@@ -0,0 +1,143 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
+#if defined(__SANITIZE_THREAD__)
+#define TQUEUE_TSAN 1
+#elif defined(__has_feature)
+#if __has_feature(thread_sanitizer)
+#define TQUEUE_TSAN 1
+#endif
+#endif
+
+namespace tqueue
+{
+constexpr std::size_t cache_line_size = 64;
+
+/**
+ * @brief Back off while spinning, pause for the first rounds then yield the core
+ */
+inline void spin_relax(int round)
+{
+    if (round < 16)
+    {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+        _mm_pause();
+#endif
+        return;
+    }
+    std::this_thread::yield();
+}
+
+/**
+ * @brief Parking spot for threads waiting on a queue condition
+ *
+ * Waiters spin for a few rounds then sleep on a condition variable. Wakers
+ * only take its mutex when someone is actually asleep, so the fast path
+ * costs a fence and never enters the kernel.
+ */
+class Parking
+{
+public:
+    template <class Ready>
+    void wait(Ready ready) const
+    {
+        if (spin(ready))
+        {
+            return;
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        enter();
+        condition.wait(lock, ready);
+        sleepers.fetch_sub(1);
+    }
+
+    /**
+     * @brief Wait until ready or the deadline passes
+     * @return the last value of ready
+     */
+    template <class Ready, class Clock, class Duration>
+    bool wait_until(Ready ready, const std::chrono::time_point<Clock, Duration>& deadline) const
+    {
+        if (spin(ready))
+        {
+            return true;
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        enter();
+        bool done = condition.wait_until(lock, deadline, ready);
+        sleepers.fetch_sub(1);
+        return done;
+    }
+
+    void wake_one() const
+    {
+        if (asleep())
+        {
+            // a sleeper between its last check and the wait still holds the mutex
+            std::lock_guard<std::mutex> lock(mutex);
+            condition.notify_one();
+        }
+    }
+
+    void wake_all() const
+    {
+        if (asleep())
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            condition.notify_all();
+        }
+    }
+
+private:
+    template <class Ready>
+    static bool spin(Ready& ready)
+    {
+        for (int round = 0; round < spin_rounds; round++)
+        {
+            if (ready())
+            {
+                return true;
+            }
+            spin_relax(round);
+        }
+        return false;
+    }
+
+    // announce ourselves before the last check, a waker either sees the
+    // sleeper or the condition already holds for us
+    void enter() const
+    {
+        sleepers.fetch_add(1);
+#ifndef TQUEUE_TSAN
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+#endif
+    }
+
+    bool asleep() const
+    {
+#ifdef TQUEUE_TSAN
+        // tsan does not model fences, a read-modify-write orders the same way
+        return sleepers.fetch_add(0) != 0;
+#else
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return sleepers.load(std::memory_order_relaxed) != 0;
+#endif
+    }
+
+    static constexpr int spin_rounds = 64;
+    alignas(cache_line_size) mutable std::atomic<std::uint32_t> sleepers{0};
+    mutable std::mutex mutex;
+    mutable std::condition_variable condition;
+};
+}
@@ -0,0 +1,498 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ranges>
+#include <stop_token>
+#include <utility>
+#include <vector>
+
+#include "queue_fwd.hpp"
+
+/**
+ * @brief Threadsafe priority queue with per entry deadlines
+ *
+ * Entries come out highest priority first, Compare orders them the way
+ * std::priority_queue does so compare(a, b) means a ranks below b. Equal
+ * entries keep their arrival order. An entry whose deadline has passed is
+ * dropped when it reaches the front instead of being handed to a consumer,
+ * the expiry handler gets it if one is set.
+ *
+ * Backed by a 4-ary heap, shallower than a binary one and its children
+ * share a cache line or two, which pays off for sift down on every dequeue.
+ * Entries sit behind pointers so T only has to be move constructible.
+ */
+template <class T, class Compare>
+class TQueue<T, tqueue::priority<Compare>>
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    TQueue() : TQueue(0)
+    {}
+
+    explicit TQueue(std::size_t capacity, Compare compare = Compare())
+    : shutdown_flag(false), compare(std::move(compare)), max_entries(capacity)
+    {}
+
+    ~TQueue()
+    {
+        shutdown();
+    }
+
+    void shutdown()
+    {
+        if (shutdown_flag.exchange(true))
+        {
+            return;
+        }
+        // waiters check the flag under the lock, take it so none misses the wakeup
+        std::lock_guard<std::mutex> lock(mutex);
+        has_entries.notify_all();
+        has_space.notify_all();
+    }
+
+    bool is_shutdown() const
+    {
+        return shutdown_flag.load();
+    }
+
+    /**
+     * @brief Set the handler given entries dropped for passing their deadline
+     *
+     * Called on the dequeuing thread outside the queue lock.
+     */
+    void on_expired(std::function<void(T&&)> handler)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        expired_handler = std::move(handler);
+    }
+
+    bool enqueue(T&& entry)
+    {
+        return enqueue(std::move(entry), clock::time_point::max());
+    }
+
+    /**
+     * @brief Add an entry that expires at deadline, waiting for space when bounded
+     *
+     * Waits no longer than the deadline, an entry that cannot be queued
+     * before it passes would only be dropped on the way out.
+     * @return false if the queue was shut down or the deadline passed while
+     * full, the entry is left untouched
+     */
+    bool enqueue(T&& entry, clock::time_point deadline)
+    {
+        return enqueue_until(std::move(entry), deadline, deadline);
+    }
+
+    bool try_enqueue(T&& entry, clock::time_point deadline = clock::time_point::max())
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return has_room() && push(std::move(entry), deadline);
+    }
+
+    /**
+     * @brief Add an entry, waiting at most timeout for space
+     */
+    template <class Rep, class Period>
+    bool enqueue_for(T&& entry, const std::chrono::duration<Rep, Period>& timeout,
+                     clock::time_point deadline = clock::time_point::max())
+    {
+        auto until = clock::now() + timeout;
+        return enqueue_until(std::move(entry), deadline < until ? deadline : until, deadline);
+    }
+
+    /**
+     * @brief Move every entry of a range in under one lock and wake consumers once
+     *
+     * Entries have no deadline. When bounded the batch waits for space as it
+     * goes, entries already added are handed to consumers first.
+     * @return number of entries added, short only if the queue was shut down
+     */
+    template <std::ranges::input_range R>
+    std::size_t enqueue_bulk(R&& entries)
+    {
+        std::size_t count = 0;
+        std::unique_lock<std::mutex> lock(mutex);
+        for (auto&& entry : entries)
+        {
+            if (!has_room())
+            {
+                has_entries.notify_all();
+                has_space.wait(lock, [this]()
+                {
+                    return has_room() || shutdown_flag.load();
+                });
+                if (!has_room())
+                {
+                    break;
+                }
+            }
+            heap.push_back(std::make_unique<Entry>(Entry{std::move(entry), clock::time_point::max(), next_order++}));
+            sift_up(heap.size() - 1);
+            count++;
+        }
+        if (count == 1)
+        {
+            has_entries.notify_one();
+        }
+        else if (count > 1)
+        {
+            has_entries.notify_all();
+        }
+        return count;
+    }
+
+    /**
+     * @brief Take the highest priority entry still within its deadline, never blocks
+     */
+    std::optional<T> dequeue()
+    {
+        std::vector<T> expired;
+        std::optional<T> entry;
+        std::function<void(T&&)> handler;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pop(entry, expired);
+            if (!expired.empty())
+            {
+                handler = expired_handler;
+            }
+        }
+        report(expired, handler);
+        return entry;
+    }
+
+    /**
+     * @brief Take the highest priority live entry, waiting at most timeout for one
+     *
+     * Entries still queued after shutdown are handed out until the heap is empty.
+     */
+    template <class Rep, class Period>
+    std::optional<T> dequeue_for(const std::chrono::duration<Rep, Period>& timeout)
+    {
+        return dequeue_until(clock::now() + timeout);
+    }
+
+    /**
+     * @brief Take the highest priority live entry, waiting for one unless the queue is shut down
+     */
+    std::optional<T> dequeue_wait()
+    {
+        return dequeue_until(clock::time_point::max());
+    }
+
+    /**
+     * @brief Move up to max of the highest priority live entries to out under one lock
+     * @return number of entries written
+     */
+    template <class OutputIt>
+    std::size_t dequeue_bulk(OutputIt out, std::size_t max)
+    {
+        std::size_t count = 0;
+        std::vector<T> expired;
+        std::function<void(T&&)> handler;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            std::optional<T> entry;
+            while (count < max && !heap.empty())
+            {
+                pop(entry, expired);
+                if (!entry.has_value())
+                {
+                    break;
+                }
+                *out++ = std::move(*entry);
+                entry.reset();
+                count++;
+            }
+            if (!expired.empty())
+            {
+                handler = expired_handler;
+            }
+        }
+        report(expired, handler);
+        return count;
+    }
+
+    void wait_for_entry_or_shutdown() const
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        has_entries.wait(lock, [this]()
+        {
+            return !heap.empty() || shutdown_flag.load();
+        });
+    }
+
+    void wait_for_entry(std::stop_token stop) const
+    {
+        // taking the lock first means the waiter is either parked or has yet to check stop
+        std::stop_callback on_stop(stop, [this]()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            has_entries.notify_all();
+        });
+        std::unique_lock<std::mutex> lock(mutex);
+        has_entries.wait(lock, [this, &stop]()
+        {
+            return !heap.empty() || stop.stop_requested();
+        });
+    }
+
+    /**
+     * @brief Wait at most timeout for an entry
+     * @return true if an entry is queued or the queue was shut down
+     */
+    template <class Rep, class Period>
+    bool wait_for_entry_for(const std::chrono::duration<Rep, Period>& timeout) const
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        return has_entries.wait_for(lock, timeout, [this]()
+        {
+            return !heap.empty() || shutdown_flag.load();
+        });
+    }
+
+    /**
+     * @brief Number of queued entries, including any not yet found expired
+     */
+    std::size_t size() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return heap.size();
+    }
+
+    std::size_t capacity() const
+    {
+        return max_entries;
+    }
+
+    /**
+     * @brief Total number of entries dropped for passing their deadline
+     */
+    std::uint64_t expired_count() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return expired_total;
+    }
+
+private:
+    struct Entry
+    {
+        T value;
+        clock::time_point deadline;
+        std::uint64_t order;
+    };
+    using Slot = std::unique_ptr<Entry>;
+
+    static constexpr std::size_t arity = 4;
+
+    bool has_room() const
+    {
+        return max_entries == 0 || heap.size() < max_entries;
+    }
+
+    // wait for space until limit, then queue the entry to expire at deadline
+    bool enqueue_until(T&& entry, clock::time_point limit, clock::time_point deadline)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        auto ready = [this]()
+        {
+            return has_room() || shutdown_flag.load();
+        };
+        if (limit == clock::time_point::max())
+        {
+            has_space.wait(lock, ready);
+        }
+        else
+        {
+            has_space.wait_until(lock, limit, ready);
+        }
+        return push(std::move(entry), deadline);
+    }
+
+    std::optional<T> dequeue_until(clock::time_point deadline)
+    {
+        std::vector<T> expired;
+        std::optional<T> entry;
+        std::function<void(T&&)> handler;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            auto ready = [this]()
+            {
+                return !heap.empty() || shutdown_flag.load();
+            };
+            for (;;)
+            {
+                pop(entry, expired);
+                if (entry.has_value() || shutdown_flag.load())
+                {
+                    break;
+                }
+                if (deadline == clock::time_point::max())
+                {
+                    has_entries.wait(lock, ready);
+                }
+                else if (!has_entries.wait_until(lock, deadline, ready))
+                {
+                    break;
+                }
+            }
+            if (!expired.empty())
+            {
+                handler = expired_handler;
+            }
+        }
+        report(expired, handler);
+        return entry;
+    }
+
+    // whether a should leave the queue before b
+    bool before(const Slot& a, const Slot& b) const
+    {
+        if (compare(b->value, a->value))
+        {
+            return true;
+        }
+        if (compare(a->value, b->value))
+        {
+            return false;
+        }
+        return a->order < b->order;
+    }
+
+    void sift_up(std::size_t i)
+    {
+        Slot moving = std::move(heap[i]);
+        while (i > 0)
+        {
+            std::size_t parent = (i - 1) / arity;
+            if (!before(moving, heap[parent]))
+            {
+                break;
+            }
+            heap[i] = std::move(heap[parent]);
+            i = parent;
+        }
+        heap[i] = std::move(moving);
+    }
+
+    void sift_down(std::size_t i)
+    {
+        std::size_t n = heap.size();
+        Slot moving = std::move(heap[i]);
+        for (;;)
+        {
+            std::size_t first = i * arity + 1;
+            if (first >= n)
+            {
+                break;
+            }
+            std::size_t last = first + arity < n ? first + arity : n;
+            std::size_t best = first;
+            for (std::size_t c = first + 1; c < last; c++)
+            {
+                if (before(heap[c], heap[best]))
+                {
+                    best = c;
+                }
+            }
+            if (!before(heap[best], moving))
+            {
+                break;
+            }
+            heap[i] = std::move(heap[best]);
+            i = best;
+        }
+        heap[i] = std::move(moving);
+    }
+
+    // callers hold the lock
+    bool push(T&& entry, clock::time_point deadline)
+    {
+        if (!has_room())
+        {
+            return false;
+        }
+        heap.push_back(std::make_unique<Entry>(Entry{std::move(entry), deadline, next_order++}));
+        sift_up(heap.size() - 1);
+        has_entries.notify_one();
+        return true;
+    }
+
+    Slot pop_front()
+    {
+        Slot front = std::move(heap.front());
+        if (heap.size() > 1)
+        {
+            heap.front() = std::move(heap.back());
+            heap.pop_back();
+            sift_down(0);
+        }
+        else
+        {
+            heap.pop_back();
+        }
+        if (max_entries > 0)
+        {
+            has_space.notify_one();
+        }
+        return front;
+    }
+
+    void pop(std::optional<T>& entry, std::vector<T>& expired)
+    {
+        std::optional<clock::time_point> now;
+        while (!heap.empty())
+        {
+            Slot front = pop_front();
+            if (front->deadline != clock::time_point::max())
+            {
+                if (!now.has_value())
+                {
+                    now = clock::now();
+                }
+                if (front->deadline <= *now)
+                {
+                    expired_total++;
+                    expired.push_back(std::move(front->value));
+                    continue;
+                }
+            }
+            entry.emplace(std::move(front->value));
+            break;
+        }
+    }
+
+    static void report(std::vector<T>& expired, const std::function<void(T&&)>& handler)
+    {
+        if (!handler)
+        {
+            return;
+        }
+        for (T& value : expired)
+        {
+            handler(std::move(value));
+        }
+    }
+
+private:
+    mutable std::mutex mutex;
+    mutable std::condition_variable has_entries;
+    std::condition_variable has_space;
+    std::atomic_bool shutdown_flag;
+    std::vector<Slot> heap;
+    Compare compare;
+    const std::size_t max_entries;
+    std::uint64_t next_order = 0;
+    std::uint64_t expired_total = 0;
+    std::function<void(T&&)> expired_handler;
+};
@@ -0,0 +1,19 @@
+#pragma once
+
+/**
+ * Synchronisation policies for TQueue
+ *
+ * - locked: unbounded or bounded std::queue behind a mutex, any number of threads
+ * - mpmc:   bounded lock-free ring, any number of producers and consumers
+ * - spsc:   bounded wait-free ring, exactly one producer and one consumer thread
+ * - priority<Compare>: highest priority first with per entry deadlines, behind a mutex
+ */
+namespace tqueue
+{
+struct locked {};
+struct mpmc {};
+struct spsc {};
+template <class Compare> struct priority {};
+}
+
+template <class T, class Policy = tqueue::locked> class TQueue;
@@ -0,0 +1,449 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <optional>
+#include <ranges>
+#include <stop_token>
+#include <utility>
+
+#include "queue_fwd.hpp"
+#include "parking.hpp"
+
+/**
+ * @brief Bounded lock-free multi-producer multi-consumer queue
+ *
+ * Vyukov style ring, every slot carries a sequence number telling producers
+ * and consumers whose turn it is. Claiming a slot is a single CAS on the
+ * head or tail, there is no shared lock so throughput keeps up as threads
+ * are added. Capacity is rounded up to a power of 2.
+ *
+ * Same enqueue, dequeue and shutdown API as TQueue, enqueue blocks while the
+ * ring is full and try_enqueue fails instead.
+ */
+template <class T>
+class RingQueue
+{
+public:
+    explicit RingQueue(std::size_t capacity = 1024)
+    : mask(std::bit_ceil(capacity < 2 ? std::size_t{2} : capacity) - 1),
+      cells(std::make_unique<Cell[]>(mask + 1))
+    {
+        for (std::size_t i = 0; i <= mask; i++)
+        {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    RingQueue(const RingQueue&) = delete;
+    RingQueue& operator=(const RingQueue&) = delete;
+
+    ~RingQueue()
+    {
+        shutdown();
+        while (dequeue().has_value())
+        {}
+    }
+
+    void shutdown()
+    {
+        if (shutdown_flag.exchange(true))
+        {
+            return;
+        }
+        has_entries.wake_all();
+        has_space.wake_all();
+    }
+
+    bool is_shutdown() const
+    {
+        return shutdown_flag.load();
+    }
+
+    std::size_t capacity() const
+    {
+        return mask + 1;
+    }
+
+    /**
+     * @brief Add an entry unless the ring is full, the entry is left untouched on failure
+     */
+    bool try_enqueue(T&& entry)
+    {
+        std::size_t pos = tail.load(std::memory_order_relaxed);
+        Cell* cell = nullptr;
+        for (;;)
+        {
+            cell = &cells[pos & mask];
+            std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq - pos);
+            if (diff == 0)
+            {
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+        ::new (static_cast<void*>(cell->storage)) T(std::move(entry));
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        has_entries.wake_one();
+        return true;
+    }
+
+    /**
+     * @brief Add an entry, waiting for space while the ring is full
+     * @return false if the queue was shut down before space came up
+     */
+    bool enqueue(T&& entry)
+    {
+        while (!try_enqueue(std::move(entry)))
+        {
+            if (shutdown_flag.load())
+            {
+                return false;
+            }
+            has_space.wait([this]()
+            {
+                return !full() || shutdown_flag.load();
+            });
+        }
+        return true;
+    }
+
+    /**
+     * @brief Add an entry, waiting at most timeout for space
+     */
+    template <class Rep, class Period>
+    bool enqueue_for(T&& entry, const std::chrono::duration<Rep, Period>& timeout)
+    {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (!try_enqueue(std::move(entry)))
+        {
+            if (shutdown_flag.load())
+            {
+                return false;
+            }
+            bool ready = has_space.wait_until([this]()
+            {
+                return !full() || shutdown_flag.load();
+            }, deadline);
+            if (!ready)
+            {
+                return try_enqueue(std::move(entry));
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Add every entry of a range, claiming each run of free slots with one CAS
+     * @return number of entries added, short only if the queue was shut down
+     */
+    template <std::ranges::input_range R>
+    std::size_t enqueue_bulk(R&& entries)
+    {
+        auto it = std::ranges::begin(entries);
+        auto end = std::ranges::end(entries);
+        std::size_t added = 0;
+        while (it != end)
+        {
+            std::size_t wanted = remaining(it, end);
+            std::size_t pos = tail.load(std::memory_order_relaxed);
+            std::size_t count = 0;
+            for (;;)
+            {
+                count = 0;
+                while (count < wanted && count <= mask && sequence_at(pos + count) == pos + count)
+                {
+                    count++;
+                }
+                if (count == 0)
+                {
+                    // a slot a lap ahead means another producer moved the tail
+                    if (static_cast<std::ptrdiff_t>(sequence_at(pos) - pos) > 0)
+                    {
+                        pos = tail.load(std::memory_order_relaxed);
+                        continue;
+                    }
+                    break;
+                }
+                if (tail.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            if (count == 0)
+            {
+                if (shutdown_flag.load())
+                {
+                    return added;
+                }
+                has_space.wait([this]()
+                {
+                    return !full() || shutdown_flag.load();
+                });
+                continue;
+            }
+            // the claimed slots are ours, fill and publish them in order
+            for (std::size_t i = 0; i < count; i++, ++it)
+            {
+                Cell& cell = cells[(pos + i) & mask];
+                ::new (static_cast<void*>(cell.storage)) T(std::move(*it));
+                cell.sequence.store(pos + i + 1, std::memory_order_release);
+            }
+            added += count;
+            if (count == 1)
+            {
+                has_entries.wake_one();
+            }
+            else
+            {
+                has_entries.wake_all();
+            }
+        }
+        return added;
+    }
+
+    /**
+     * @brief Take the oldest entry if there is one, never blocks
+     */
+    std::optional<T> dequeue()
+    {
+        std::optional<T> entry;
+        std::size_t pos = head.load(std::memory_order_relaxed);
+        Cell* cell = nullptr;
+        for (;;)
+        {
+            cell = &cells[pos & mask];
+            std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq - (pos + 1));
+            if (diff == 0)
+            {
+                if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return entry;
+            }
+            else
+            {
+                pos = head.load(std::memory_order_relaxed);
+            }
+        }
+        T* value = std::launder(reinterpret_cast<T*>(cell->storage));
+        entry.emplace(std::move(*value));
+        value->~T();
+        cell->sequence.store(pos + mask + 1, std::memory_order_release);
+        has_space.wake_one();
+        return entry;
+    }
+
+    /**
+     * @brief Move up to max of the oldest entries to out with one CAS, never blocks
+     * @return number of entries written
+     */
+    template <class OutputIt>
+    std::size_t dequeue_bulk(OutputIt out, std::size_t max)
+    {
+        std::size_t pos = head.load(std::memory_order_relaxed);
+        std::size_t count = 0;
+        for (;;)
+        {
+            count = 0;
+            while (count < max && count <= mask && sequence_at(pos + count) == pos + count + 1)
+            {
+                count++;
+            }
+            if (count == 0)
+            {
+                if (static_cast<std::ptrdiff_t>(sequence_at(pos) - (pos + 1)) > 0)
+                {
+                    pos = head.load(std::memory_order_relaxed);
+                    continue;
+                }
+                return 0;
+            }
+            if (head.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        for (std::size_t i = 0; i < count; i++)
+        {
+            Cell& cell = cells[(pos + i) & mask];
+            T* value = std::launder(reinterpret_cast<T*>(cell.storage));
+            *out++ = std::move(*value);
+            value->~T();
+            cell.sequence.store(pos + i + mask + 1, std::memory_order_release);
+        }
+        has_space.wake_all();
+        return count;
+    }
+
+    /**
+     * @brief Take the oldest entry, waiting for one unless the queue is shut down
+     */
+    std::optional<T> dequeue_wait()
+    {
+        for (;;)
+        {
+            std::optional<T> entry = dequeue();
+            if (entry.has_value() || shutdown_flag.load())
+            {
+                return entry;
+            }
+            wait_for_entry_or_shutdown();
+        }
+    }
+
+    /**
+     * @brief Take the oldest entry, waiting at most timeout for one to arrive
+     */
+    template <class Rep, class Period>
+    std::optional<T> dequeue_for(const std::chrono::duration<Rep, Period>& timeout)
+    {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        for (;;)
+        {
+            std::optional<T> entry = dequeue();
+            if (entry.has_value() || shutdown_flag.load())
+            {
+                return entry;
+            }
+            bool ready = has_entries.wait_until([this]()
+            {
+                return !empty() || shutdown_flag.load();
+            }, deadline);
+            if (!ready)
+            {
+                return dequeue();
+            }
+        }
+    }
+
+    void wait_for_entry_or_shutdown() const
+    {
+        has_entries.wait([this]()
+        {
+            return !empty() || shutdown_flag.load();
+        });
+    }
+
+    void wait_for_entry(std::stop_token stop) const
+    {
+        std::stop_callback on_stop(stop, [this]()
+        {
+            has_entries.wake_all();
+        });
+        has_entries.wait([this, &stop]()
+        {
+            return !empty() || stop.stop_requested();
+        });
+    }
+
+    /**
+     * @brief Wait at most timeout for an entry
+     * @return true if an entry is available or the queue was shut down
+     */
+    template <class Rep, class Period>
+    bool wait_for_entry_for(const std::chrono::duration<Rep, Period>& timeout) const
+    {
+        return has_entries.wait_until([this]()
+        {
+            return !empty() || shutdown_flag.load();
+        }, std::chrono::steady_clock::now() + timeout);
+    }
+
+    /**
+     * @brief Whether the slot at the head holds an entry, a hint under concurrency
+     */
+    bool empty() const
+    {
+        std::size_t pos = head.load(std::memory_order_acquire);
+        for (;;)
+        {
+            std::size_t seq = cells[pos & mask].sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq - (pos + 1));
+            if (diff <= 0)
+            {
+                return diff < 0;
+            }
+            pos = head.load(std::memory_order_acquire);
+        }
+    }
+
+private:
+    std::size_t sequence_at(std::size_t pos) const
+    {
+        return cells[pos & mask].sequence.load(std::memory_order_acquire);
+    }
+
+    template <class It, class End>
+    static std::size_t remaining(const It& it, const End& end)
+    {
+        if constexpr (std::sized_sentinel_for<End, It>)
+        {
+            return static_cast<std::size_t>(end - it);
+        }
+        else
+        {
+            return 1;
+        }
+    }
+
+    bool full() const
+    {
+        std::size_t pos = tail.load(std::memory_order_acquire);
+        for (;;)
+        {
+            std::size_t seq = cells[pos & mask].sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq - pos);
+            if (diff <= 0)
+            {
+                return diff < 0;
+            }
+            pos = tail.load(std::memory_order_acquire);
+        }
+    }
+
+    struct Cell
+    {
+        std::atomic<std::size_t> sequence;
+        alignas(T) std::byte storage[sizeof(T)];
+    };
+
+    const std::size_t mask;
+    std::unique_ptr<Cell[]> cells;
+    // producers and consumers each hammer their own index, keep them apart
+    alignas(tqueue::cache_line_size) std::atomic<std::size_t> tail{0};
+    alignas(tqueue::cache_line_size) std::atomic<std::size_t> head{0};
+    alignas(tqueue::cache_line_size) std::atomic_bool shutdown_flag{false};
+    tqueue::Parking has_entries;
+    tqueue::Parking has_space;
+};
+
+/**
+ * @brief TQueue on the lock-free ring, for queues shared by many producers and consumers
+ */
+template <class T>
+class TQueue<T, tqueue::mpmc> : public RingQueue<T>
+{
+public:
+    using RingQueue<T>::RingQueue;
+};
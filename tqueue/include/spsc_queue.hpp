@@ -0,0 +1,349 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <optional>
+#include <ranges>
+#include <stop_token>
+#include <utility>
+
+#include "queue_fwd.hpp"
+#include "parking.hpp"
+
+/**
+ * @brief Wait-free single-producer single-consumer ring
+ *
+ * Only one thread may enqueue and only one thread may dequeue. Each side owns
+ * its index and keeps a cached copy of the other, so it reads the shared
+ * line only when its copy says the ring looks full or empty. Capacity is
+ * rounded up to a power of 2.
+ *
+ * Same API as the mpmc ring, blocking calls spin briefly then park.
+ */
+template <class T>
+class TQueue<T, tqueue::spsc>
+{
+public:
+    explicit TQueue(std::size_t capacity = 1024)
+    : mask(std::bit_ceil(capacity < 2 ? std::size_t{2} : capacity) - 1),
+      slots(std::make_unique<Slot[]>(mask + 1))
+    {}
+
+    TQueue(const TQueue&) = delete;
+    TQueue& operator=(const TQueue&) = delete;
+
+    ~TQueue()
+    {
+        shutdown();
+        while (dequeue().has_value())
+        {}
+    }
+
+    void shutdown()
+    {
+        if (shutdown_flag.exchange(true))
+        {
+            return;
+        }
+        has_entries.wake_all();
+        has_space.wake_all();
+    }
+
+    bool is_shutdown() const
+    {
+        return shutdown_flag.load();
+    }
+
+    std::size_t capacity() const
+    {
+        return mask + 1;
+    }
+
+    /**
+     * @brief Add an entry unless the ring is full, the entry is left untouched on failure
+     */
+    bool try_enqueue(T&& entry)
+    {
+        std::size_t pos = producer.tail.load(std::memory_order_relaxed);
+        if (free_slots(pos) == 0)
+        {
+            return false;
+        }
+        ::new (static_cast<void*>(slots[pos & mask].storage)) T(std::move(entry));
+        producer.tail.store(pos + 1, std::memory_order_release);
+        has_entries.wake_one();
+        return true;
+    }
+
+    /**
+     * @brief Add an entry, waiting for space while the ring is full
+     * @return false if the queue was shut down before space came up
+     */
+    bool enqueue(T&& entry)
+    {
+        while (!try_enqueue(std::move(entry)))
+        {
+            if (shutdown_flag.load())
+            {
+                return false;
+            }
+            has_space.wait([this]()
+            {
+                return !full() || shutdown_flag.load();
+            });
+        }
+        return true;
+    }
+
+    /**
+     * @brief Add an entry, waiting at most timeout for space
+     */
+    template <class Rep, class Period>
+    bool enqueue_for(T&& entry, const std::chrono::duration<Rep, Period>& timeout)
+    {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (!try_enqueue(std::move(entry)))
+        {
+            if (shutdown_flag.load())
+            {
+                return false;
+            }
+            bool ready = has_space.wait_until([this]()
+            {
+                return !full() || shutdown_flag.load();
+            }, deadline);
+            if (!ready)
+            {
+                return try_enqueue(std::move(entry));
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Add every entry of a range, publishing each run that fits with one store
+     * @return number of entries added, short only if the queue was shut down
+     */
+    template <std::ranges::input_range R>
+    std::size_t enqueue_bulk(R&& entries)
+    {
+        auto it = std::ranges::begin(entries);
+        auto end = std::ranges::end(entries);
+        std::size_t added = 0;
+        while (it != end)
+        {
+            std::size_t pos = producer.tail.load(std::memory_order_relaxed);
+            std::size_t room = free_slots(pos);
+            if (room == 0)
+            {
+                if (shutdown_flag.load())
+                {
+                    return added;
+                }
+                has_space.wait([this]()
+                {
+                    return !full() || shutdown_flag.load();
+                });
+                continue;
+            }
+            std::size_t count = 0;
+            for (; count < room && it != end; count++, ++it)
+            {
+                ::new (static_cast<void*>(slots[(pos + count) & mask].storage)) T(std::move(*it));
+            }
+            producer.tail.store(pos + count, std::memory_order_release);
+            added += count;
+            has_entries.wake_one();
+        }
+        return added;
+    }
+
+    /**
+     * @brief Take the oldest entry if there is one, never blocks
+     */
+    std::optional<T> dequeue()
+    {
+        std::optional<T> entry;
+        std::size_t pos = consumer.head.load(std::memory_order_relaxed);
+        if (ready_slots(pos) == 0)
+        {
+            return entry;
+        }
+        T* value = std::launder(reinterpret_cast<T*>(slots[pos & mask].storage));
+        entry.emplace(std::move(*value));
+        value->~T();
+        consumer.head.store(pos + 1, std::memory_order_release);
+        has_space.wake_one();
+        return entry;
+    }
+
+    /**
+     * @brief Move up to max of the oldest entries to out, never blocks
+     * @return number of entries written
+     */
+    template <class OutputIt>
+    std::size_t dequeue_bulk(OutputIt out, std::size_t max)
+    {
+        std::size_t pos = consumer.head.load(std::memory_order_relaxed);
+        std::size_t count = ready_slots(pos);
+        if (count > max)
+        {
+            count = max;
+        }
+        if (count == 0)
+        {
+            return 0;
+        }
+        for (std::size_t i = 0; i < count; i++)
+        {
+            T* value = std::launder(reinterpret_cast<T*>(slots[(pos + i) & mask].storage));
+            *out++ = std::move(*value);
+            value->~T();
+        }
+        consumer.head.store(pos + count, std::memory_order_release);
+        has_space.wake_one();
+        return count;
+    }
+
+    /**
+     * @brief Take the oldest entry, waiting for one unless the queue is shut down
+     */
+    std::optional<T> dequeue_wait()
+    {
+        for (;;)
+        {
+            std::optional<T> entry = dequeue();
+            if (entry.has_value() || shutdown_flag.load())
+            {
+                return entry;
+            }
+            wait_for_entry_or_shutdown();
+        }
+    }
+
+    /**
+     * @brief Take the oldest entry, waiting at most timeout for one to arrive
+     */
+    template <class Rep, class Period>
+    std::optional<T> dequeue_for(const std::chrono::duration<Rep, Period>& timeout)
+    {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        for (;;)
+        {
+            std::optional<T> entry = dequeue();
+            if (entry.has_value() || shutdown_flag.load())
+            {
+                return entry;
+            }
+            bool ready = has_entries.wait_until([this]()
+            {
+                return !empty() || shutdown_flag.load();
+            }, deadline);
+            if (!ready)
+            {
+                return dequeue();
+            }
+        }
+    }
+
+    void wait_for_entry_or_shutdown() const
+    {
+        has_entries.wait([this]()
+        {
+            return !empty() || shutdown_flag.load();
+        });
+    }
+
+    void wait_for_entry(std::stop_token stop) const
+    {
+        std::stop_callback on_stop(stop, [this]()
+        {
+            has_entries.wake_all();
+        });
+        has_entries.wait([this, &stop]()
+        {
+            return !empty() || stop.stop_requested();
+        });
+    }
+
+    /**
+     * @brief Wait at most timeout for an entry
+     * @return true if an entry is available or the queue was shut down
+     */
+    template <class Rep, class Period>
+    bool wait_for_entry_for(const std::chrono::duration<Rep, Period>& timeout) const
+    {
+        return has_entries.wait_until([this]()
+        {
+            return !empty() || shutdown_flag.load();
+        }, std::chrono::steady_clock::now() + timeout);
+    }
+
+    /**
+     * @brief Whether the ring holds no entries, exact only on the consumer thread
+     */
+    bool empty() const
+    {
+        return consumer.head.load(std::memory_order_relaxed) == producer.tail.load(std::memory_order_acquire);
+    }
+
+private:
+    // producer side, refreshes its copy of the head only when the ring looks full
+    std::size_t free_slots(std::size_t pos)
+    {
+        std::size_t room = mask + 1 - (pos - producer.cached_head);
+        if (room == 0)
+        {
+            producer.cached_head = consumer.head.load(std::memory_order_acquire);
+            room = mask + 1 - (pos - producer.cached_head);
+        }
+        return room;
+    }
+
+    // consumer side, refreshes its copy of the tail only when the ring looks empty
+    std::size_t ready_slots(std::size_t pos)
+    {
+        std::size_t ready = consumer.cached_tail - pos;
+        if (ready == 0)
+        {
+            consumer.cached_tail = producer.tail.load(std::memory_order_acquire);
+            ready = consumer.cached_tail - pos;
+        }
+        return ready;
+    }
+
+    bool full() const
+    {
+        return producer.tail.load(std::memory_order_relaxed) - consumer.head.load(std::memory_order_acquire) > mask;
+    }
+
+    struct Slot
+    {
+        alignas(T) std::byte storage[sizeof(T)];
+    };
+
+    // each side writes only its own line, the cached index saves reading the other's
+    struct alignas(tqueue::cache_line_size) Producer
+    {
+        std::atomic<std::size_t> tail{0};
+        std::size_t cached_head = 0;
+    };
+
+    struct alignas(tqueue::cache_line_size) Consumer
+    {
+        std::atomic<std::size_t> head{0};
+        std::size_t cached_tail = 0;
+    };
+
+    const std::size_t mask;
+    std::unique_ptr<Slot[]> slots;
+    Producer producer;
+    Consumer consumer;
+    alignas(tqueue::cache_line_size) std::atomic_bool shutdown_flag{false};
+    tqueue::Parking has_entries;
+    tqueue::Parking has_space;
+};
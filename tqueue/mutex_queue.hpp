@@ -0,0 +1,57 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <optional>
+
+#include "queue.hpp"
+
+/**
+ * @brief The original mutex TQueue behind the policy API, for comparison
+ *
+ * Unbounded and pop always blocks, so dequeue waits for an entry.
+ * shutdown() queues an empty entry that every consumer passes on, which is
+ * how blocked consumers get released. No bulk calls, the queue only moves
+ * one entry per lock.
+ */
+template <class T>
+class MutexQueue
+{
+public:
+    explicit MutexQueue(std::size_t)
+    {}
+
+    void shutdown()
+    {
+        queue.push(std::nullopt);
+    }
+
+    bool enqueue(T&& entry)
+    {
+        queue.push(std::move(entry));
+        return true;
+    }
+
+    /**
+     * @brief Take the oldest entry, empty only once shut down
+     */
+    std::optional<T> dequeue()
+    {
+        std::optional<T> entry = queue.pop();
+        if (!entry.has_value())
+        {
+            queue.push(std::nullopt);
+        }
+        return entry;
+    }
+
+    // dequeue already blocks
+    template <class Rep, class Period>
+    bool wait_for_entry_for(const std::chrono::duration<Rep, Period>&) const
+    {
+        return true;
+    }
+
+private:
+    legacy::TQueue<std::optional<T>> queue;
+};
@@ -5,7 +5,10 @@
 #include <mutex>
 #include <condition_variable>
 
-// A threadsafe-queue.
+// The original threadsafe queue, in its own namespace as the TQueue
+// policies of include/ took the global name.
+namespace legacy
+{
 template <class T>
 struct TQueue
 {
@@ -42,4 +45,5 @@ struct TQueue
         mutable std::mutex m;
         std::condition_variable c;
 };
+}
 #endif
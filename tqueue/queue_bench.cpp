@@ -0,0 +1,229 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "basic_queue.hpp"
+#include "mutex_queue.hpp"
+#include "ring_queue.hpp"
+#include "spsc_queue.hpp"
+
+// Throughput and enqueue to dequeue latency of the TQueue policies, against
+// the original mutex queue of queue.hpp.
+//
+// Every iteration pushes MESSAGES messages from the producers through a fresh
+// queue to the consumers. Each run reports items/s over wall time plus the
+// latency percentiles of a sample of the messages, stamped on enqueue and
+// checked on dequeue.
+
+constexpr int MESSAGES = 1 << 16;
+constexpr std::size_t CAPACITY = 1024;
+constexpr std::size_t BATCH = 32;
+// stamp one message in SAMPLE_EVERY, reading the clock costs as much as a push
+constexpr int SAMPLE_EVERY = 8;
+constexpr std::size_t MAX_SAMPLES = 1 << 20;
+
+using Clock = std::chrono::steady_clock;
+
+template <std::size_t Size>
+struct Message
+{
+    std::int64_t sent = 0;
+    std::array<char, Size - sizeof(std::int64_t)> payload{};
+};
+
+static std::int64_t now_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+template <class Queue, class M>
+static void produce(Queue& queue, int first, int count)
+{
+    for (int i = first; i < first + count; i++)
+    {
+        M message;
+        if (i % SAMPLE_EVERY == 0)
+        {
+            message.sent = now_ns();
+        }
+        queue.enqueue(std::move(message));
+    }
+}
+
+template <class Queue, class M>
+static void produce_bulk(Queue& queue, int first, int count)
+{
+    std::vector<M> batch;
+    batch.reserve(BATCH);
+    for (int i = first; i < first + count; i++)
+    {
+        batch.emplace_back();
+        if (i % SAMPLE_EVERY == 0)
+        {
+            batch.back().sent = now_ns();
+        }
+        if (batch.size() == BATCH || i + 1 == first + count)
+        {
+            queue.enqueue_bulk(batch);
+            batch.clear();
+        }
+    }
+}
+
+template <class M>
+static void record(const M& message, std::vector<std::int64_t>& latencies)
+{
+    if (message.sent != 0 && latencies.size() < MAX_SAMPLES)
+    {
+        latencies.push_back(now_ns() - message.sent);
+    }
+}
+
+template <class Queue, class M, bool Bulk>
+static void consume(Queue& queue, std::atomic<int>& consumed, std::vector<std::int64_t>& latencies)
+{
+    std::vector<M> batch;
+    batch.reserve(BATCH);
+    while (consumed.load(std::memory_order_relaxed) < MESSAGES)
+    {
+        int got = 0;
+        if constexpr (Bulk)
+        {
+            batch.clear();
+            got = (int)queue.dequeue_bulk(std::back_inserter(batch), BATCH);
+            for (const M& message : batch)
+            {
+                record(message, latencies);
+            }
+        }
+        else
+        {
+            std::optional<M> message = queue.dequeue();
+            if (message.has_value())
+            {
+                record(*message, latencies);
+                got = 1;
+            }
+        }
+        if (got == 0)
+        {
+            queue.wait_for_entry_for(std::chrono::milliseconds(1));
+            continue;
+        }
+        // the last one in releases consumers blocked in MutexQueue
+        if (consumed.fetch_add(got, std::memory_order_relaxed) + got == MESSAGES)
+        {
+            queue.shutdown();
+        }
+    }
+}
+
+static std::int64_t percentile(std::vector<std::int64_t>& sorted, double p)
+{
+    if (sorted.empty())
+    {
+        return 0;
+    }
+    return sorted[std::min(sorted.size() - 1, (std::size_t)(p * sorted.size()))];
+}
+
+template <class Queue, std::size_t Size, bool Bulk>
+static void BM_Queue(benchmark::State& state)
+{
+    using M = Message<Size>;
+    const int producers = (int)state.range(0);
+    const int consumers = (int)state.range(1);
+    std::vector<std::vector<std::int64_t>> latencies(consumers);
+
+    for (auto _ : state)
+    {
+        auto queue = std::make_unique<Queue>(CAPACITY);
+        std::atomic<int> consumed{0};
+        {
+            std::vector<std::jthread> threads;
+            for (int c = 0; c < consumers; c++)
+            {
+                threads.emplace_back([&, c]()
+                {
+                    consume<Queue, M, Bulk>(*queue, consumed, latencies[c]);
+                });
+            }
+            for (int p = 0; p < producers; p++)
+            {
+                int first = MESSAGES / producers * p;
+                int count = p + 1 == producers ? MESSAGES - first : MESSAGES / producers;
+                threads.emplace_back([&, first, count]()
+                {
+                    if constexpr (Bulk)
+                    {
+                        produce_bulk<Queue, M>(*queue, first, count);
+                    }
+                    else
+                    {
+                        produce<Queue, M>(*queue, first, count);
+                    }
+                });
+            }
+        }
+    }
+
+    std::vector<std::int64_t> all;
+    for (auto& l : latencies)
+    {
+        all.insert(all.end(), l.begin(), l.end());
+    }
+    std::sort(all.begin(), all.end());
+    state.SetItemsProcessed(state.iterations() * MESSAGES);
+    state.SetBytesProcessed(state.iterations() * MESSAGES * (std::int64_t)sizeof(M));
+    state.counters["p50_ns"] = (double)percentile(all, 0.50);
+    state.counters["p99_ns"] = (double)percentile(all, 0.99);
+    state.counters["p999_ns"] = (double)percentile(all, 0.999);
+}
+
+// 1..N producers by 1..N consumers, N the hardware threads up to 8
+static void ManyToMany(benchmark::internal::Benchmark* b)
+{
+    int n = (int)std::min(8u, std::max(2u, std::thread::hardware_concurrency()));
+    for (int p = 1; p <= n; p *= 2)
+    {
+        for (int c = 1; c <= n; c *= 2)
+        {
+            b->Args({p, c});
+        }
+    }
+    b->ArgNames({"producers", "consumers"})->UseRealTime();
+}
+
+static void OneToOne(benchmark::internal::Benchmark* b)
+{
+    b->Args({1, 1})->ArgNames({"producers", "consumers"})->UseRealTime();
+}
+
+template <class T> using Mutex = MutexQueue<T>;
+template <class T> using Locked = TQueue<T>;
+template <class T> using Mpmc = TQueue<T, tqueue::mpmc>;
+template <class T> using Spsc = TQueue<T, tqueue::spsc>;
+
+#define QUEUE_BENCHMARKS(Size) \
+    BENCHMARK_TEMPLATE(BM_Queue, Mutex<Message<Size>>, Size, false)->Apply(ManyToMany); \
+    BENCHMARK_TEMPLATE(BM_Queue, Locked<Message<Size>>, Size, false)->Apply(ManyToMany); \
+    BENCHMARK_TEMPLATE(BM_Queue, Locked<Message<Size>>, Size, true)->Apply(ManyToMany); \
+    BENCHMARK_TEMPLATE(BM_Queue, Mpmc<Message<Size>>, Size, false)->Apply(ManyToMany); \
+    BENCHMARK_TEMPLATE(BM_Queue, Mpmc<Message<Size>>, Size, true)->Apply(ManyToMany); \
+    BENCHMARK_TEMPLATE(BM_Queue, Spsc<Message<Size>>, Size, false)->Apply(OneToOne); \
+    BENCHMARK_TEMPLATE(BM_Queue, Spsc<Message<Size>>, Size, true)->Apply(OneToOne)
+
+QUEUE_BENCHMARKS(16);
+QUEUE_BENCHMARKS(64);
+QUEUE_BENCHMARKS(512);
+
+BENCHMARK_MAIN();
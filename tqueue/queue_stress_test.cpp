@@ -0,0 +1,168 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <iterator>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "basic_queue.hpp"
+#include "mutex_queue.hpp"
+#include "priority_queue.hpp"
+#include "ring_queue.hpp"
+#include "spsc_queue.hpp"
+
+// Many producers and consumers hammering each TQueue policy, meant to run
+// under ThreadSanitizer. Every message is checked to arrive exactly once
+// and, per consumer, in the order its producer sent it.
+
+struct Tagged
+{
+    int producer;
+    int seq;
+};
+
+// lower seq first, which keeps each producer's messages in the order sent
+struct Older
+{
+    bool operator()(const Tagged& a, const Tagged& b) const
+    {
+        return a.seq > b.seq;
+    }
+};
+
+template <class Queue, bool Bulk>
+static void stress(int producers, int consumers, int per_producer)
+{
+    Queue queue(64);
+    std::atomic<int> consumed{0};
+    const int total = producers * per_producer;
+    std::vector<std::vector<int>> seen(consumers, std::vector<int>(producers, -1));
+    std::vector<std::vector<char>> arrived(producers, std::vector<char>(per_producer, 0));
+    std::atomic<int> duplicates{0};
+    std::atomic<int> reordered{0};
+    {
+        std::vector<std::jthread> threads;
+        for (int c = 0; c < consumers; c++)
+        {
+            threads.emplace_back([&, c]()
+            {
+                std::vector<Tagged> batch;
+                while (consumed.load() < total)
+                {
+                    batch.clear();
+                    if constexpr (Bulk)
+                    {
+                        queue.dequeue_bulk(std::back_inserter(batch), 8);
+                    }
+                    else if (std::optional<Tagged> entry = queue.dequeue())
+                    {
+                        batch.push_back(*entry);
+                    }
+                    if (batch.empty())
+                    {
+                        queue.wait_for_entry_for(std::chrono::milliseconds(1));
+                        continue;
+                    }
+                    for (const Tagged& t : batch)
+                    {
+                        if (t.seq <= seen[c][t.producer])
+                        {
+                            reordered++;
+                        }
+                        seen[c][t.producer] = t.seq;
+                        // each slot is written by the one consumer that got the message
+                        if (arrived[t.producer][t.seq]++)
+                        {
+                            duplicates++;
+                        }
+                    }
+                    // the last one in releases consumers blocked in MutexQueue
+                    if (consumed.fetch_add((int)batch.size()) + (int)batch.size() == total)
+                    {
+                        queue.shutdown();
+                    }
+                }
+            });
+        }
+        for (int p = 0; p < producers; p++)
+        {
+            threads.emplace_back([&, p]()
+            {
+                std::vector<Tagged> batch;
+                for (int i = 0; i < per_producer; i++)
+                {
+                    if constexpr (Bulk)
+                    {
+                        batch.push_back(Tagged{p, i});
+                        if (batch.size() == 8 || i + 1 == per_producer)
+                        {
+                            queue.enqueue_bulk(batch);
+                            batch.clear();
+                        }
+                    }
+                    else
+                    {
+                        queue.enqueue(Tagged{p, i});
+                    }
+                }
+            });
+        }
+    }
+    EXPECT_EQ(consumed.load(), total);
+    EXPECT_EQ(duplicates.load(), 0);
+    EXPECT_EQ(reordered.load(), 0);
+    for (int p = 0; p < producers; p++)
+    {
+        for (int i = 0; i < per_producer; i++)
+        {
+            ASSERT_TRUE(arrived[p][i]) << "producer " << p << " message " << i;
+        }
+    }
+}
+
+TEST(QueueStress, Locked)
+{
+    stress<TQueue<Tagged>, false>(4, 4, 20000);
+}
+
+TEST(QueueStress, LockedBulk)
+{
+    stress<TQueue<Tagged>, true>(4, 4, 20000);
+}
+
+TEST(QueueStress, Mpmc)
+{
+    stress<TQueue<Tagged, tqueue::mpmc>, false>(4, 4, 20000);
+}
+
+TEST(QueueStress, MpmcBulk)
+{
+    stress<TQueue<Tagged, tqueue::mpmc>, true>(4, 4, 20000);
+}
+
+TEST(QueueStress, Mutex)
+{
+    stress<MutexQueue<Tagged>, false>(4, 4, 20000);
+}
+
+TEST(QueueStress, Priority)
+{
+    stress<TQueue<Tagged, tqueue::priority<Older>>, false>(4, 4, 20000);
+}
+
+TEST(QueueStress, PriorityBulk)
+{
+    stress<TQueue<Tagged, tqueue::priority<Older>>, true>(4, 4, 20000);
+}
+
+TEST(QueueStress, Spsc)
+{
+    stress<TQueue<Tagged, tqueue::spsc>, false>(1, 1, 100000);
+}
+
+TEST(QueueStress, SpscBulk)
+{
+    stress<TQueue<Tagged, tqueue::spsc>, true>(1, 1, 100000);
+}
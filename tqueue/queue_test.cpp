@@ -4,7 +4,7 @@
 TEST(QueueTest, Push)
 {
     auto n = 50;
-    TQueue<int> tq;
+    legacy::TQueue<int> tq;
     for (int i = 1; i <= n; i++)
     {
         tq.push(i);